@@ -1,5 +1,7 @@
 #include "./FirstApp.hpp"
 #include "./SimpleRenderSystem.hpp"
+#include "../Engine/LodChain.hpp"
+#include "../Engine/ProceduralGeometry.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -9,8 +11,12 @@
 
 // std lib headers
 #include <array>
+#include <chrono>
+#include <iostream>
 
 namespace App {
+	// a triangle per point, fanned around the star's center
+	constexpr uint32_t STAR_POINTS = 12;
 
 	FirstApp::FirstApp() {
 		this->LoadGameObjects();
@@ -19,29 +25,72 @@ namespace App {
 	FirstApp::~FirstApp() {}
 
 	void FirstApp::Run() {
-		SimpleRenderSystem renderSystem{ this->m_Device,this->m_Renderer.GetSwapChainRenderPass() };
+		SimpleRenderSystem renderSystem{
+			this->m_Device,
+			this->m_Renderer.GetSwapChainRenderPass(),
+			this->m_Renderer.GetFrameRing().GetDescriptorSetLayout() };
+
+		auto lastStep = std::chrono::steady_clock::now();
+		auto lastStats = lastStep;
 
 		while (!m_Window.IsClosed()) {
 			this->m_Window.Update();
 
 			if (auto commandBuffer = m_Renderer.BeginFrame()) {
-				this->m_Renderer.BeginSwapChainRenderPass(commandBuffer);
-				renderSystem.RenderGameObjects(commandBuffer, this->m_GameObjects);
-				this->m_Renderer.EndSwapChainRenderPass(commandBuffer);
+				// the scene moves at a fixed rate, frames in between replay the cached recording
+				const auto now = std::chrono::steady_clock::now();
+				if (now - lastStep >= ANIMATION_STEP) {
+					lastStep = now;
+					renderSystem.UpdateGameObjects(this->m_GameObjects);
+					this->AnimateStar();
+				}
+				renderSystem.PropagateTransforms(this->m_GameObjects, this->m_Transforms);
+				renderSystem.SelectLods(this->m_GameObjects, this->m_Renderer.GetSwapChainExtent());
+				// what level of detail saves, against drawing every object at full detail
+				if (now - lastStats >= STATS_INTERVAL) {
+					lastStats = now;
+					const auto& lodStats = renderSystem.GetLodStats();
+					const uint64_t fullDetail = lodStats.TrianglesDrawn + lodStats.TrianglesSaved;
+					std::cout << "lod: " << lodStats.Objects << " objects, " << lodStats.TrianglesDrawn << " triangles drawn, "
+						<< lodStats.TrianglesSaved << " saved (" << (fullDetail > 0 ? 100 * lodStats.TrianglesSaved / fullDetail : 0) << "%), "
+						<< lodStats.LodSwitches << " switches this frame" << std::endl;
+				}
+				renderSystem.BakeStaticObjects(this->m_GameObjects);
+
+				auto& frameRing = this->m_Renderer.GetFrameRing();
+				auto frameData = renderSystem.UploadGameObjects(
+					this->m_GameObjects, frameRing, this->m_Renderer.GetFrameArena(), this->m_Renderer.GetCurrentFrameIndex());
+
+				Engine::CommandBufferKey sceneKey{ this->m_Renderer.GetFrameArena() };
+				SimpleRenderSystem::BuildSceneKey(this->m_GameObjects, frameData, sceneKey);
+				this->m_Renderer.RecordSwapChainRenderPass(commandBuffer, sceneKey, [&](VkCommandBuffer sceneCommandBuffer) {
+					renderSystem.RenderGameObjects(sceneCommandBuffer, frameData, frameRing);
+				});
 				this->m_Renderer.EndFrame();
 			}
 		}
 
-		vkDeviceWaitIdle(this->m_Device.GetDevice());
+		this->m_Renderer.WaitIdle();
+	}
+
+	void FirstApp::AnimateStar() {
+		this->m_StarPhase = glm::mod(this->m_StarPhase + 0.2f, glm::two_pi<float>());
+
+		// every vertex moves, a partial update would edit just the points that did
+		Engine::DynamicModel::Vertex* vertices = this->m_Star->Edit(0, this->m_Star->GetVertexCount());
+		for (uint32_t i = 0; i < STAR_POINTS; i++) {
+			const float angle = i * glm::two_pi<float>() / STAR_POINTS;
+			const float width = glm::pi<float>() / STAR_POINTS;
+			const float length = 0.75f + 0.25f * glm::sin(this->m_StarPhase + i);
+
+			vertices[i * 3 + 0] = { { 0.0f, 0.0f }, glm::vec3{ 1.0f } };
+			vertices[i * 3 + 1] = { length * glm::vec2{ glm::cos(angle - width), glm::sin(angle - width) }, glm::vec3{ 1.0f } };
+			vertices[i * 3 + 2] = { length * glm::vec2{ glm::cos(angle), glm::sin(angle) }, glm::vec3{ 1.0f } };
+		}
 	}
 	
 
 	void FirstApp::LoadGameObjects() {
-		std::vector<Engine::Model::Vertex> vertices{
-			{{0.0f, -0.5f}, {1.0f, 0.0f, 0.0f}},
-			{{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
-			{{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
-		};
 		std::vector<glm::vec3> colors{
 			{1.f, .7f, .73f},
 			{1.f, .87f, .73f},
@@ -51,7 +100,8 @@ namespace App {
 		};
 		for (auto& color : colors) color = glm::pow(color, glm::vec3{ 2.2f });
 
-		auto model = std::make_shared<Engine::Model>(this->m_Device, vertices);
+		// the smaller triangles drop a few gasket levels, the big ones stay at full depth
+		auto model = Engine::LodChain::CreateSierpinski(this->m_Device, 8, 5, { -0.5f, 0.5f }, { 0.5f, 0.5f }, { 0.0f, -0.5f });
 
 		for (int i = 0; i < 40; i++) {
 			auto triangle = Engine::GameObject::CreateGameObject();
@@ -62,28 +112,59 @@ namespace App {
 
 			this->m_GameObjects.push_back(std::move(triangle));
 		}
-	}
-
 
-
-	void FirstApp::Sierpinski(
-		std::vector<Engine::Model::Vertex>& vertices,
-		int depth,
-		glm::vec2 left,
-		glm::vec2 right,
-		glm::vec2 top) {
-		if (depth <= 0) {
-			vertices.push_back({ top });
-			vertices.push_back({ right });
-			vertices.push_back({ left });
+		// a backdrop of small hexagons that never move, baked into a handful of chunk draws
+		const auto hexagonSize = Engine::ProceduralGeometry::GetPolygonSize(6);
+		auto hexagon = std::make_shared<Engine::Model>(this->m_Device, hexagonSize.VertexCount, hexagonSize.IndexCount,
+			[](Engine::Model::Vertex* vertices, uint32_t* indices) {
+				Engine::ProceduralGeometry::WritePolygon(vertices, indices, 6, { 0.0f, 0.0f }, 1.0f);
+			}, 1.0f);
+
+		// a composite object, six triangles orbiting a hub that spins them around with it
+		auto hub = Engine::GameObject::CreateGameObject();
+		hub.Model = hexagon;
+		hub.Transform.Translation = { .7f, -.7f };
+		hub.Transform.Scale = glm::vec2(.06f);
+		hub.Color = colors[0];
+		hub.Node = this->m_Transforms.Create(Engine::TransformHierarchy::INVALID_NODE, hub.Transform);
+
+		for (int i = 0; i < 6; i++) {
+			const float angle = i * glm::two_pi<float>() / 6;
+			auto satellite = Engine::GameObject::CreateGameObject();
+			satellite.Model = model;
+			satellite.Transform.Translation = 2.5f * glm::vec2{ glm::cos(angle), glm::sin(angle) };
+			satellite.Transform.Scale = glm::vec2(.8f);
+			satellite.Color = colors[(i + 1) % colors.size()];
+			satellite.Node = this->m_Transforms.Create(hub.Node, satellite.Transform);
+
+			this->m_GameObjects.push_back(std::move(satellite));
 		}
-		else {
-			auto leftTop = 0.5f * (left + top);
-			auto rightTop = 0.5f * (right + top);
-			auto leftRight = 0.5f * (left + right);
-			Sierpinski(vertices, depth - 1, left, leftRight, leftTop);
-			Sierpinski(vertices, depth - 1, leftRight, right, rightTop);
-			Sierpinski(vertices, depth - 1, leftTop, rightTop, top);
+		this->m_GameObjects.push_back(std::move(hub));
+
+		// procedural geometry animated in place rather than rebuilt as a new model every step
+		this->m_Star = std::make_shared<Engine::DynamicModel>(this->m_Device, std::vector<Engine::DynamicModel::Vertex>(STAR_POINTS * 3));
+		this->AnimateStar();
+
+		auto star = Engine::GameObject::CreateGameObject();
+		star.DynamicModel = this->m_Star;
+		star.Transform.Translation = { -.7f, -.7f };
+		star.Transform.Scale = glm::vec2(.15f);
+		star.Color = colors[2];
+		this->m_GameObjects.push_back(std::move(star));
+
+		constexpr int columns = 48;
+		constexpr int rows = 36;
+		for (int y = 0; y < rows; y++) {
+			for (int x = 0; x < columns; x++) {
+				auto tile = Engine::GameObject::CreateGameObject();
+				tile.Model = hexagon;
+				tile.Transform.Translation = { -0.96f + x * (1.92f / (columns - 1)), -0.96f + y * (1.92f / (rows - 1)) };
+				tile.Transform.Scale = glm::vec2(.015f);
+				tile.Color = colors[(x + y) % colors.size()] * .25f;
+				tile.Static = true;
+
+				this->m_GameObjects.push_back(std::move(tile));
+			}
 		}
 	}
 }
\ No newline at end of file
@@ -2,13 +2,16 @@
 
 #include "../Engine/Window.hpp"
 #include "../Engine/Device.hpp"
+#include "../Engine/DynamicModel.hpp"
 #include "../Engine/GameObject.hpp"
 #include "../Engine/Renderer.hpp"
+#include "../Engine/TransformHierarchy.hpp"
 
 #include "../Engine/Utils/NonMoveable.hpp"
 #include "../Engine/Utils/NonCopyable.hpp"
 
 // std lib headers
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -22,6 +25,8 @@ namespace App {
 	public:
 		static constexpr int WIDTH = 800;
 		static constexpr int HEIGHT = 600;
+		static constexpr std::chrono::milliseconds ANIMATION_STEP{ 50 };
+		static constexpr std::chrono::seconds STATS_INTERVAL{ 1 };
 
 		FirstApp();
 		~FirstApp();
@@ -31,13 +36,17 @@ namespace App {
 
 	private:
 		void LoadGameObjects();
-		void Sierpinski(std::vector<Engine::Model::Vertex>&, int, glm::vec2, glm::vec2, glm::vec2);
+		// rewrites the star's points in its dynamic model
+		void AnimateStar();
 
 
 		Engine::Window m_Window{ "FirstApp", WIDTH, HEIGHT };
 		Engine::Device m_Device{ m_Window };
 		Engine::Renderer m_Renderer{ m_Window, m_Device };
 
+		Engine::TransformHierarchy m_Transforms;
 		std::vector<Engine::GameObject> m_GameObjects;
+		std::shared_ptr<Engine::DynamicModel> m_Star;
+		float m_StarPhase = 0.0f;
 	};
 }
\ No newline at end of file
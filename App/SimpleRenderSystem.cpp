@@ -1,4 +1,5 @@
 #include "./SimpleRenderSystem.hpp"
+#include "../Engine/PipelineLayoutCache.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -7,23 +8,36 @@
 
 
 // std lib headers
+#include <algorithm>
 #include <array>
 
 namespace App {
-	struct SimplePushConstantData {
+	// matches GlobalData in SimpleShader.vert (std140)
+	struct SimpleGlobalData {
+		glm::vec4 Transform{ 1.0f, 0.0f, 0.0f, 1.0f }; // mat2 packed by columns
+		glm::vec2 Offset{ 0.0f };
+	};
+
+	// matches ObjectData in SimpleShader.vert (std430)
+	struct SimpleObjectData {
 		glm::mat2 Transform{ 1.0f };
 		glm::vec2 Offset;
 		alignas(16) glm::vec3 Color;
 	};
 
-	SimpleRenderSystem::SimpleRenderSystem(Engine::Device& device, VkRenderPass renderPass) : m_Device{ device } {
-		this->CreatePipelineLayout();
+	constexpr const char* VERTEX_SHADER = "SimpleShader.vert";
+	constexpr const char* FRAGMENT_SHADER = "SimpleShader.frag";
+
+	// matches the constant_id declarations in SimpleShader.vert: USE_VERTEX_COLOR
+	using SimpleVertexConstants = Engine::SpecializationConstants<bool>;
+
+	SimpleRenderSystem::SimpleRenderSystem(Engine::Device& device, VkRenderPass renderPass, VkDescriptorSetLayout frameSetLayout)
+		: m_Device{ device }, m_StaticBatch{ device } {
+		this->CreatePipelineLayout(frameSetLayout);
 		this->CreatePipeline(renderPass);
 	}
 
-	SimpleRenderSystem::~SimpleRenderSystem() {
-		vkDestroyPipelineLayout(this->m_Device.GetDevice(), this->m_PipelineLayout, nullptr);
-	}
+	SimpleRenderSystem::~SimpleRenderSystem() {}
 
 
 	void SimpleRenderSystem::CreatePipeline(VkRenderPass renderPass) {
@@ -33,48 +47,254 @@ namespace App {
 		Engine::Pipeline::DefaultPipelineConfigurationInfo(config);
 		config.RenderPass = renderPass;
 		config.PipelineLayout = this->m_PipelineLayout;
-		m_Pipeline = std::make_unique<Engine::Pipeline>(this->m_Device, config, "./Shaders/SimpleShader.vert.spv", "./Shaders/SimpleShader.frag.spv");
+		// objects are flat shaded with their own color, the per-vertex color is compiled out
+		config.VertexSpecialization = SimpleVertexConstants{ false }.ToShaderSpecialization();
+		this->m_RenderState = Engine::Pipeline::MakeRenderStateDynamic(this->m_Device, config);
+		this->m_Pipeline = this->m_Device.GetPipelineRegistry().GetOrCreateAsync(config, VERTEX_SHADER, FRAGMENT_SHADER);
+
+		config.VertexSpecialization = SimpleVertexConstants{ true }.ToShaderSpecialization();
+		this->m_StaticPipeline = this->m_Device.GetPipelineRegistry().GetOrCreateAsync(config, VERTEX_SHADER, FRAGMENT_SHADER);
 	}
 
-	void SimpleRenderSystem::CreatePipelineLayout() {
+	void SimpleRenderSystem::CreatePipelineLayout(VkDescriptorSetLayout frameSetLayout) {
+		// set 0 is bound from the frame ring, the layout checks the shaders agree with it
+		const auto& layout = this->m_Device.GetPipelineLayoutCache().GetLayout(
+			{ VERTEX_SHADER, FRAGMENT_SHADER },
+			{ { 0, frameSetLayout } });
 
-		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(SimplePushConstantData);
+		layout.Interface.ValidateBlockSize(0, 0, sizeof(SimpleGlobalData), "SimpleGlobalData");
+		layout.Interface.ValidateArrayStride(0, 1, sizeof(SimpleObjectData), "SimpleObjectData");
+		auto attributeDescriptions = Engine::Model::Vertex::GetAttributeDescriptions();
+		layout.Interface.ValidateVertexInputs(attributeDescriptions.data(), attributeDescriptions.size());
 
+		this->m_PipelineLayout = layout.Layout;
+	}
 
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = 0;
-		pipelineLayoutInfo.pSetLayouts = nullptr;
-		pipelineLayoutInfo.pushConstantRangeCount = 1;
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-		if (vkCreatePipelineLayout(this->m_Device.GetDevice(), &pipelineLayoutInfo, nullptr, &this->m_PipelineLayout) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create pipeline layout!");
+	void SimpleRenderSystem::UpdateGameObjects(std::vector<Engine::GameObject>& gameObjects) {
+		int i = 0;
+
+		for (auto& obj : gameObjects) {
+			if (obj.Static) continue;
+			obj.Transform.Rotation = glm::mod<float>(obj.Transform.Rotation + 0.003f * i, 2.f * glm::pi<float>());
+			i++;
 		}
 	}
 
+	void SimpleRenderSystem::PropagateTransforms(std::vector<Engine::GameObject>& gameObjects, Engine::TransformHierarchy& transforms) {
+		for (auto& obj : gameObjects) {
+			if (obj.Node != Engine::TransformHierarchy::INVALID_NODE) transforms.SetLocal(obj.Node, obj.Transform);
+		}
+		transforms.Update();
+		this->m_Transforms = &transforms;
+	}
 
-	void SimpleRenderSystem::RenderGameObjects(VkCommandBuffer commandBuffer, std::vector<Engine::GameObject>& gameObjects) {
-		this->m_Pipeline->Bind(commandBuffer);
-		int i = 0;
+	void SimpleRenderSystem::SelectLods(std::vector<Engine::GameObject>& gameObjects, VkExtent2D extent) {
+		// clip space spans 2 units across the extent, so a radius R square covers R * scale * extent pixels a side
+		const float pixelArea = static_cast<float>(extent.width) * static_cast<float>(extent.height);
+		LodStats stats{};
 
 		for (auto& obj : gameObjects) {
-			obj.Transform.Rotation = glm::mod<float>(obj.Transform.Rotation + 0.001f * i, 2.f * glm::pi<float>());
+			if (obj.Model == nullptr) continue;
 
-			SimplePushConstantData pushConstantData{};
-			pushConstantData.Offset = obj.Transform.Translation;
-			pushConstantData.Color = obj.Color;
-			pushConstantData.Transform = obj.Transform.GetTransformMatrix();
+			// the determinant is the area scale of a world matrix, just the product of the scales for a flat transform
+			const float areaScale = obj.Node != Engine::TransformHierarchy::INVALID_NODE
+				? glm::abs(glm::determinant(this->m_Transforms->GetWorldMatrix(obj.Node)))
+				: glm::abs(obj.Transform.Scale.x * obj.Transform.Scale.y);
+			const float radius = obj.Model->GetBoundingRadius();
+			const float projectedArea = radius * radius * areaScale * pixelArea;
+			const uint32_t lod = obj.Model->SelectLod(projectedArea, std::min(obj.Lod, obj.Model->GetLodCount() - 1));
 
-			vkCmdPushConstants(commandBuffer, this->m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SimplePushConstantData), &pushConstantData);
+			if (lod != obj.Lod) stats.LodSwitches++;
+			obj.Lod = lod;
 
-			obj.Model->Bind(commandBuffer);
-			obj.Model->Draw(commandBuffer);
-			
-			i++;
+			const uint32_t drawn = obj.Model->GetLod(lod).GetTriangleCount();
+			stats.Objects++;
+			stats.TrianglesDrawn += drawn;
+			stats.TrianglesSaved += obj.Model->GetLod(0).GetTriangleCount() - drawn;
+		}
+
+		this->m_LodStats = stats;
+	}
+
+	void SimpleRenderSystem::BakeStaticObjects(std::vector<Engine::GameObject>& gameObjects) {
+		this->m_StaticBatch.Update(gameObjects);
+	}
+
+	SimpleRenderSystem::FrameData SimpleRenderSystem::UploadGameObjects(
+		const std::vector<Engine::GameObject>& gameObjects,
+		Engine::FrameRingBuffer& frameRing,
+		LinearArena& frameArena,
+		int frameIndex) {
+		FrameData frameData{};
+		frameData.FrameIndex = frameIndex;
+		// resolved once per frame so hashing and recording agree on whether anything is drawn
+		frameData.Pipeline = this->m_Pipeline.GetOr(nullptr);
+		frameData.StaticPipeline = this->m_StaticPipeline.GetOr(nullptr);
+		frameData.StaticVersion = this->m_StaticBatch.GetVersion();
+		frameData.TransformVersion = this->m_Transforms != nullptr ? this->m_Transforms->GetVersion() : 0;
+		frameData.GlobalOffset = frameRing.WriteUniform(SimpleGlobalData{}).Offset;
+		if (gameObjects.empty()) return frameData;
+
+		struct SortItem {
+			Engine::Model* Model;
+			uint32_t Lod;
+			uint32_t ObjectIndex;
+		};
+
+		// group objects by model and level so each run becomes one instanced draw, the index keeps submission order otherwise
+		ArenaVector<SortItem> sortList{ ArenaAllocator<SortItem>(frameArena) };
+		ArenaVector<uint32_t> dynamicList{ ArenaAllocator<uint32_t>(frameArena) };
+		sortList.reserve(gameObjects.size());
+		for (uint32_t i = 0; i < gameObjects.size(); i++) {
+			if (gameObjects[i].DynamicModel != nullptr) {
+				dynamicList.push_back(i);
+				continue;
+			}
+			if (gameObjects[i].Baked || gameObjects[i].Model == nullptr) continue;
+			sortList.push_back({ gameObjects[i].Model.get(), gameObjects[i].Lod, i });
+		}
+		std::sort(sortList.begin(), sortList.end(), [](const SortItem& a, const SortItem& b) {
+			if (a.Model != b.Model) return a.Model < b.Model;
+			return a.Lod != b.Lod ? a.Lod < b.Lod : a.ObjectIndex < b.ObjectIndex;
+		});
+
+		// one extra identity entry after the objects, baked chunks are already in world space
+		auto objectBlock = frameRing.AllocateStorage(sizeof(SimpleObjectData) * (sortList.size() + dynamicList.size() + 1));
+		auto* objectData = static_cast<SimpleObjectData*>(objectBlock.Data);
+		frameData.ObjectOffset = objectBlock.Offset;
+
+		auto writeObjectData = [&](uint32_t instance, const Engine::GameObject& obj) {
+			SimpleObjectData data{};
+			if (obj.Node != Engine::TransformHierarchy::INVALID_NODE) {
+				assert(this->m_Transforms != nullptr && "Objects with a transform node need PropagateTransforms first");
+				data.Transform = this->m_Transforms->GetWorldMatrix(obj.Node);
+				data.Offset = this->m_Transforms->GetWorldOffset(obj.Node);
+			} else {
+				data.Transform = obj.Transform.GetTransformMatrix();
+				data.Offset = obj.Transform.Translation;
+			}
+			data.Color = obj.Color;
+			objectData[instance] = data;
+		};
+
+		auto* batches = static_cast<DrawBatch*>(frameArena.Allocate(sizeof(DrawBatch) * sortList.size(), alignof(DrawBatch)));
+		uint32_t batchCount = 0;
+
+		for (uint32_t instance = 0; instance < sortList.size(); instance++) {
+			writeObjectData(instance, gameObjects[sortList[instance].ObjectIndex]);
+
+			const SortItem& item = sortList[instance];
+			if (batchCount == 0 || batches[batchCount - 1].Model != item.Model || batches[batchCount - 1].Lod != item.Lod) {
+				batches[batchCount++] = { item.Model, item.Lod, instance, 0 };
+				item.Model->Touch();
+			}
+			batches[batchCount - 1].InstanceCount++;
+		}
+
+		frameData.Batches = batches;
+		frameData.BatchCount = batchCount;
+
+		auto* dynamicDraws = static_cast<DynamicDraw*>(frameArena.Allocate(sizeof(DynamicDraw) * std::max<size_t>(dynamicList.size(), 1), alignof(DynamicDraw)));
+		for (uint32_t i = 0; i < dynamicList.size(); i++) {
+			const auto& obj = gameObjects[dynamicList[i]];
+			const uint32_t instance = static_cast<uint32_t>(sortList.size()) + i;
+			writeObjectData(instance, obj);
+
+			// here rather than at bind time, a replayed recording never binds again but reads the same frame copy
+			obj.DynamicModel->Flush(frameIndex);
+			dynamicDraws[i] = { obj.DynamicModel.get(), instance };
+		}
+
+		frameData.DynamicDraws = dynamicDraws;
+		frameData.DynamicDrawCount = static_cast<uint32_t>(dynamicList.size());
+
+		const uint32_t identityInstance = static_cast<uint32_t>(sortList.size() + dynamicList.size());
+		objectData[identityInstance] = SimpleObjectData{ glm::mat2{ 1.0f }, glm::vec2{ 0.0f }, glm::vec3{ 1.0f } };
+
+		// the global transform is the identity, so only chunks overlapping clip space can be visible
+		const auto& chunks = this->m_StaticBatch.GetChunks();
+		auto* staticBatches = static_cast<DrawBatch*>(frameArena.Allocate(sizeof(DrawBatch) * std::max<size_t>(chunks.size(), 1), alignof(DrawBatch)));
+		uint32_t staticBatchCount = 0;
+		for (const auto& chunk : chunks) {
+			if (chunk.Max.x < -1.0f || chunk.Min.x > 1.0f || chunk.Max.y < -1.0f || chunk.Min.y > 1.0f) continue;
+
+			staticBatches[staticBatchCount++] = { chunk.Model.get(), 0, identityInstance, 1 };
+			chunk.Model->Touch();
+		}
+
+		frameData.StaticBatches = staticBatches;
+		frameData.StaticBatchCount = staticBatchCount;
+		return frameData;
+	}
+
+	void SimpleRenderSystem::RenderGameObjects(VkCommandBuffer commandBuffer, const FrameData& frameData, Engine::FrameRingBuffer& frameRing) {
+		if (frameData.Pipeline == nullptr) return;
+
+		frameData.Pipeline->Bind(commandBuffer);
+		this->m_Device.GetDynamicStateCommands().Apply(commandBuffer, this->m_RenderState);
+		// camera and every object's data are bound once for the whole pass
+		frameRing.Bind(commandBuffer, this->m_PipelineLayout, 0, frameData.GlobalOffset, frameData.ObjectOffset);
+
+		for (uint32_t i = 0; i < frameData.BatchCount; i++) {
+			const DrawBatch& batch = frameData.Batches[i];
+			batch.Model->Bind(commandBuffer);
+			batch.Model->Draw(commandBuffer, batch.InstanceCount, batch.FirstInstance, batch.Lod);
+		}
+
+		for (uint32_t i = 0; i < frameData.DynamicDrawCount; i++) {
+			const DynamicDraw& draw = frameData.DynamicDraws[i];
+			draw.Model->Bind(commandBuffer, frameData.FrameIndex);
+			draw.Model->Draw(commandBuffer, 1, draw.Instance);
+		}
+
+		// every depth is 0, so chunks drawn last stay behind whatever the objects above covered
+		if (frameData.StaticPipeline == nullptr || frameData.StaticBatchCount == 0) return;
+
+		frameData.StaticPipeline->Bind(commandBuffer);
+		for (uint32_t i = 0; i < frameData.StaticBatchCount; i++) {
+			const DrawBatch& batch = frameData.StaticBatches[i];
+			batch.Model->Bind(commandBuffer);
+			batch.Model->Draw(commandBuffer, batch.InstanceCount, batch.FirstInstance, batch.Lod);
+		}
+	}
+
+	void SimpleRenderSystem::BuildSceneKey(const std::vector<Engine::GameObject>& gameObjects, const FrameData& frameData, Engine::CommandBufferKey& key) {
+		key.Add(gameObjects.size());
+		key.Add(reinterpret_cast<uintptr_t>(frameData.Pipeline));
+		key.Add(reinterpret_cast<uintptr_t>(frameData.StaticPipeline));
+
+		// recorded dynamic offsets are only valid while they point at this frame's copy of the data
+		key.Add(frameData.GlobalOffset);
+		key.Add(frameData.ObjectOffset);
+		// a parent's change moves its children without touching their own transforms
+		key.Add(frameData.TransformVersion);
+		key.Add(frameData.FrameIndex);
+
+		for (auto& obj : gameObjects) {
+			if (obj.DynamicModel != nullptr) {
+				// covers the vertex count, the vertices themselves are flushed into the frame copy before any replay
+				key.Add(reinterpret_cast<uintptr_t>(obj.DynamicModel.get()));
+				key.Add(obj.DynamicModel->GetVersion());
+			} else {
+				key.Add(reinterpret_cast<uintptr_t>(obj.Model.get()));
+				// unique across models, so it also tells apart a new model created at a freed one's address
+				key.Add(obj.Model ? obj.Model->GetVersion() : 0);
+			}
+			key.Add(obj.Lod);
+			key.AddBytes(obj.Color);
+			key.AddBytes(obj.Transform.Translation);
+			key.AddBytes(obj.Transform.Scale);
+			key.AddBytes(obj.Transform.Rotation);
+		}
+
+		// chunks are replaced whenever anything in them changes, so the model and its version cover the contents
+		key.Add(frameData.StaticVersion);
+		key.Add(frameData.StaticBatchCount);
+		for (uint32_t i = 0; i < frameData.StaticBatchCount; i++) {
+			key.Add(reinterpret_cast<uintptr_t>(frameData.StaticBatches[i].Model));
+			key.Add(frameData.StaticBatches[i].Model->GetVersion());
+			key.Add(frameData.StaticBatches[i].FirstInstance);
 		}
 	}
 }
\ No newline at end of file
@@ -1,8 +1,13 @@
 #pragma once
 
 #include "../Engine/Pipeline.hpp"
+#include "../Engine/CommandBufferCache.hpp"
+#include "../Engine/PipelineRegistry.hpp"
 #include "../Engine/Device.hpp"
 #include "../Engine/GameObject.hpp"
+#include "../Engine/FrameRingBuffer.hpp"
+#include "../Engine/StaticBatch.hpp"
+#include "../Engine/Utils/LinearArena.hpp"
 
 #include "../Engine/Utils/NonMoveable.hpp"
 #include "../Engine/Utils/NonCopyable.hpp"
@@ -14,19 +19,86 @@
 namespace App {
 	class SimpleRenderSystem : public NonMoveable, public NonCopyable {
 	public:
-		SimpleRenderSystem(Engine::Device&, VkRenderPass);
+		// one instanced draw per run of objects sharing a model and level of detail
+		struct DrawBatch {
+			Engine::Model* Model;
+			uint32_t Lod;
+			uint32_t FirstInstance;
+			uint32_t InstanceCount;
+		};
+
+		// one draw of a dynamic model from the frame slot's copy
+		struct DynamicDraw {
+			Engine::DynamicModel* Model;
+			uint32_t Instance;
+		};
+
+		// where this frame's data landed in the frame ring, valid until the frame slot is reused
+		struct FrameData {
+			// null while the pipeline is still compiling, nothing is drawn then
+			Engine::Pipeline* Pipeline = nullptr;
+			uint32_t GlobalOffset = 0;
+			uint32_t ObjectOffset = 0;
+			const DrawBatch* Batches = nullptr;
+			uint32_t BatchCount = 0;
+			const DynamicDraw* DynamicDraws = nullptr;
+			uint32_t DynamicDrawCount = 0;
+			// dynamic models are bound at this frame slot's copy
+			int FrameIndex = 0;
+			// visible baked chunks, each a single draw with the vertex colored pipeline
+			Engine::Pipeline* StaticPipeline = nullptr;
+			const DrawBatch* StaticBatches = nullptr;
+			uint32_t StaticBatchCount = 0;
+			uint64_t StaticVersion = 0;
+			// world transforms of hierarchy objects were read from this version
+			uint64_t TransformVersion = 0;
+		};
+
+		// triangle counts of the last SelectLods, saved is what drawing every object at level 0 would have added
+		struct LodStats {
+			uint32_t Objects = 0;
+			uint64_t TrianglesDrawn = 0;
+			uint64_t TrianglesSaved = 0;
+			uint32_t LodSwitches = 0;
+		};
+
+		SimpleRenderSystem(Engine::Device&, VkRenderPass, VkDescriptorSetLayout);
 		~SimpleRenderSystem();
 
-		void RenderGameObjects(VkCommandBuffer, std::vector<Engine::GameObject>&);
+		void UpdateGameObjects(std::vector<Engine::GameObject>&);
+		// copies the transforms of objects with a node into the hierarchy and updates it, later calls this frame
+		// draw those objects at their world transform
+		void PropagateTransforms(std::vector<Engine::GameObject>&, Engine::TransformHierarchy&);
+		// picks every object's level of detail from the pixels its model's bounds cover in the given extent
+		void SelectLods(std::vector<Engine::GameObject>&, VkExtent2D);
+		// merges static objects into the static batch, baked ones are skipped by UploadGameObjects
+		void BakeStaticObjects(std::vector<Engine::GameObject>&);
+		// also flushes dynamic models into the frame slot's copy, so it has to run before recording every frame
+		FrameData UploadGameObjects(const std::vector<Engine::GameObject>&, Engine::FrameRingBuffer&, LinearArena&, int);
+		void RenderGameObjects(VkCommandBuffer, const FrameData&, Engine::FrameRingBuffer&);
+
+		// appends everything RenderGameObjects records to the key
+		static void BuildSceneKey(const std::vector<Engine::GameObject>&, const FrameData&, Engine::CommandBufferKey&);
+
+		inline const LodStats& GetLodStats() const { return this->m_LodStats; }
+		inline const Engine::StaticBatch& GetStaticBatch() const { return this->m_StaticBatch; }
 
 	private:
 		void CreatePipeline(VkRenderPass);
-		void CreatePipelineLayout();
+		void CreatePipelineLayout(VkDescriptorSetLayout);
 
 
 		Engine::Device& m_Device;
 
-		std::unique_ptr<Engine::Pipeline> m_Pipeline;
+		Engine::PipelineHandle m_Pipeline;
+		// same shaders with the vertex color compiled in, baked chunks carry their objects' colors per vertex
+		Engine::PipelineHandle m_StaticPipeline;
+		// whatever the device lets us set per draw instead of baking it into the pipeline
+		Engine::RenderState m_RenderState;
 		VkPipelineLayout m_PipelineLayout;
+
+		LodStats m_LodStats;
+		const Engine::TransformHierarchy* m_Transforms = nullptr;
+		Engine::StaticBatch m_StaticBatch;
 	};
-}
\ No newline at end of file
+}
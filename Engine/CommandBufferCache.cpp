@@ -0,0 +1,101 @@
+#include "./CommandBufferCache.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <stdexcept>
+
+namespace Engine {
+	CommandBufferCache::CommandBufferCache(Device& device) : m_Device{ device } {}
+
+	CommandBufferCache::~CommandBufferCache() {
+		// the owner waits for the device to go idle first, so every buffer is free to release
+		for (auto& entry : this->m_Entries) {
+			if (entry.CommandBuffer != VK_NULL_HANDLE) {
+				vkFreeCommandBuffers(this->m_Device.GetDevice(), this->m_Device.GetCommandPool(), 1, &entry.CommandBuffer);
+			}
+		}
+	}
+
+	VkCommandBuffer CommandBufferCache::GetOrRecord(
+		const CommandBufferKey& key,
+		const VkCommandBufferInheritanceInfo& inheritanceInfo,
+		const std::function<void(VkCommandBuffer)>& record) {
+		uint64_t pendingValue = this->m_Device.GetFrameTimeline().GetPendingValue();
+		const uint64_t hash = key.GetHash();
+
+		for (auto& entry : this->m_Entries) {
+			if (!entry.Live || entry.Hash != hash || entry.Key.size() != key.GetWordCount()) continue;
+			if (!std::equal(entry.Key.begin(), entry.Key.end(), key.GetWords())) continue;
+
+			this->m_Stats.Hits++;
+			entry.LastUseValue = pendingValue;
+			return entry.CommandBuffer;
+		}
+
+		this->m_Stats.Misses++;
+		Entry& entry = this->AcquireEntry();
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		// recorded again from scratch when reused, vkBeginCommandBuffer resets it implicitly
+		if (vkBeginCommandBuffer(entry.CommandBuffer, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin recording secondary command buffer!");
+		}
+
+		record(entry.CommandBuffer);
+
+		if (vkEndCommandBuffer(entry.CommandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record secondary command buffer!");
+		}
+
+		entry.Hash = hash;
+		entry.Key.assign(key.GetWords(), key.GetWords() + key.GetWordCount());
+		entry.LastUseValue = pendingValue;
+		entry.Live = true;
+		this->m_LiveCount++;
+		return entry.CommandBuffer;
+	}
+
+	void CommandBufferCache::Invalidate() {
+		for (auto& entry : this->m_Entries) {
+			entry.Live = false;
+		}
+		this->m_LiveCount = 0;
+	}
+
+	void CommandBufferCache::Trim() {
+		uint64_t pendingValue = this->m_Device.GetFrameTimeline().GetPendingValue();
+
+		for (auto& entry : this->m_Entries) {
+			if (entry.Live && pendingValue - entry.LastUseValue > MAX_UNUSED_FRAMES) {
+				entry.Live = false;
+				this->m_LiveCount--;
+			}
+		}
+	}
+
+	CommandBufferCache::Entry& CommandBufferCache::AcquireEntry() {
+		FrameTimeline& timeline = this->m_Device.GetFrameTimeline();
+		for (auto& entry : this->m_Entries) {
+			// retired but possibly still executing on the GPU
+			if (!entry.Live && timeline.IsComplete(entry.LastUseValue)) return entry;
+		}
+
+		Entry& entry = this->m_Entries.emplace_back();
+
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocInfo.commandPool = this->m_Device.GetCommandPool();
+		allocInfo.commandBufferCount = 1;
+
+		if (vkAllocateCommandBuffers(this->m_Device.GetDevice(), &allocInfo, &entry.CommandBuffer) != VK_SUCCESS) {
+			this->m_Entries.pop_back();
+			throw std::runtime_error("failed to allocate secondary command buffer!");
+		}
+		return entry;
+	}
+}
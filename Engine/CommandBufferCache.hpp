@@ -0,0 +1,82 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./Utils/Hash.hpp"
+#include "./Utils/LinearArena.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Engine {
+
+	// Everything a recording depends on as raw words. Lookups compare the whole key, so neither a hash collision
+	// nor an object created at a freed one's address can replay a stale buffer. Built in the frame arena
+	class CommandBufferKey {
+	public:
+		CommandBufferKey(LinearArena& arena) : m_Words{ ArenaAllocator<uint64_t>{ arena } } {}
+
+		inline void Add(uint64_t word) { this->m_Words.push_back(word); }
+
+		// the object representation, zero padded to whole words
+		template<typename T>
+		inline void AddBytes(const T& value) { AppendKeyBytes(this->m_Words, value); }
+
+		inline const uint64_t* GetWords() const { return this->m_Words.data(); }
+		inline size_t GetWordCount() const { return this->m_Words.size(); }
+		inline uint64_t GetHash() const { return HashBytes(this->m_Words.data(), this->m_Words.size() * sizeof(uint64_t)); }
+
+	private:
+		ArenaVector<uint64_t> m_Words;
+	};
+
+	// Keeps recorded secondary command buffers around so unchanged content is replayed instead of re-recorded.
+	// Keys are supplied by the caller and must cover everything the recording depends on.
+	class CommandBufferCache : public NonMoveable, public NonCopyable {
+	public:
+		// entries unused for this many frames are recycled
+		static constexpr uint64_t MAX_UNUSED_FRAMES = 16;
+
+		struct Stats {
+			uint64_t Hits = 0;
+			uint64_t Misses = 0;
+		};
+
+		CommandBufferCache(Device&);
+		~CommandBufferCache();
+
+		VkCommandBuffer GetOrRecord(const CommandBufferKey&, const VkCommandBufferInheritanceInfo&, const std::function<void(VkCommandBuffer)>&);
+
+		void Invalidate();
+		void Trim();
+
+		inline const Stats& GetStats() const { return this->m_Stats; }
+		inline size_t Size() const { return this->m_LiveCount; }
+
+	private:
+		// entries are never erased, a retired one keeps its command buffer and key storage for the next miss
+		// once the GPU is done with it, so a warmed up cache records without touching the heap
+		struct Entry {
+			VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+			uint64_t Hash = 0;
+			std::vector<uint64_t> Key;
+			uint64_t LastUseValue = 0;
+			// reachable by key, otherwise retired
+			bool Live = false;
+		};
+
+		Entry& AcquireEntry();
+
+		Device& m_Device;
+
+		// a handful of scenes at most, scanned linearly with the hash checked before the key
+		std::vector<Entry> m_Entries;
+		size_t m_LiveCount = 0;
+
+		Stats m_Stats;
+	};
+}
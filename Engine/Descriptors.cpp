@@ -0,0 +1,376 @@
+#include "./Descriptors.hpp"
+#include "./Texture.hpp"
+#include "./Utils/Hash.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <stdexcept>
+
+namespace Engine {
+	// DescriptorLayoutCache
+
+	DescriptorLayoutCache::DescriptorLayoutCache(VkDevice device) : m_Device{ device } {}
+
+	DescriptorLayoutCache::~DescriptorLayoutCache() {
+		for (auto& keyAndLayout : this->m_Layouts) {
+			vkDestroyDescriptorSetLayout(this->m_Device, keyAndLayout.second, nullptr);
+		}
+	}
+
+	VkDescriptorSetLayout DescriptorLayoutCache::GetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings) {
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+		return this->GetLayout(layoutInfo);
+	}
+
+	VkDescriptorSetLayout DescriptorLayoutCache::GetLayout(const VkDescriptorSetLayoutCreateInfo& layoutInfo) {
+		LayoutKey key{};
+		key.Flags = layoutInfo.flags;
+		key.Bindings.assign(layoutInfo.pBindings, layoutInfo.pBindings + layoutInfo.bindingCount);
+		key.BindingFlags.assign(layoutInfo.bindingCount, 0);
+
+		// binding flags are the only extension we understand; they change the layout so they are part of the key
+		auto* next = static_cast<const VkBaseInStructure*>(layoutInfo.pNext);
+		for (; next != nullptr; next = next->pNext) {
+			if (next->sType == VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO) {
+				auto* flagsInfo = reinterpret_cast<const VkDescriptorSetLayoutBindingFlagsCreateInfo*>(next);
+				for (uint32_t i = 0; i < flagsInfo->bindingCount && i < layoutInfo.bindingCount; i++) {
+					key.BindingFlags[i] = flagsInfo->pBindingFlags[i];
+				}
+			}
+			else {
+				assert(false && "Unsupported extension struct in descriptor set layout create info");
+			}
+		}
+
+		// binding order in the create info doesn't matter, so sort to make equal layouts compare equal
+		std::vector<uint32_t> order(key.Bindings.size());
+		for (uint32_t i = 0; i < order.size(); i++) order[i] = i;
+		std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return key.Bindings[a].binding < key.Bindings[b].binding; });
+
+		LayoutKey sortedKey{};
+		sortedKey.Flags = key.Flags;
+		for (uint32_t index : order) {
+			VkDescriptorSetLayoutBinding binding = key.Bindings[index];
+			assert(binding.pImmutableSamplers == nullptr && "Immutable samplers are not supported by the layout cache");
+			sortedKey.Bindings.push_back(binding);
+			sortedKey.BindingFlags.push_back(key.BindingFlags[index]);
+		}
+
+		auto found = this->m_Layouts.find(sortedKey);
+		if (found != this->m_Layouts.end()) {
+			return found->second;
+		}
+
+		VkDescriptorSetLayout layout;
+		if (vkCreateDescriptorSetLayout(this->m_Device, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create descriptor set layout!");
+		}
+		auto inserted = this->m_Layouts.emplace(std::move(sortedKey), layout);
+		// keys are node based, the pointer stays valid for the cache's lifetime
+		this->m_LayoutKeys[layout] = &inserted.first->first;
+		return layout;
+	}
+
+	const std::vector<VkDescriptorSetLayoutBinding>* DescriptorLayoutCache::FindBindings(VkDescriptorSetLayout layout) const {
+		auto found = this->m_LayoutKeys.find(layout);
+		return found != this->m_LayoutKeys.end() ? &found->second->Bindings : nullptr;
+	}
+
+	bool DescriptorLayoutCache::LayoutKey::operator==(const LayoutKey& other) const {
+		if (this->Flags != other.Flags || this->Bindings.size() != other.Bindings.size() || this->BindingFlags != other.BindingFlags) {
+			return false;
+		}
+		for (size_t i = 0; i < this->Bindings.size(); i++) {
+			const auto& a = this->Bindings[i];
+			const auto& b = other.Bindings[i];
+			if (a.binding != b.binding || a.descriptorType != b.descriptorType ||
+				a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t DescriptorLayoutCache::LayoutKeyHash::operator()(const LayoutKey& key) const {
+		uint64_t hash = key.Flags;
+		for (size_t i = 0; i < key.Bindings.size(); i++) {
+			const auto& binding = key.Bindings[i];
+			HashCombine(hash, binding.binding);
+			HashCombine(hash, binding.descriptorType);
+			HashCombine(hash, binding.descriptorCount);
+			HashCombine(hash, binding.stageFlags);
+			HashCombine(hash, key.BindingFlags[i]);
+		}
+		return static_cast<size_t>(hash);
+	}
+
+	// DescriptorAllocator
+
+	DescriptorAllocator::DescriptorAllocator(VkDevice device, uint32_t setsPerPool) : m_Device{ device }, m_SetsPerPool{ setsPerPool } {}
+
+	DescriptorAllocator::~DescriptorAllocator() {
+		for (auto pool : this->m_UsedPools) {
+			vkDestroyDescriptorPool(this->m_Device, pool, nullptr);
+		}
+		for (auto pool : this->m_FreePools) {
+			vkDestroyDescriptorPool(this->m_Device, pool, nullptr);
+		}
+	}
+
+	VkDescriptorSet DescriptorAllocator::Allocate(VkDescriptorSetLayout layout, const void* next) {
+		if (this->m_CurrentPool == VK_NULL_HANDLE) {
+			this->m_CurrentPool = this->GrabPool();
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.pNext = next;
+		allocInfo.descriptorPool = this->m_CurrentPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &layout;
+
+		VkDescriptorSet set;
+		VkResult result = vkAllocateDescriptorSets(this->m_Device, &allocInfo, &set);
+
+		if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+			// the pool is exhausted, move on to a fresh one and retry once
+			this->m_CurrentPool = this->GrabPool();
+			allocInfo.descriptorPool = this->m_CurrentPool;
+			result = vkAllocateDescriptorSets(this->m_Device, &allocInfo, &set);
+		}
+
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate descriptor set!");
+		}
+		return set;
+	}
+
+	void DescriptorAllocator::ResetPools() {
+		for (auto pool : this->m_UsedPools) {
+			vkResetDescriptorPool(this->m_Device, pool, 0);
+			this->m_FreePools.push_back(pool);
+		}
+		this->m_UsedPools.clear();
+		this->m_CurrentPool = VK_NULL_HANDLE;
+	}
+
+	VkDescriptorPool DescriptorAllocator::GrabPool() {
+		VkDescriptorPool pool;
+
+		if (!this->m_FreePools.empty()) {
+			pool = this->m_FreePools.back();
+			this->m_FreePools.pop_back();
+		}
+		else {
+			// rough per-set ratios, a pool that runs out of one type is simply replaced
+			const std::array<std::pair<VkDescriptorType, float>, 7> ratios = { {
+				{ VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f },
+				{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f },
+				{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2.0f },
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f },
+				{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+				{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f }
+			} };
+
+			std::array<VkDescriptorPoolSize, ratios.size()> poolSizes{};
+			for (size_t i = 0; i < ratios.size(); i++) {
+				poolSizes[i].type = ratios[i].first;
+				poolSizes[i].descriptorCount = std::max(1u, static_cast<uint32_t>(ratios[i].second * this->m_SetsPerPool));
+			}
+
+			VkDescriptorPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			poolInfo.maxSets = this->m_SetsPerPool;
+			poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+			poolInfo.pPoolSizes = poolSizes.data();
+
+			if (vkCreateDescriptorPool(this->m_Device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create descriptor pool!");
+			}
+		}
+
+		this->m_UsedPools.push_back(pool);
+		return pool;
+	}
+
+	// BindlessTable
+
+	BindlessTable::BindlessTable(Device& device, uint32_t maxTextures, uint32_t maxBuffers) : m_Device{ device } {
+		assert(this->m_Device.SupportsBindless() && "Bindless descriptors need descriptor indexing support");
+
+		const auto& limits = this->m_Device.GetDescriptorIndexingProperties();
+		this->m_TextureSlots.Capacity = std::min(maxTextures, limits.maxDescriptorSetUpdateAfterBindSampledImages);
+		this->m_BufferSlots.Capacity = std::min(maxBuffers, limits.maxDescriptorSetUpdateAfterBindStorageBuffers);
+
+		std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+		bindings[TEXTURE_BINDING].binding = TEXTURE_BINDING;
+		bindings[TEXTURE_BINDING].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		bindings[TEXTURE_BINDING].descriptorCount = this->m_TextureSlots.Capacity;
+		bindings[TEXTURE_BINDING].stageFlags = VK_SHADER_STAGE_ALL;
+
+		bindings[BUFFER_BINDING].binding = BUFFER_BINDING;
+		bindings[BUFFER_BINDING].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[BUFFER_BINDING].descriptorCount = this->m_BufferSlots.Capacity;
+		bindings[BUFFER_BINDING].stageFlags = VK_SHADER_STAGE_ALL;
+
+		// slots may be empty and may be written while the set is bound by frames in flight
+		const VkDescriptorBindingFlags bindingFlags =
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+		std::array<VkDescriptorBindingFlags, 2> flags = { bindingFlags, bindingFlags };
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+		flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		flagsInfo.bindingCount = static_cast<uint32_t>(flags.size());
+		flagsInfo.pBindingFlags = flags.data();
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext = &flagsInfo;
+		layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+
+		this->m_DescriptorSetLayout = this->m_Device.GetDescriptorLayoutCache().GetLayout(layoutInfo);
+
+		std::array<VkDescriptorPoolSize, 2> poolSizes{};
+		poolSizes[0] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, this->m_TextureSlots.Capacity };
+		poolSizes[1] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, this->m_BufferSlots.Capacity };
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		poolInfo.maxSets = 1;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+
+		if (vkCreateDescriptorPool(this->m_Device.GetDevice(), &poolInfo, nullptr, &this->m_DescriptorPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create bindless descriptor pool!");
+		}
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = this->m_DescriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &this->m_DescriptorSetLayout;
+
+		if (vkAllocateDescriptorSets(this->m_Device.GetDevice(), &allocInfo, &this->m_DescriptorSet) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate bindless descriptor set!");
+		}
+	}
+
+	BindlessTable::~BindlessTable() {
+		// the layout belongs to the device's layout cache
+		vkDestroyDescriptorPool(this->m_Device.GetDevice(), this->m_DescriptorPool, nullptr);
+	}
+
+	uint32_t BindlessTable::AddTexture(VkImageView imageView, VkSampler sampler, VkImageLayout layout) {
+		uint32_t index = this->AllocateSlot(this->m_TextureSlots);
+		this->UpdateTexture(index, imageView, sampler, layout);
+		return index;
+	}
+
+	uint32_t BindlessTable::AddTexture(Texture& texture) {
+		const VkDescriptorImageInfo info = texture.GetDescriptorInfo();
+		const uint32_t index = this->AddTexture(info.imageView, info.sampler, info.imageLayout);
+
+		if (index >= this->m_TextureOwners.size()) this->m_TextureOwners.resize(index + 1, nullptr);
+		this->m_TextureOwners[index] = &texture;
+		return index;
+	}
+
+	void BindlessTable::UpdateTexture(uint32_t index, VkImageView imageView, VkSampler sampler, VkImageLayout layout) {
+		VkDescriptorImageInfo imageInfo{ sampler, imageView, layout };
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = this->m_DescriptorSet;
+		write.dstBinding = TEXTURE_BINDING;
+		write.dstArrayElement = index;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.pImageInfo = &imageInfo;
+
+		vkUpdateDescriptorSets(this->m_Device.GetDevice(), 1, &write, 0, nullptr);
+	}
+
+	uint32_t BindlessTable::MoveTexture(uint32_t index, Texture& texture) {
+		const uint32_t newIndex = this->AddTexture(texture);
+		this->RemoveTexture(index);
+		return newIndex;
+	}
+
+	void BindlessTable::RemoveTexture(uint32_t index) {
+		if (index < this->m_TextureOwners.size()) this->m_TextureOwners[index] = nullptr;
+		this->ReleaseSlot(this->m_TextureSlots, index);
+	}
+
+	void BindlessTable::TouchTexture(uint32_t index) {
+		if (index < this->m_TextureOwners.size() && this->m_TextureOwners[index] != nullptr) {
+			this->m_TextureOwners[index]->Touch();
+		}
+	}
+
+	uint32_t BindlessTable::AddBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+		uint32_t index = this->AllocateSlot(this->m_BufferSlots);
+
+		VkDescriptorBufferInfo bufferInfo{ buffer, offset, range };
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = this->m_DescriptorSet;
+		write.dstBinding = BUFFER_BINDING;
+		write.dstArrayElement = index;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		write.pBufferInfo = &bufferInfo;
+
+		vkUpdateDescriptorSets(this->m_Device.GetDevice(), 1, &write, 0, nullptr);
+		return index;
+	}
+
+	void BindlessTable::RemoveBuffer(uint32_t index) {
+		this->ReleaseSlot(this->m_BufferSlots, index);
+	}
+
+	void BindlessTable::Bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t set) {
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, set, 1, &this->m_DescriptorSet, 0, nullptr);
+	}
+
+	uint32_t BindlessTable::AllocateSlot(SlotAllocator& slots) {
+		FrameTimeline& timeline = this->m_Device.GetFrameTimeline();
+		for (size_t i = 0; i < slots.PendingSlots.size();) {
+			if (timeline.IsComplete(slots.PendingSlots[i].first)) {
+				slots.FreeSlots.push_back(slots.PendingSlots[i].second);
+				slots.PendingSlots[i] = slots.PendingSlots.back();
+				slots.PendingSlots.pop_back();
+			}
+			else {
+				i++;
+			}
+		}
+
+		if (!slots.FreeSlots.empty()) {
+			uint32_t index = slots.FreeSlots.back();
+			slots.FreeSlots.pop_back();
+			return index;
+		}
+
+		if (slots.Next >= slots.Capacity) {
+			throw std::runtime_error("bindless descriptor table is full!");
+		}
+		return slots.Next++;
+	}
+
+	void BindlessTable::ReleaseSlot(SlotAllocator& slots, uint32_t index) {
+		// frames already recorded may still index the slot, it is handed out again once they completed
+		slots.PendingSlots.push_back({ this->m_Device.GetFrameTimeline().GetPendingValue(), index });
+	}
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "./Device.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Engine {
+	class Texture;
+
+	// Deduplicates descriptor set layouts, keyed by a hash of their bindings (and binding flags).
+	// Layouts live as long as the cache, callers never destroy them.
+	class DescriptorLayoutCache : public NonMoveable, public NonCopyable {
+	public:
+		DescriptorLayoutCache(VkDevice);
+		~DescriptorLayoutCache();
+
+		VkDescriptorSetLayout GetLayout(const VkDescriptorSetLayoutCreateInfo&);
+		VkDescriptorSetLayout GetLayout(const std::vector<VkDescriptorSetLayoutBinding>&);
+		// bindings a cached layout was created with, sorted by binding, nullptr for layouts from elsewhere
+		const std::vector<VkDescriptorSetLayoutBinding>* FindBindings(VkDescriptorSetLayout) const;
+
+	private:
+		struct LayoutKey {
+			std::vector<VkDescriptorSetLayoutBinding> Bindings;
+			std::vector<VkDescriptorBindingFlags> BindingFlags;
+			VkDescriptorSetLayoutCreateFlags Flags;
+
+			bool operator==(const LayoutKey&) const;
+		};
+
+		struct LayoutKeyHash {
+			size_t operator()(const LayoutKey&) const;
+		};
+
+		VkDevice m_Device;
+		std::unordered_map<LayoutKey, VkDescriptorSetLayout, LayoutKeyHash> m_Layouts;
+		std::unordered_map<VkDescriptorSetLayout, const LayoutKey*> m_LayoutKeys;
+	};
+
+	// Hands out descriptor sets from a list of pools, adding a pool whenever the current one runs dry.
+	// ResetPools recycles every set at once, which is how per-frame allocators are cleared.
+	class DescriptorAllocator : public NonMoveable, public NonCopyable {
+	public:
+		static constexpr uint32_t DEFAULT_SETS_PER_POOL = 256;
+
+		DescriptorAllocator(VkDevice, uint32_t = DEFAULT_SETS_PER_POOL);
+		~DescriptorAllocator();
+
+		VkDescriptorSet Allocate(VkDescriptorSetLayout, const void* = nullptr);
+		void ResetPools();
+
+		inline size_t GetPoolCount() const { return this->m_UsedPools.size() + this->m_FreePools.size(); }
+
+	private:
+		VkDescriptorPool GrabPool();
+
+		VkDevice m_Device;
+		uint32_t m_SetsPerPool;
+
+		VkDescriptorPool m_CurrentPool = VK_NULL_HANDLE;
+		std::vector<VkDescriptorPool> m_UsedPools;
+		std::vector<VkDescriptorPool> m_FreePools;
+	};
+
+	// One big update-after-bind descriptor set (VK_EXT_descriptor_indexing, core in 1.2) holding every texture and
+	// storage buffer. Bound once per pass, shaders pick resources by index, typically passed in a push constant:
+	//   binding 0 - sampler2D textures[]
+	//   binding 1 - storage buffers[]
+	class BindlessTable : public NonMoveable, public NonCopyable {
+	public:
+		static constexpr uint32_t TEXTURE_BINDING = 0;
+		static constexpr uint32_t BUFFER_BINDING = 1;
+		static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+		BindlessTable(Device&, uint32_t = 4096, uint32_t = 1024);
+		~BindlessTable();
+
+		uint32_t AddTexture(VkImageView, VkSampler, VkImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		// the texture moves to a new slot itself when its view changes and removes it when destroyed, see Texture::GetBindlessIndex
+		uint32_t AddTexture(Texture&);
+		// only for slots no recorded frame can index yet, it's not deferred
+		void UpdateTexture(uint32_t, VkImageView, VkSampler, VkImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		// writes the texture's current view and sampler into a new slot and releases the old one once frames in
+		// flight are done with it, returns the new slot
+		uint32_t MoveTexture(uint32_t, Texture&);
+		void RemoveTexture(uint32_t);
+		// marks the texture in the slot as sampled this frame, for slots added from a Texture
+		void TouchTexture(uint32_t);
+
+		uint32_t AddBuffer(VkBuffer, VkDeviceSize = 0, VkDeviceSize = VK_WHOLE_SIZE);
+		void RemoveBuffer(uint32_t);
+
+		void Bind(VkCommandBuffer, VkPipelineLayout, uint32_t);
+
+		inline VkDescriptorSetLayout GetDescriptorSetLayout() const { return this->m_DescriptorSetLayout; }
+
+	private:
+		struct SlotAllocator {
+			uint32_t Capacity = 0;
+			uint32_t Next = 0;
+			std::vector<uint32_t> FreeSlots;
+			// released slots and the frame timeline value after which shaders can no longer index them
+			std::vector<std::pair<uint64_t, uint32_t>> PendingSlots;
+		};
+
+		uint32_t AllocateSlot(SlotAllocator&);
+		void ReleaseSlot(SlotAllocator&, uint32_t);
+
+		Device& m_Device;
+
+		VkDescriptorSetLayout m_DescriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+
+		SlotAllocator m_TextureSlots;
+		SlotAllocator m_BufferSlots;
+		// by texture slot, null for slots added from a bare view
+		std::vector<Texture*> m_TextureOwners;
+	};
+}
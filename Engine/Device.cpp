@@ -1,4 +1,12 @@
 #include "Device.hpp"
+#include "Descriptors.hpp"
+#include "PipelineRegistry.hpp"
+#include "ShaderRegistry.hpp"
+#include "PipelineLayoutCache.hpp"
+#include "ModelCache.hpp"
+#include "ResidencyManager.hpp"
+#include "GpuAllocator.hpp"
+#include "Texture.hpp"
 
 // std lib headers
 #include <iostream>
@@ -54,9 +62,43 @@ namespace Engine {
 		this->PickPhysicalDevice();
 		this->CreateLogicalDevice();
 		this->CreateCommandPool();
+		this->CreatePipelineCache();
+
+		this->m_FrameTimeline = std::make_unique<FrameTimeline>(this->m_Device);
+		this->m_GpuAllocator = std::make_unique<GpuAllocator>(*this);
+		this->m_DescriptorLayoutCache = std::make_unique<DescriptorLayoutCache>(this->m_Device);
+		this->m_PipelineLayoutCache = std::make_unique<PipelineLayoutCache>(*this);
+		this->m_ShaderRegistry = std::make_unique<ShaderRegistry>(this->m_Device);
+		if (const uint32_t archivedShaders = this->m_ShaderRegistry->GetArchiveEntryCount()) {
+			std::cout << "shader archive: " << archivedShaders << " shaders" << std::endl;
+		}
+		else {
+			std::cout << "shader archive: empty or not found, loading loose shaders" << std::endl;
+		}
+		this->m_PipelineRegistry = std::make_unique<PipelineRegistry>(*this);
+		this->m_SamplerCache = std::make_unique<SamplerCache>(*this);
+		this->m_ResidencyManager = std::make_unique<ResidencyManager>(*this);
+		this->m_ModelCache = std::make_unique<ModelCache>(*this);
 	}
 
 	Device::~Device() {
+		// compiler threads hold shader leases, so pipelines go first
+		this->m_PipelineRegistry.reset();
+		this->m_ShaderRegistry.reset();
+
+		// cached models defer their buffers' destruction to the timeline and unregister from residency tracking
+		this->m_ModelCache.reset();
+		this->m_ResidencyManager.reset();
+
+		// flushes deferred destructions, so it has to go before the device itself
+		this->m_FrameTimeline.reset();
+		// the flush hands the last ranges back to it
+		this->m_GpuAllocator.reset();
+		this->m_PipelineLayoutCache.reset();
+		this->m_DescriptorLayoutCache.reset();
+		this->m_SamplerCache.reset();
+
+		vkDestroyPipelineCache(this->m_Device, this->m_PipelineCache, nullptr);
 		vkDestroyCommandPool(this->m_Device, this->m_CommandPool, nullptr);
 		vkDestroyDevice(this->m_Device, nullptr);
 
@@ -79,7 +121,7 @@ namespace Engine {
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "MyEngine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		appInfo.apiVersion = VK_API_VERSION_1_2;
 
 		VkInstanceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -132,6 +174,131 @@ namespace Engine {
 
 		vkGetPhysicalDeviceProperties(this->m_PhysicalDevice, &properties);
 		std::cout << "physical device: " << properties.deviceName << std::endl;
+
+		VkPhysicalDeviceFeatures features;
+		vkGetPhysicalDeviceFeatures(this->m_PhysicalDevice, &features);
+		this->m_SupportsTextureCompressionBC = features.textureCompressionBC;
+
+		this->QueryDescriptorIndexingSupport();
+		this->QueryExtendedDynamicStateSupport();
+		this->QueryMemoryBudgetSupport();
+	}
+
+	void Device::QueryDescriptorIndexingSupport() {
+		VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+		VkPhysicalDeviceFeatures2 supportedFeatures = {};
+		supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supportedFeatures.pNext = &vulkan12Features;
+		vkGetPhysicalDeviceFeatures2(this->m_PhysicalDevice, &supportedFeatures);
+
+		// the subset the bindless table relies on, anything missing and it simply isn't created
+		this->m_SupportsBindless =
+			vulkan12Features.descriptorIndexing &&
+			vulkan12Features.runtimeDescriptorArray &&
+			vulkan12Features.descriptorBindingPartiallyBound &&
+			vulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+			vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+			vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+			vulkan12Features.shaderSampledImageArrayNonUniformIndexing;
+
+		this->m_DescriptorIndexingProperties = {};
+		this->m_DescriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+		VkPhysicalDeviceProperties2 properties2 = {};
+		properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties2.pNext = &this->m_DescriptorIndexingProperties;
+		vkGetPhysicalDeviceProperties2(this->m_PhysicalDevice, &properties2);
+
+		std::cout << "bindless descriptors: " << (this->m_SupportsBindless ? "supported" : "not supported") << std::endl;
+	}
+
+	void Device::QueryExtendedDynamicStateSupport() {
+		uint32_t extensionCount;
+		vkEnumerateDeviceExtensionProperties(this->m_PhysicalDevice, nullptr, &extensionCount, nullptr);
+
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(this->m_PhysicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+		std::set<std::string> available;
+		for (const auto& extension : availableExtensions) {
+			available.insert(extension.extensionName);
+		}
+
+		VkPhysicalDeviceExtendedDynamicState3FeaturesEXT state3Features = {};
+		state3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+
+		VkPhysicalDeviceExtendedDynamicState2FeaturesEXT state2Features = {};
+		state2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+
+		VkPhysicalDeviceExtendedDynamicStateFeaturesEXT stateFeatures = {};
+		stateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+
+		// only chain the structs of extensions that exist, unknown structs are not allowed in the query
+		bool hasState = available.count(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME) != 0;
+		bool hasState2 = available.count(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME) != 0;
+		bool hasState3 = available.count(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME) != 0;
+
+		void* chain = nullptr;
+		if (hasState3) { state3Features.pNext = chain; chain = &state3Features; }
+		if (hasState2) { state2Features.pNext = chain; chain = &state2Features; }
+		if (hasState) { stateFeatures.pNext = chain; chain = &stateFeatures; }
+
+		VkPhysicalDeviceFeatures2 supportedFeatures = {};
+		supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supportedFeatures.pNext = chain;
+		vkGetPhysicalDeviceFeatures2(this->m_PhysicalDevice, &supportedFeatures);
+
+		auto& support = this->m_ExtendedDynamicStateSupport;
+		support = {};
+		support.State = hasState && stateFeatures.extendedDynamicState;
+		// the later groups are only useful on top of the first, pipelines keep everything baked otherwise
+		support.State2 = support.State && hasState2 && state2Features.extendedDynamicState2;
+		support.ColorBlend = support.State && hasState3 &&
+			state3Features.extendedDynamicState3ColorBlendEnable &&
+			state3Features.extendedDynamicState3ColorBlendEquation &&
+			state3Features.extendedDynamicState3ColorWriteMask;
+
+		if (support.State && hasState3) {
+			VkPhysicalDeviceExtendedDynamicState3PropertiesEXT state3Properties = {};
+			state3Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_PROPERTIES_EXT;
+
+			VkPhysicalDeviceProperties2 properties2 = {};
+			properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			properties2.pNext = &state3Properties;
+			vkGetPhysicalDeviceProperties2(this->m_PhysicalDevice, &properties2);
+			support.UnrestrictedTopology = state3Properties.dynamicPrimitiveTopologyUnrestricted;
+		}
+
+		this->m_EnabledExtensions.assign(this->m_DeviceExtensions.begin(), this->m_DeviceExtensions.end());
+		if (support.State) this->m_EnabledExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+		if (support.State2) this->m_EnabledExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+		if (support.ColorBlend) this->m_EnabledExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+
+		std::cout << "extended dynamic state: "
+			<< (support.State ? "1" : "-") << (support.State2 ? " 2" : " -") << (support.ColorBlend ? " 3" : " -") << std::endl;
+	}
+
+	void Device::QueryMemoryBudgetSupport() {
+		uint32_t extensionCount;
+		vkEnumerateDeviceExtensionProperties(this->m_PhysicalDevice, nullptr, &extensionCount, nullptr);
+
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(this->m_PhysicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+		this->m_SupportsMemoryBudget = false;
+		for (const auto& extension : availableExtensions) {
+			if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0) {
+				this->m_SupportsMemoryBudget = true;
+				break;
+			}
+		}
+
+		// properties2 is core since 1.1, the extension needs nothing else
+		if (this->m_SupportsMemoryBudget) this->m_EnabledExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+		std::cout << "memory budget: " << (this->m_SupportsMemoryBudget ? "supported" : "not supported, using heap sizes") << std::endl;
 	}
 
 	void Device::CreateLogicalDevice() {
@@ -152,16 +319,51 @@ namespace Engine {
 
 		VkPhysicalDeviceFeatures deviceFeatures = {};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		deviceFeatures.textureCompressionBC = this->m_SupportsTextureCompressionBC ? VK_TRUE : VK_FALSE;
+
+		VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		vulkan12Features.timelineSemaphore = VK_TRUE;
+		if (this->m_SupportsBindless) {
+			vulkan12Features.descriptorIndexing = VK_TRUE;
+			vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+			vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+			vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+			vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+			vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+			vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		}
+
+		const auto& dynamicStateSupport = this->m_ExtendedDynamicStateSupport;
+
+		VkPhysicalDeviceExtendedDynamicStateFeaturesEXT stateFeatures = {};
+		stateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+		stateFeatures.extendedDynamicState = VK_TRUE;
+
+		VkPhysicalDeviceExtendedDynamicState2FeaturesEXT state2Features = {};
+		state2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+		state2Features.extendedDynamicState2 = VK_TRUE;
+
+		VkPhysicalDeviceExtendedDynamicState3FeaturesEXT state3Features = {};
+		state3Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+		state3Features.extendedDynamicState3ColorBlendEnable = VK_TRUE;
+		state3Features.extendedDynamicState3ColorBlendEquation = VK_TRUE;
+		state3Features.extendedDynamicState3ColorWriteMask = VK_TRUE;
+
+		if (dynamicStateSupport.ColorBlend) { state3Features.pNext = vulkan12Features.pNext; vulkan12Features.pNext = &state3Features; }
+		if (dynamicStateSupport.State2) { state2Features.pNext = vulkan12Features.pNext; vulkan12Features.pNext = &state2Features; }
+		if (dynamicStateSupport.State) { stateFeatures.pNext = vulkan12Features.pNext; vulkan12Features.pNext = &stateFeatures; }
 
 		VkDeviceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = &vulkan12Features;
 
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
 		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(this->m_DeviceExtensions.size());
-		createInfo.ppEnabledExtensionNames = this->m_DeviceExtensions.data();
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(this->m_EnabledExtensions.size());
+		createInfo.ppEnabledExtensionNames = this->m_EnabledExtensions.data();
 
 		// might not really be necessary anymore because device specific validation layers
 		// have been deprecated
@@ -179,6 +381,8 @@ namespace Engine {
 
 		vkGetDeviceQueue(this->m_Device, indices.GraphicsFamily, 0, &this->m_GraphicsQueue);
 		vkGetDeviceQueue(this->m_Device, indices.PresentFamily, 0, &this->m_PresentQueue);
+
+		this->m_DynamicStateCommands.Load(this->m_Device, this->m_ExtendedDynamicStateSupport);
 	}
 
 	void Device::CreateCommandPool() {
@@ -195,6 +399,15 @@ namespace Engine {
 		}
 	}
 
+	void Device::CreatePipelineCache() {
+		VkPipelineCacheCreateInfo cacheInfo = {};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+		if (vkCreatePipelineCache(this->m_Device, &cacheInfo, nullptr, &this->m_PipelineCache) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline cache!");
+		}
+	}
+
 	void Device::CreateSurface() { this->m_Window.CreateWindowSurface(this->m_Instance, &this->m_Surface); }
 
 	bool Device::IsDeviceSuitable(VkPhysicalDevice device) {
@@ -208,11 +421,22 @@ namespace Engine {
 			swapChainAdequate = !swapChainSupport.Formats.empty() && !swapChainSupport.PresentModes.empty();
 		}
 
-		VkPhysicalDeviceFeatures supportedFeatures;
-		vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(device, &deviceProperties);
+		if (deviceProperties.apiVersion < VK_API_VERSION_1_2) {
+			return false;
+		}
+
+		VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+		vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+		VkPhysicalDeviceFeatures2 supportedFeatures = {};
+		supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supportedFeatures.pNext = &vulkan12Features;
+		vkGetPhysicalDeviceFeatures2(device, &supportedFeatures);
 
 		return indices.IsComplete() && extensionsSupported && swapChainAdequate &&
-			supportedFeatures.samplerAnisotropy;
+			supportedFeatures.features.samplerAnisotropy && vulkan12Features.timelineSemaphore;
 	}
 
 	void Device::PopulateDebugMessengerCreateInfo(
@@ -391,6 +615,18 @@ namespace Engine {
 		throw std::runtime_error("failed to find supported format!");
 	}
 
+	VkFormatFeatureFlags Device::GetOptimalTilingFeatures(VkFormat format) {
+		VkFormatProperties props;
+		vkGetPhysicalDeviceFormatProperties(this->m_PhysicalDevice, format, &props);
+		return props.optimalTilingFeatures;
+	}
+
+	void Device::WaitIdle() {
+		// vkDeviceWaitIdle needs every queue externally synchronized
+		std::lock_guard<std::mutex> lock(this->m_QueueMutex);
+		vkDeviceWaitIdle(this->m_Device);
+	}
+
 	uint32_t Device::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
 		VkPhysicalDeviceMemoryProperties memProperties;
 		vkGetPhysicalDeviceMemoryProperties(this->m_PhysicalDevice, &memProperties);
@@ -404,6 +640,34 @@ namespace Engine {
 		throw std::runtime_error("failed to find suitable memory type!");
 	}
 
+	MemoryBudget Device::QueryMemoryBudget() {
+		// without the extension nothing tells us about other processes, so leave them some of the heap
+		constexpr VkDeviceSize FALLBACK_BUDGET_PERCENT = 80;
+
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+		budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+		VkPhysicalDeviceMemoryProperties2 memoryProperties = {};
+		memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+		memoryProperties.pNext = this->m_SupportsMemoryBudget ? &budgetProperties : nullptr;
+		vkGetPhysicalDeviceMemoryProperties2(this->m_PhysicalDevice, &memoryProperties);
+
+		MemoryBudget budget{};
+		const auto& heaps = memoryProperties.memoryProperties;
+		for (uint32_t heap = 0; heap < heaps.memoryHeapCount; heap++) {
+			if ((heaps.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0) continue;
+
+			if (this->m_SupportsMemoryBudget) {
+				budget.Budget += budgetProperties.heapBudget[heap];
+				budget.Usage += budgetProperties.heapUsage[heap];
+			}
+			else {
+				budget.Budget += heaps.memoryHeaps[heap].size / 100 * FALLBACK_BUDGET_PERCENT;
+			}
+		}
+		return budget;
+	}
+
 	void Device::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
 		VkBufferCreateInfo bufferInfo{};
 		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -456,12 +720,50 @@ namespace Engine {
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &commandBuffer;
 
-		vkQueueSubmit(this->m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(this->m_GraphicsQueue);
+		{
+			std::lock_guard<std::mutex> lock(this->m_QueueMutex);
+			vkQueueSubmit(this->m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+			vkQueueWaitIdle(this->m_GraphicsQueue);
+		}
 
 		vkFreeCommandBuffers(this->m_Device, this->m_CommandPool, 1, &commandBuffer);
 	}
 
+	uint64_t Device::EndSingleTimeCommandsDeferred(VkCommandBuffer commandBuffer) {
+		// make the transfer visible to whatever later submissions on the queue read it
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		vkEndCommandBuffer(commandBuffer);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &commandBuffer;
+
+		{
+			std::lock_guard<std::mutex> lock(this->m_QueueMutex);
+			if (vkQueueSubmit(this->m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+				throw std::runtime_error("failed to submit single time commands!");
+			}
+		}
+
+		// the next frame's timeline signal covers every earlier submission on the graphics queue
+		uint64_t completionValue = this->m_FrameTimeline->GetPendingValue();
+		VkDevice device = this->m_Device;
+		VkCommandPool commandPool = this->m_CommandPool;
+		this->m_FrameTimeline->OnComplete(completionValue, [device, commandPool, commandBuffer]() {
+			vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+		});
+
+		return completionValue;
+	}
+
 	void Device::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
 		VkCommandBuffer commandBuffer = this->BeginSingleTimeCommands();
 
@@ -1,20 +1,41 @@
 #pragma once
 
 #include "Window.hpp"
+#include "FrameTimeline.hpp"
+#include "DynamicState.hpp"
 #include "./Utils/NonMoveable.hpp"
 #include "./Utils/NonCopyable.hpp"
 
 // std lib headers
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 namespace Engine {
+	class DescriptorLayoutCache;
+	class PipelineRegistry;
+	class ShaderRegistry;
+	class PipelineLayoutCache;
+	class SamplerCache;
+	class ModelCache;
+	class ResidencyManager;
+	class GpuAllocator;
+
 	struct SwapChainSupportDetails {
 		VkSurfaceCapabilitiesKHR Capabilities;
 		std::vector<VkSurfaceFormatKHR> Formats;
 		std::vector<VkPresentModeKHR> PresentModes;
 	};
 
+	// summed over the device local heaps
+	struct MemoryBudget {
+		// what the process can allocate before the driver starts paging or failing allocations
+		VkDeviceSize Budget = 0;
+		// the process' current usage, 0 when the device can't report it
+		VkDeviceSize Usage = 0;
+	};
+
 	struct QueueFamilyIndices {
 		uint32_t GraphicsFamily = -1;
 		uint32_t PresentFamily = -1;
@@ -37,22 +58,52 @@ namespace Engine {
 
 
 		inline VkCommandPool GetCommandPool() { return this->m_CommandPool; }
+		// internally synchronized, shared by every pipeline compile including background ones
+		inline VkPipelineCache GetPipelineCache() { return this->m_PipelineCache; }
 		inline VkDevice GetDevice() { return this->m_Device; }
 		inline VkSurfaceKHR Surface() { return this->m_Surface; }
 		inline VkQueue GraphicsQueue() { return this->m_GraphicsQueue; }
 		inline VkQueue PresentQueue() { return this->m_PresentQueue; }
+		// guards every vkQueueSubmit / vkQueuePresentKHR, frames are submitted from their own thread
+		inline std::mutex& GetQueueMutex() { return this->m_QueueMutex; }
+		inline FrameTimeline& GetFrameTimeline() { return *this->m_FrameTimeline; }
+		inline DescriptorLayoutCache& GetDescriptorLayoutCache() { return *this->m_DescriptorLayoutCache; }
+		inline PipelineRegistry& GetPipelineRegistry() { return *this->m_PipelineRegistry; }
+		inline ShaderRegistry& GetShaderRegistry() { return *this->m_ShaderRegistry; }
+		inline PipelineLayoutCache& GetPipelineLayoutCache() { return *this->m_PipelineLayoutCache; }
+		inline SamplerCache& GetSamplerCache() { return *this->m_SamplerCache; }
+		inline ModelCache& GetModelCache() { return *this->m_ModelCache; }
+		inline ResidencyManager& GetResidencyManager() { return *this->m_ResidencyManager; }
+		inline GpuAllocator& GetGpuAllocator() { return *this->m_GpuAllocator; }
+
+		// descriptor indexing features needed for BindlessTable were found and enabled
+		inline bool SupportsBindless() const { return this->m_SupportsBindless; }
+		inline const VkPhysicalDeviceDescriptorIndexingProperties& GetDescriptorIndexingProperties() const { return this->m_DescriptorIndexingProperties; }
+		// BC1 - BC7 can be sampled, Texture refuses block compressed data otherwise
+		inline bool SupportsTextureCompressionBC() const { return this->m_SupportsTextureCompressionBC; }
+		// extended dynamic state extensions that were found and enabled, used by Pipeline::MakeRenderStateDynamic
+		inline const ExtendedDynamicStateSupport& GetExtendedDynamicStateSupport() const { return this->m_ExtendedDynamicStateSupport; }
+		inline const DynamicStateCommands& GetDynamicStateCommands() const { return this->m_DynamicStateCommands; }
+		// VK_EXT_memory_budget was found and enabled, QueryMemoryBudget falls back to a share of the heap sizes otherwise
+		inline bool SupportsMemoryBudget() const { return this->m_SupportsMemoryBudget; }
 
 		inline SwapChainSupportDetails GetSwapChainSupport() { return this->QuerySwapChainSupport(this->m_PhysicalDevice); }
 		inline QueueFamilyIndices FindPhysicalQueueFamilies() { return this->FindQueueFamilies(this->m_PhysicalDevice); }
 
 
+		void WaitIdle();
+
 		uint32_t FindMemoryType(uint32_t, VkMemoryPropertyFlags);
+		// the driver's numbers change with other processes' usage, so this is worth calling every frame
+		MemoryBudget QueryMemoryBudget();
 		VkFormat FindSupportedFormat(const std::vector<VkFormat>&, VkImageTiling, VkFormatFeatureFlags);
+		VkFormatFeatureFlags GetOptimalTilingFeatures(VkFormat);
 
 		// Buffer Helper Functions
 		void CreateBuffer(VkDeviceSize, VkBufferUsageFlags, VkMemoryPropertyFlags, VkBuffer&, VkDeviceMemory&);
 		VkCommandBuffer BeginSingleTimeCommands();
 		void EndSingleTimeCommands(VkCommandBuffer);
+		uint64_t EndSingleTimeCommandsDeferred(VkCommandBuffer);
 		void CopyBuffer(VkBuffer, VkBuffer, VkDeviceSize);
 		void CopyBufferToImage(VkBuffer, VkImage, uint32_t, uint32_t, uint32_t);
 
@@ -67,6 +118,10 @@ namespace Engine {
 		void PickPhysicalDevice();
 		void CreateLogicalDevice();
 		void CreateCommandPool();
+		void CreatePipelineCache();
+		void QueryDescriptorIndexingSupport();
+		void QueryExtendedDynamicStateSupport();
+		void QueryMemoryBudgetSupport();
 
 		// helper functions
 		bool IsDeviceSuitable(VkPhysicalDevice);
@@ -83,12 +138,34 @@ namespace Engine {
 		VkPhysicalDevice m_PhysicalDevice = VK_NULL_HANDLE;
 		Window& m_Window;
 		VkCommandPool m_CommandPool;
+		VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
 
 		VkDevice m_Device;
 		VkSurfaceKHR m_Surface;
 		VkQueue m_GraphicsQueue;
 		VkQueue m_PresentQueue;
 
+		std::mutex m_QueueMutex;
+		std::unique_ptr<FrameTimeline> m_FrameTimeline;
+		std::unique_ptr<GpuAllocator> m_GpuAllocator;
+		std::unique_ptr<DescriptorLayoutCache> m_DescriptorLayoutCache;
+		std::unique_ptr<PipelineLayoutCache> m_PipelineLayoutCache;
+		std::unique_ptr<ShaderRegistry> m_ShaderRegistry;
+		std::unique_ptr<PipelineRegistry> m_PipelineRegistry;
+		std::unique_ptr<SamplerCache> m_SamplerCache;
+		std::unique_ptr<ModelCache> m_ModelCache;
+		std::unique_ptr<ResidencyManager> m_ResidencyManager;
+
+		bool m_SupportsBindless = false;
+		bool m_SupportsTextureCompressionBC = false;
+		bool m_SupportsMemoryBudget = false;
+		VkPhysicalDeviceDescriptorIndexingProperties m_DescriptorIndexingProperties = {};
+
+		ExtendedDynamicStateSupport m_ExtendedDynamicStateSupport;
+		DynamicStateCommands m_DynamicStateCommands;
+		// required extensions plus the optional ones the device turned out to support
+		std::vector<const char*> m_EnabledExtensions;
+
 		const std::vector<const char*> m_ValidationLayers = { "VK_LAYER_KHRONOS_validation" };
 		const std::vector<const char*> m_DeviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 	};
@@ -0,0 +1,115 @@
+#include "./DynamicModel.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace Engine {
+	DynamicModel::DynamicModel(Device& device, const std::vector<Vertex>& vertices, uint32_t capacity)
+		: m_Device{ device },
+		m_VertexCount{ static_cast<uint32_t>(vertices.size()) },
+		m_Capacity{ std::max(capacity, static_cast<uint32_t>(vertices.size())) },
+		m_Vertices{ vertices } {
+		assert(this->m_Capacity > 0 && "Dynamic model needs room for at least one vertex");
+
+		this->m_Vertices.resize(this->m_Capacity);
+		this->CreateVertexBuffer();
+		this->MarkDirty(0, this->m_VertexCount);
+	}
+
+	DynamicModel::~DynamicModel() {
+		// frames in flight may still read any of the copies
+		VkDevice device = this->m_Device.GetDevice();
+		VkBuffer vertexBuffer = this->m_VertexBuffer;
+		VkDeviceMemory vertexBufferMemory = this->m_VertexBufferMemory;
+
+		this->m_Device.GetFrameTimeline().DeferDestroy([device, vertexBuffer, vertexBufferMemory]() {
+			vkUnmapMemory(device, vertexBufferMemory);
+			vkDestroyBuffer(device, vertexBuffer, nullptr);
+			vkFreeMemory(device, vertexBufferMemory, nullptr);
+		});
+	}
+
+	void DynamicModel::Update(uint32_t firstVertex, const Vertex* vertices, uint32_t count) {
+		std::memcpy(this->Edit(firstVertex, count), vertices, sizeof(Vertex) * count);
+	}
+
+	DynamicModel::Vertex* DynamicModel::Edit(uint32_t firstVertex, uint32_t count) {
+		assert(firstVertex + count <= this->m_VertexCount && "Dynamic model update out of range");
+		this->MarkDirty(firstVertex, firstVertex + count);
+		return this->m_Vertices.data() + firstVertex;
+	}
+
+	void DynamicModel::Resize(uint32_t vertexCount) {
+		assert(vertexCount <= this->m_Capacity && "Dynamic model can't grow past its capacity");
+		// vertices that come into range are uploaded with whatever the CPU copy holds
+		if (vertexCount > this->m_VertexCount) {
+			this->MarkDirty(this->m_VertexCount, vertexCount);
+		}
+		// the vertex count is recorded by Draw
+		if (vertexCount != this->m_VertexCount) this->m_Version = Model::NextVersion();
+		this->m_VertexCount = vertexCount;
+	}
+
+	void DynamicModel::Flush(int frameIndex) {
+		Vertex* frameCopy = this->m_Mapped + static_cast<VkDeviceSize>(this->m_Capacity) * frameIndex;
+
+		auto& dirtyRanges = this->m_DirtyRanges[frameIndex];
+		for (const auto& range : dirtyRanges) {
+			const size_t size = sizeof(Vertex) * (range.End - range.Begin);
+			std::memcpy(frameCopy + range.Begin, this->m_Vertices.data() + range.Begin, size);
+			this->m_UploadedBytes += size;
+		}
+		dirtyRanges.clear();
+	}
+
+	void DynamicModel::Bind(VkCommandBuffer commandBuffer, int frameIndex) {
+		const VkDeviceSize frameOffset = static_cast<VkDeviceSize>(this->m_Capacity) * frameIndex;
+		VkBuffer vertexBuffers[] = { this->m_VertexBuffer };
+		VkDeviceSize offsets[] = { sizeof(Vertex) * frameOffset };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+	}
+
+	void DynamicModel::Draw(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance) {
+		vkCmdDraw(commandBuffer, this->m_VertexCount, instanceCount, 0, firstInstance);
+	}
+
+	void DynamicModel::CreateVertexBuffer() {
+		VkDeviceSize bufferSize = sizeof(Vertex) * static_cast<VkDeviceSize>(this->m_Capacity) * SwapChain::MAX_FRAMES_IN_FLIGHT;
+		this->m_Device.CreateBuffer(bufferSize,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			this->m_VertexBuffer,
+			this->m_VertexBufferMemory);
+
+		void* data;
+		vkMapMemory(this->m_Device.GetDevice(), this->m_VertexBufferMemory, 0, bufferSize, 0, &data);
+		this->m_Mapped = static_cast<Vertex*>(data);
+	}
+
+	void DynamicModel::MarkDirty(uint32_t begin, uint32_t end) {
+		if (begin >= end) return;
+
+		// every frame copy is behind by the same change, each keeps its own sorted, disjoint list
+		for (auto& dirtyRanges : this->m_DirtyRanges) {
+			auto first = std::lower_bound(dirtyRanges.begin(), dirtyRanges.end(), begin,
+				[](const DirtyRange& range, uint32_t value) { return range.End < value; });
+			auto last = first;
+			DirtyRange merged{ begin, end };
+			// touching ranges merge as well
+			while (last != dirtyRanges.end() && last->Begin <= end) {
+				merged.Begin = std::min(merged.Begin, last->Begin);
+				merged.End = std::max(merged.End, last->End);
+				++last;
+			}
+			first = dirtyRanges.erase(first, last);
+			dirtyRanges.insert(first, merged);
+
+			if (dirtyRanges.size() > MAX_DIRTY_RANGES) {
+				DirtyRange bounds{ dirtyRanges.front().Begin, dirtyRanges.back().End };
+				dirtyRanges.assign(1, bounds);
+			}
+		}
+	}
+}
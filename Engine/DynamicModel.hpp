@@ -0,0 +1,74 @@
+#pragma once
+
+#include "./Model.hpp"
+#include "./SwapChain.hpp"
+#include "Utils/NonCopyable.hpp"
+#include "Utils/NonMoveable.hpp"
+
+// std lib headers
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+	// Model whose vertices can change every frame. Each frame in flight draws from its own copy inside one
+	// persistently mapped buffer, so a write never touches memory the GPU may still read. Updates land in a
+	// CPU side copy first, every frame copy then catches up on just the ranges that changed since its last Flush.
+	// Bind records nothing but the frame copy's offset, so cached command buffers stay valid across updates.
+	class DynamicModel : public NonCopyable, public NonMoveable {
+	public:
+		using Vertex = Model::Vertex;
+
+		// the capacity bounds how far the vertex count can later grow, 0 means exactly the initial vertices
+		DynamicModel(Device&, const std::vector<Vertex>&, uint32_t = 0);
+		~DynamicModel();
+
+		void Update(uint32_t, const Vertex*, uint32_t);
+		inline void Update(uint32_t firstVertex, const std::vector<Vertex>& vertices) {
+			this->Update(firstVertex, vertices.data(), static_cast<uint32_t>(vertices.size()));
+		}
+		// marks the range dirty and returns it for writing in place, valid until the next resize
+		Vertex* Edit(uint32_t, uint32_t);
+		void Resize(uint32_t);
+
+		// uploads the frame slot's pending ranges, once per frame before recording (or replaying) its draws. The
+		// slot's last frame must have completed
+		void Flush(int);
+		void Bind(VkCommandBuffer, int);
+		void Draw(VkCommandBuffer, uint32_t = 1, uint32_t = 0);
+
+		inline uint32_t GetVertexCount() const { return this->m_VertexCount; }
+		inline uint32_t GetCapacity() const { return this->m_Capacity; }
+		inline const std::vector<Vertex>& GetVertices() const { return this->m_Vertices; }
+		// changes whenever Draw would record something else, vertex updates reach the frame copies through Flush
+		// and leave it alone. Unique across models like Model::GetVersion
+		inline uint64_t GetVersion() const { return this->m_Version; }
+		// bytes copied into frame copies so far, full rebuilds would be capacity * frames per change
+		inline uint64_t GetUploadedBytes() const { return this->m_UploadedBytes; }
+
+	private:
+		// half open vertex range
+		struct DirtyRange {
+			uint32_t Begin;
+			uint32_t End;
+		};
+
+		// past this many disjoint ranges a frame copy just takes their union, one memcpy beats many tiny ones
+		static constexpr size_t MAX_DIRTY_RANGES = 16;
+
+		void CreateVertexBuffer();
+		void MarkDirty(uint32_t, uint32_t);
+
+		Device& m_Device;
+		VkBuffer m_VertexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_VertexBufferMemory = VK_NULL_HANDLE;
+		Vertex* m_Mapped = nullptr;
+
+		uint32_t m_VertexCount;
+		uint32_t m_Capacity;
+		std::vector<Vertex> m_Vertices;
+		std::array<std::vector<DirtyRange>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_DirtyRanges;
+		uint64_t m_UploadedBytes = 0;
+		uint64_t m_Version = Model::NextVersion();
+	};
+}
@@ -0,0 +1,63 @@
+#include "./DynamicState.hpp"
+
+// std lib headers
+#include <cassert>
+#include <stdexcept>
+
+namespace Engine {
+	template<typename Function>
+	static void LoadFunction(VkDevice device, const char* name, Function& function) {
+		function = reinterpret_cast<Function>(vkGetDeviceProcAddr(device, name));
+		if (function == nullptr) {
+			throw std::runtime_error("failed to load extended dynamic state function!");
+		}
+	}
+
+	void DynamicStateCommands::Load(VkDevice device, const ExtendedDynamicStateSupport& support) {
+		if (support.State) {
+			LoadFunction(device, "vkCmdSetCullModeEXT", this->m_SetCullMode);
+			LoadFunction(device, "vkCmdSetFrontFaceEXT", this->m_SetFrontFace);
+			LoadFunction(device, "vkCmdSetPrimitiveTopologyEXT", this->m_SetPrimitiveTopology);
+			LoadFunction(device, "vkCmdSetDepthTestEnableEXT", this->m_SetDepthTestEnable);
+			LoadFunction(device, "vkCmdSetDepthWriteEnableEXT", this->m_SetDepthWriteEnable);
+			LoadFunction(device, "vkCmdSetDepthCompareOpEXT", this->m_SetDepthCompareOp);
+		}
+
+		if (support.State2) {
+			LoadFunction(device, "vkCmdSetDepthBiasEnableEXT", this->m_SetDepthBiasEnable);
+			LoadFunction(device, "vkCmdSetPrimitiveRestartEnableEXT", this->m_SetPrimitiveRestartEnable);
+		}
+
+		if (support.ColorBlend) {
+			LoadFunction(device, "vkCmdSetColorBlendEnableEXT", this->m_SetColorBlendEnable);
+			LoadFunction(device, "vkCmdSetColorBlendEquationEXT", this->m_SetColorBlendEquation);
+			LoadFunction(device, "vkCmdSetColorWriteMaskEXT", this->m_SetColorWriteMask);
+		}
+	}
+
+	void DynamicStateCommands::Apply(VkCommandBuffer commandBuffer, const RenderState& state) const {
+		if (state.Dynamic.State) {
+			assert(this->m_SetCullMode != nullptr && "Extended dynamic state used but not loaded");
+			this->m_SetCullMode(commandBuffer, state.CullMode);
+			this->m_SetFrontFace(commandBuffer, state.FrontFace);
+			this->m_SetPrimitiveTopology(commandBuffer, state.Topology);
+			this->m_SetDepthTestEnable(commandBuffer, state.DepthTestEnable);
+			this->m_SetDepthWriteEnable(commandBuffer, state.DepthWriteEnable);
+			this->m_SetDepthCompareOp(commandBuffer, state.DepthCompareOp);
+		}
+
+		if (state.Dynamic.State2) {
+			assert(this->m_SetDepthBiasEnable != nullptr && "Extended dynamic state 2 used but not loaded");
+			this->m_SetDepthBiasEnable(commandBuffer, state.DepthBiasEnable);
+			this->m_SetPrimitiveRestartEnable(commandBuffer, state.PrimitiveRestartEnable);
+		}
+
+		if (state.Dynamic.ColorBlend) {
+			assert(this->m_SetColorBlendEnable != nullptr && "Extended dynamic state 3 used but not loaded");
+			// pipelines in this engine render to a single color attachment
+			this->m_SetColorBlendEnable(commandBuffer, 0, 1, &state.BlendEnable);
+			this->m_SetColorBlendEquation(commandBuffer, 0, 1, &state.BlendEquation);
+			this->m_SetColorWriteMask(commandBuffer, 0, 1, &state.ColorWriteMask);
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace Engine {
+	// which VK_EXT_extended_dynamic_state extensions the device exposes and had enabled
+	struct ExtendedDynamicStateSupport {
+		// cull mode, front face, topology, depth test / write / compare
+		bool State = false;
+		// depth bias enable, primitive restart
+		bool State2 = false;
+		// blend enable, blend equation and color write mask
+		bool ColorBlend = false;
+		// topology may change class (points, lines, triangles) without a new pipeline
+		bool UnrestrictedTopology = false;
+	};
+
+	// The state a pipeline would otherwise bake in. When the matching group is dynamic it has to be set
+	// on the command buffer after binding, everything else is only a record of what the pipeline holds.
+	struct RenderState {
+		VkCullModeFlags CullMode = VK_CULL_MODE_NONE;
+		VkFrontFace FrontFace = VK_FRONT_FACE_CLOCKWISE;
+		VkPrimitiveTopology Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		VkBool32 DepthTestEnable = VK_TRUE;
+		VkBool32 DepthWriteEnable = VK_TRUE;
+		VkCompareOp DepthCompareOp = VK_COMPARE_OP_LESS;
+
+		VkBool32 DepthBiasEnable = VK_FALSE;
+		VkBool32 PrimitiveRestartEnable = VK_FALSE;
+
+		VkBool32 BlendEnable = VK_FALSE;
+		VkColorBlendEquationEXT BlendEquation = {
+			VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD,
+			VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD };
+		VkColorComponentFlags ColorWriteMask =
+			VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+		// the groups the pipeline left dynamic, all false when the device has no support
+		ExtendedDynamicStateSupport Dynamic;
+	};
+
+	// Records the extended dynamic state, the entry points come from the device since they are extension functions.
+	class DynamicStateCommands {
+	public:
+		void Load(VkDevice, const ExtendedDynamicStateSupport&);
+
+		// sets every group the state marks dynamic, a no-op for pipelines that bake everything
+		void Apply(VkCommandBuffer, const RenderState&) const;
+
+	private:
+		PFN_vkCmdSetCullModeEXT m_SetCullMode = nullptr;
+		PFN_vkCmdSetFrontFaceEXT m_SetFrontFace = nullptr;
+		PFN_vkCmdSetPrimitiveTopologyEXT m_SetPrimitiveTopology = nullptr;
+		PFN_vkCmdSetDepthTestEnableEXT m_SetDepthTestEnable = nullptr;
+		PFN_vkCmdSetDepthWriteEnableEXT m_SetDepthWriteEnable = nullptr;
+		PFN_vkCmdSetDepthCompareOpEXT m_SetDepthCompareOp = nullptr;
+
+		PFN_vkCmdSetDepthBiasEnableEXT m_SetDepthBiasEnable = nullptr;
+		PFN_vkCmdSetPrimitiveRestartEnableEXT m_SetPrimitiveRestartEnable = nullptr;
+
+		PFN_vkCmdSetColorBlendEnableEXT m_SetColorBlendEnable = nullptr;
+		PFN_vkCmdSetColorBlendEquationEXT m_SetColorBlendEquation = nullptr;
+		PFN_vkCmdSetColorWriteMaskEXT m_SetColorWriteMask = nullptr;
+	};
+}
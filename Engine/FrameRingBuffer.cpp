@@ -0,0 +1,125 @@
+#include "./FrameRingBuffer.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+namespace Engine {
+	FrameRingBuffer::FrameRingBuffer(Device& device, VkDeviceSize frameSize, VkDeviceSize uniformRange, VkDeviceSize storageRange)
+		: m_Device{ device }, m_DescriptorAllocator{ device.GetDevice(), 1 }, m_FrameSize{ frameSize } {
+		const auto& limits = this->m_Device.properties.limits;
+
+		this->m_UniformRange = std::min({ uniformRange, frameSize, static_cast<VkDeviceSize>(limits.maxUniformBufferRange) });
+		this->m_StorageRange = std::min({ storageRange, frameSize, static_cast<VkDeviceSize>(limits.maxStorageBufferRange) });
+		this->m_UniformAlignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 16);
+		this->m_StorageAlignment = std::max<VkDeviceSize>(limits.minStorageBufferOffsetAlignment, 16);
+
+		this->CreateBuffer();
+		this->CreateDescriptorSet();
+	}
+
+	FrameRingBuffer::~FrameRingBuffer() {
+		// the layout is owned by the device's layout cache, the set goes with the allocator's pool
+		vkUnmapMemory(this->m_Device.GetDevice(), this->m_BufferMemory);
+		vkDestroyBuffer(this->m_Device.GetDevice(), this->m_Buffer, nullptr);
+		vkFreeMemory(this->m_Device.GetDevice(), this->m_BufferMemory, nullptr);
+	}
+
+	void FrameRingBuffer::BeginFrame(int frameIndex) {
+		this->m_FrameBegin = this->m_FrameSize * frameIndex;
+		this->m_Head = this->m_FrameBegin;
+	}
+
+	FrameRingBuffer::Allocation FrameRingBuffer::AllocateUniform(VkDeviceSize size) {
+		return this->Allocate(size, this->m_UniformAlignment, this->m_UniformRange);
+	}
+
+	FrameRingBuffer::Allocation FrameRingBuffer::AllocateStorage(VkDeviceSize size) {
+		return this->Allocate(size, this->m_StorageAlignment, this->m_StorageRange);
+	}
+
+	FrameRingBuffer::Allocation FrameRingBuffer::Allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize range) {
+		if (size > range) {
+			throw std::runtime_error("failed to allocate frame ring block larger than its binding's range!");
+		}
+
+		VkDeviceSize offset = (this->m_Head + alignment - 1) / alignment * alignment;
+		if (offset + size > this->m_FrameBegin + this->m_FrameSize) {
+			throw std::runtime_error("failed to allocate frame ring block, the frame is out of space!");
+		}
+		this->m_Head = offset + size;
+
+		Allocation allocation{};
+		allocation.Data = this->m_Mapped + offset;
+		allocation.Offset = static_cast<uint32_t>(offset);
+		allocation.Size = size;
+		return allocation;
+	}
+
+	void FrameRingBuffer::Bind(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, uint32_t set, uint32_t uniformOffset, uint32_t storageOffset) {
+		std::array<uint32_t, 2> dynamicOffsets = { uniformOffset, storageOffset };
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			pipelineLayout,
+			set,
+			1,
+			&this->m_DescriptorSet,
+			static_cast<uint32_t>(dynamicOffsets.size()),
+			dynamicOffsets.data());
+	}
+
+	void FrameRingBuffer::CreateBuffer() {
+		// trailing binding range keeps offset + range inside the buffer for blocks at the end of the last frame
+		VkDeviceSize bufferSize = this->m_FrameSize * SwapChain::MAX_FRAMES_IN_FLIGHT + std::max(this->m_UniformRange, this->m_StorageRange);
+
+		this->m_Device.CreateBuffer(
+			bufferSize,
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			this->m_Buffer,
+			this->m_BufferMemory);
+
+		void* data;
+		if (vkMapMemory(this->m_Device.GetDevice(), this->m_BufferMemory, 0, bufferSize, 0, &data) != VK_SUCCESS) {
+			throw std::runtime_error("failed to map frame ring buffer!");
+		}
+		this->m_Mapped = static_cast<char*>(data);
+	}
+
+	void FrameRingBuffer::CreateDescriptorSet() {
+		std::vector<VkDescriptorSetLayoutBinding> bindings(2);
+		bindings[0].binding = 0;
+		bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		bindings[0].descriptorCount = 1;
+		bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		bindings[1].binding = 1;
+		bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+		bindings[1].descriptorCount = 1;
+		bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		this->m_DescriptorSetLayout = this->m_Device.GetDescriptorLayoutCache().GetLayout(bindings);
+
+		this->m_DescriptorSet = this->m_DescriptorAllocator.Allocate(this->m_DescriptorSetLayout);
+
+		// the set never changes, only the dynamic offsets passed at bind time do
+		std::array<VkDescriptorBufferInfo, 2> bufferInfos{};
+		bufferInfos[0] = { this->m_Buffer, 0, this->m_UniformRange };
+		bufferInfos[1] = { this->m_Buffer, 0, this->m_StorageRange };
+
+		std::array<VkWriteDescriptorSet, 2> writes{};
+		for (uint32_t i = 0; i < writes.size(); i++) {
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].dstSet = this->m_DescriptorSet;
+			writes[i].dstBinding = i;
+			writes[i].descriptorCount = 1;
+			writes[i].descriptorType = bindings[i].descriptorType;
+			writes[i].pBufferInfo = &bufferInfos[i];
+		}
+
+		vkUpdateDescriptorSets(this->m_Device.GetDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+	}
+}
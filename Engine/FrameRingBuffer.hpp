@@ -0,0 +1,82 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./Descriptors.hpp"
+#include "./SwapChain.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <cstdint>
+
+namespace Engine {
+
+	// Persistently mapped buffer split into one region per frame in flight. Systems carve aligned blocks out of
+	// the current frame's region and bind them through a single descriptor set with dynamic offsets:
+	//   binding 0 - uniform buffer (dynamic), for per pass data such as cameras
+	//   binding 1 - storage buffer (dynamic), for per draw / per instance arrays
+	class FrameRingBuffer : public NonMoveable, public NonCopyable {
+	public:
+		static constexpr VkDeviceSize DEFAULT_FRAME_SIZE = 4 * 1024 * 1024;
+		// bytes each binding can see past its dynamic offset, also the largest block it hands out. Both are clamped
+		// to the frame size and the device's uniform / storage range limits
+		static constexpr VkDeviceSize DEFAULT_UNIFORM_RANGE = 64 * 1024;
+		static constexpr VkDeviceSize DEFAULT_STORAGE_RANGE = 1024 * 1024;
+
+		struct Allocation {
+			void* Data = nullptr;
+			uint32_t Offset = 0;
+			VkDeviceSize Size = 0;
+		};
+
+		FrameRingBuffer(Device&, VkDeviceSize = DEFAULT_FRAME_SIZE, VkDeviceSize = DEFAULT_UNIFORM_RANGE, VkDeviceSize = DEFAULT_STORAGE_RANGE);
+		~FrameRingBuffer();
+
+		// called once the frame slot's previous use has completed on the GPU
+		void BeginFrame(int);
+
+		Allocation AllocateUniform(VkDeviceSize);
+		Allocation AllocateStorage(VkDeviceSize);
+
+		template<typename T>
+		inline Allocation WriteUniform(const T& value) {
+			Allocation allocation = this->AllocateUniform(sizeof(T));
+			*static_cast<T*>(allocation.Data) = value;
+			return allocation;
+		}
+
+		void Bind(VkCommandBuffer, VkPipelineLayout, uint32_t, uint32_t, uint32_t);
+
+		inline VkDescriptorSetLayout GetDescriptorSetLayout() const { return this->m_DescriptorSetLayout; }
+		inline VkDeviceSize GetUniformRange() const { return this->m_UniformRange; }
+		inline VkDeviceSize GetStorageRange() const { return this->m_StorageRange; }
+		inline VkDeviceSize GetFrameUsage() const { return this->m_Head - this->m_FrameBegin; }
+
+	private:
+		Allocation Allocate(VkDeviceSize, VkDeviceSize, VkDeviceSize);
+
+		void CreateBuffer();
+		void CreateDescriptorSet();
+
+		Device& m_Device;
+		// holds the one set, it never changes after creation
+		DescriptorAllocator m_DescriptorAllocator;
+
+		VkDeviceSize m_FrameSize;
+		VkDeviceSize m_UniformRange;
+		VkDeviceSize m_StorageRange;
+		VkDeviceSize m_UniformAlignment;
+		VkDeviceSize m_StorageAlignment;
+
+		VkBuffer m_Buffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_BufferMemory = VK_NULL_HANDLE;
+		char* m_Mapped = nullptr;
+
+		VkDeviceSize m_FrameBegin = 0;
+		VkDeviceSize m_Head = 0;
+
+		VkDescriptorSetLayout m_DescriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+	};
+}
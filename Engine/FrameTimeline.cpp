@@ -0,0 +1,79 @@
+#include "./FrameTimeline.hpp"
+
+// std lib headers
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+namespace Engine {
+	FrameTimeline::FrameTimeline(VkDevice device) : m_Device{ device } {
+		VkSemaphoreTypeCreateInfo typeInfo{};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo{};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+
+		if (vkCreateSemaphore(this->m_Device, &semaphoreInfo, nullptr, &this->m_Semaphore) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create frame timeline semaphore!");
+		}
+	}
+
+	FrameTimeline::~FrameTimeline() {
+		// the owner guarantees the device is idle, so every pending callback is safe to run now
+		this->m_Callbacks.Collect(std::numeric_limits<uint64_t>::max());
+
+		vkDestroySemaphore(this->m_Device, this->m_Semaphore, nullptr);
+	}
+
+	uint64_t FrameTimeline::NextValue() {
+		return ++this->m_SubmittedValue;
+	}
+
+	uint64_t FrameTimeline::GetCompletedValue() {
+		uint64_t value = 0;
+		if (vkGetSemaphoreCounterValue(this->m_Device, this->m_Semaphore, &value) != VK_SUCCESS) {
+			throw std::runtime_error("failed to query frame timeline value!");
+		}
+		this->m_CompletedValue = value;
+		return value;
+	}
+
+	bool FrameTimeline::IsComplete(uint64_t value) {
+		// avoid the driver round trip when the cached value already answers the question
+		if (value <= this->m_CompletedValue) return true;
+		return value <= this->GetCompletedValue();
+	}
+
+	void FrameTimeline::Wait(uint64_t value) {
+		assert(value <= this->GetPendingValue() && "Cannot wait on a frame that has not been recorded yet");
+		if (this->IsComplete(value)) return;
+
+		VkSemaphoreWaitInfo waitInfo{};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &this->m_Semaphore;
+		waitInfo.pValues = &value;
+
+		if (vkWaitSemaphores(this->m_Device, &waitInfo, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS) {
+			throw std::runtime_error("failed to wait on frame timeline!");
+		}
+		uint64_t completed = this->m_CompletedValue.load();
+		while (completed < value && !this->m_CompletedValue.compare_exchange_weak(completed, value)) {}
+	}
+
+	void FrameTimeline::OnComplete(uint64_t value, Callback callback) {
+		if (value <= this->m_CompletedValue) {
+			callback();
+			return;
+		}
+
+		this->m_Callbacks.Queue(value, std::move(callback));
+	}
+
+	void FrameTimeline::Collect() {
+		this->m_Callbacks.Collect(this->GetCompletedValue());
+	}
+}
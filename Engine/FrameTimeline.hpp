@@ -0,0 +1,55 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "./Utils/CallbackQueue.hpp"
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <atomic>
+#include <cstdint>
+
+namespace Engine {
+
+	// Single timeline semaphore counting submitted frames.
+	// Value N is signaled once frame N (and everything submitted before it on the graphics queue) has completed,
+	// so any subsystem can wait on, or schedule work after, "frame N complete".
+	class FrameTimeline : public NonMoveable, public NonCopyable {
+	public:
+		using Callback = CallbackQueue::Callback;
+
+		FrameTimeline(VkDevice);
+		~FrameTimeline();
+
+		inline VkSemaphore GetSemaphore() const { return this->m_Semaphore; }
+
+		// value signaled by the most recently submitted frame
+		inline uint64_t GetSubmittedValue() const { return this->m_SubmittedValue; }
+		// value the frame currently being recorded will signal
+		inline uint64_t GetPendingValue() const { return this->m_SubmittedValue + 1; }
+
+		uint64_t NextValue();
+		uint64_t GetCompletedValue();
+		bool IsComplete(uint64_t);
+		void Wait(uint64_t);
+
+		// runs the callback once the given value has been reached, safe to call from any thread
+		void OnComplete(uint64_t, Callback);
+		// runs the callback once the frame currently being recorded has completed
+		inline void DeferDestroy(Callback destroy) { this->OnComplete(this->GetPendingValue(), std::move(destroy)); }
+
+		void Collect();
+
+	private:
+		VkDevice m_Device;
+		VkSemaphore m_Semaphore = VK_NULL_HANDLE;
+
+		// only advanced by the main thread, atomic so other threads can read the pending value
+		std::atomic<uint64_t> m_SubmittedValue{ 0 };
+		std::atomic<uint64_t> m_CompletedValue{ 0 };
+
+		CallbackQueue m_Callbacks;
+	};
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Model.hpp"
+#include "DynamicModel.hpp"
+#include "TransformHierarchy.hpp"
 
 
 // std lib headers
@@ -8,22 +10,6 @@
 
 namespace Engine {
 
-	struct Transform2DComponent {
-		glm::vec2 Translation{}; // position offset
-		glm::vec2 Scale{ 1.0f, 1.0f }; // scale
-		float Rotation; // rotation in radians
-
-		glm::mat2 GetTransformMatrix() const {
-			const float sinR = glm::sin(Rotation);
-			const float cosR = glm::cos(Rotation);
-			
-			glm::mat2 rotationMatrix{ { cosR, sinR }, { -sinR, cosR } };
-			glm::mat2 scaleMatrix{ { Scale.x, .0f }, { .0f, Scale.y } };
-
-			return rotationMatrix * scaleMatrix ;
-		}
-	};
-
 	class GameObject {
 	public:
 		using IdType = unsigned int;
@@ -36,8 +22,18 @@ namespace Engine {
 		inline IdType GetId() const { return this->m_Id; }
 
 		std::shared_ptr<Engine::Model> Model{};
+		// set instead of Model for geometry that changes at runtime, drawn on its own without levels of detail
+		std::shared_ptr<Engine::DynamicModel> DynamicModel{};
 		glm::vec3 Color{};
+		// relative to the parent node for objects in a TransformHierarchy
 		Transform2DComponent Transform{};
+		TransformHierarchy::NodeId Node = TransformHierarchy::INVALID_NODE;
+		// level of detail drawn last frame, kept so the next pick can stick with it near a threshold
+		uint32_t Lod = 0;
+		// promises the object won't move or change, StaticBatch then merges it into pre-transformed chunks
+		bool Static = false;
+		// set by StaticBatch while the object is drawn as part of a chunk rather than on its own
+		bool Baked = false;
 	private:
 		GameObject(IdType id) : m_Id{ id } {};
 		IdType m_Id;
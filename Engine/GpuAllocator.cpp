@@ -0,0 +1,429 @@
+#include "./GpuAllocator.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+namespace Engine {
+	GpuAllocator::GpuAllocator(Device& device) : m_Device{ device } {}
+
+	GpuAllocator::~GpuAllocator() {
+		assert(this->m_Allocations.empty() && "Resources still allocated from the GPU allocator");
+		for (auto& block : this->m_Blocks) {
+			vkFreeMemory(this->m_Device.GetDevice(), block->Memory, nullptr);
+		}
+	}
+
+	GpuAllocator::Allocation* GpuAllocator::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
+		auto allocation = std::make_unique<Allocation>();
+		allocation->Properties = properties;
+
+		VkBufferCreateInfo& bufferInfo = allocation->BufferInfo;
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = size;
+		bufferInfo.usage = usage;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		if (vkCreateBuffer(this->m_Device.GetDevice(), &bufferInfo, nullptr, &allocation->Buffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create buffer!");
+		}
+
+		VkMemoryRequirements memRequirements;
+		vkGetBufferMemoryRequirements(this->m_Device.GetDevice(), allocation->Buffer, &memRequirements);
+		return this->Bind(std::move(allocation), memRequirements);
+	}
+
+	GpuAllocator::Allocation* GpuAllocator::CreateImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties) {
+		assert(imageInfo.pNext == nullptr && "GPU allocator images can't have extension structs, they are created again when moved");
+
+		auto allocation = std::make_unique<Allocation>();
+		allocation->Properties = properties;
+		allocation->ImageInfo = imageInfo;
+
+		if (vkCreateImage(this->m_Device.GetDevice(), &imageInfo, nullptr, &allocation->Image) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create image!");
+		}
+
+		VkMemoryRequirements memRequirements;
+		vkGetImageMemoryRequirements(this->m_Device.GetDevice(), allocation->Image, &memRequirements);
+		return this->Bind(std::move(allocation), memRequirements);
+	}
+
+	void GpuAllocator::Destroy(Allocation* allocation) {
+		{
+			// no longer a candidate for moves, its owner is gone
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			allocation->OnMoved = nullptr;
+			allocation->Owner->Allocations.erase(allocation);
+		}
+
+		this->m_Device.GetFrameTimeline().DeferDestroy([this, allocation]() {
+			if (allocation->Buffer != VK_NULL_HANDLE) {
+				vkDestroyBuffer(this->m_Device.GetDevice(), allocation->Buffer, nullptr);
+			}
+			if (allocation->Image != VK_NULL_HANDLE) {
+				vkDestroyImage(this->m_Device.GetDevice(), allocation->Image, nullptr);
+			}
+
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			this->FreeRange(allocation->Owner, allocation->Offset, allocation->Size);
+			this->m_Allocations.erase(allocation);
+		});
+	}
+
+	uint32_t GpuAllocator::Defragment(VkDeviceSize byteBudget) {
+		auto& moved = this->m_DefragmentMoved;
+		moved.clear();
+
+		{
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			this->ReleaseEmptyBlocks();
+
+			// blocks are only ever interchangeable within the same memory type and tiling, sorted so each of those
+			// groups is one run
+			auto& blocks = this->m_DefragmentBlocks;
+			blocks.clear();
+			for (auto& block : this->m_Blocks) {
+				if (!block->Dedicated) blocks.push_back(block.get());
+			}
+			std::sort(blocks.begin(), blocks.end(), [](const Block* a, const Block* b) {
+				return a->MemoryType != b->MemoryType ? a->MemoryType < b->MemoryType : a->OptimalTiling < b->OptimalTiling;
+			});
+
+			VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+			VkDeviceSize movedBytes = 0;
+
+			auto next = blocks.begin();
+			while (next != blocks.end()) {
+				const auto first = next;
+				const auto last = std::find_if(first, blocks.end(), [&](const Block* block) {
+					return block->MemoryType != (*first)->MemoryType || block->OptimalTiling != (*first)->OptimalTiling;
+				});
+				next = last;
+				if (last - first < 2) continue;
+
+				// the emptiest block that could actually end up empty, one unmovable resource keeps it alive for good
+				Block* source = nullptr;
+				for (auto block = first; block != last; ++block) {
+					if ((*block)->Allocations.empty()) continue;
+					const bool movable = std::all_of((*block)->Allocations.begin(), (*block)->Allocations.end(),
+						[](const Allocation* allocation) { return IsMovable(*allocation); });
+					if (movable && (source == nullptr || (*block)->Used < source->Used)) source = *block;
+				}
+				if (source == nullptr) continue;
+
+				// only worth it when the others have room for everything it holds
+				VkDeviceSize freeElsewhere = 0;
+				for (auto block = first; block != last; ++block) {
+					if (*block != source) freeElsewhere += (*block)->Size - (*block)->Used;
+				}
+				if (freeElsewhere < source->Used) continue;
+
+				// fullest first, so moves also drain the next emptiest block rather than refill it
+				auto& targets = this->m_DefragmentTargets;
+				targets.clear();
+				for (auto block = first; block != last; ++block) {
+					if (*block != source) targets.push_back(*block);
+				}
+				std::sort(targets.begin(), targets.end(), [](const Block* a, const Block* b) { return a->Used > b->Used; });
+
+				auto& candidates = this->m_DefragmentCandidates;
+				candidates.assign(source->Allocations.begin(), source->Allocations.end());
+				for (Allocation* allocation : candidates) {
+					if (movedBytes + allocation->Size > byteBudget) continue;
+
+					if (commandBuffer == VK_NULL_HANDLE) commandBuffer = this->m_Device.BeginSingleTimeCommands();
+					if (!this->RecordMove(commandBuffer, *allocation, targets)) break;
+
+					movedBytes += allocation->Size;
+					moved.push_back(allocation);
+				}
+			}
+
+			if (commandBuffer != VK_NULL_HANDLE) {
+				this->m_Device.EndSingleTimeCommandsDeferred(commandBuffer);
+			}
+			this->m_Moves += moved.size();
+			this->m_MovedBytes += movedBytes;
+		}
+
+		// owners patch their handles unlocked, they may well create views or queue destructions
+		for (Allocation* allocation : moved) {
+			allocation->OnMoved();
+		}
+		return static_cast<uint32_t>(moved.size());
+	}
+
+	GpuAllocator::Stats GpuAllocator::GetStats() {
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+
+		Stats stats{};
+		stats.BlockCount = static_cast<uint32_t>(this->m_Blocks.size());
+		stats.AllocationCount = static_cast<uint32_t>(this->m_Allocations.size());
+		for (const auto& block : this->m_Blocks) {
+			stats.BlockBytes += block->Size;
+			stats.UsedBytes += block->Used;
+		}
+		stats.Moves = this->m_Moves;
+		stats.MovedBytes = this->m_MovedBytes;
+		stats.FreedBlocks = this->m_FreedBlocks;
+		return stats;
+	}
+
+	GpuAllocator::Allocation* GpuAllocator::Bind(std::unique_ptr<Allocation> allocation, const VkMemoryRequirements& memRequirements) {
+		const uint32_t memoryType = this->m_Device.FindMemoryType(memRequirements.memoryTypeBits, allocation->Properties);
+		const bool optimalTiling = allocation->Image != VK_NULL_HANDLE && allocation->ImageInfo.tiling == VK_IMAGE_TILING_OPTIMAL;
+
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+
+		Block* block = nullptr;
+		VkDeviceSize offset = 0;
+		if (memRequirements.size <= MAX_SUBALLOCATION_SIZE) {
+			for (auto& candidate : this->m_Blocks) {
+				if (candidate->Dedicated || candidate->MemoryType != memoryType || candidate->OptimalTiling != optimalTiling) continue;
+				if (this->AllocateFrom(*candidate, memRequirements, offset)) {
+					block = candidate.get();
+					break;
+				}
+			}
+		}
+		if (block == nullptr) {
+			const bool dedicated = memRequirements.size > MAX_SUBALLOCATION_SIZE;
+			block = &this->CreateBlock(memoryType, optimalTiling, dedicated ? memRequirements.size : BLOCK_SIZE, dedicated);
+			this->AllocateFrom(*block, memRequirements, offset);
+		}
+
+		allocation->Owner = block;
+		allocation->Memory = block->Memory;
+		allocation->Offset = offset;
+		allocation->Size = memRequirements.size;
+
+		const VkResult result = allocation->Buffer != VK_NULL_HANDLE
+			? vkBindBufferMemory(this->m_Device.GetDevice(), allocation->Buffer, block->Memory, offset)
+			: vkBindImageMemory(this->m_Device.GetDevice(), allocation->Image, block->Memory, offset);
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("failed to bind device memory!");
+		}
+
+		Allocation* handle = allocation.get();
+		block->Allocations.insert(handle);
+		this->m_Allocations.emplace(handle, std::move(allocation));
+		return handle;
+	}
+
+	bool GpuAllocator::AllocateFrom(Block& block, const VkMemoryRequirements& memRequirements, VkDeviceSize& offset) {
+		// first fit, blocks hold a few hundred resources at most
+		for (auto range = block.FreeRanges.begin(); range != block.FreeRanges.end(); ++range) {
+			const VkDeviceSize rangeStart = range->first;
+			const VkDeviceSize rangeEnd = range->first + range->second;
+			const VkDeviceSize aligned = (rangeStart + memRequirements.alignment - 1) / memRequirements.alignment * memRequirements.alignment;
+			if (aligned + memRequirements.size > rangeEnd) continue;
+
+			// the alignment padding stays free, it's merged back once the neighbor goes
+			block.FreeRanges.erase(range);
+			if (aligned > rangeStart) block.FreeRanges.emplace(rangeStart, aligned - rangeStart);
+			if (aligned + memRequirements.size < rangeEnd) block.FreeRanges.emplace(aligned + memRequirements.size, rangeEnd - aligned - memRequirements.size);
+
+			block.Used += memRequirements.size;
+			offset = aligned;
+			return true;
+		}
+		return false;
+	}
+
+	GpuAllocator::Block& GpuAllocator::CreateBlock(uint32_t memoryType, bool optimalTiling, VkDeviceSize size, bool dedicated) {
+		auto block = std::make_unique<Block>();
+		block->Size = size;
+		block->MemoryType = memoryType;
+		block->OptimalTiling = optimalTiling;
+		block->Dedicated = dedicated;
+		block->FreeRanges.emplace(0, size);
+
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = size;
+		allocInfo.memoryTypeIndex = memoryType;
+
+		if (vkAllocateMemory(this->m_Device.GetDevice(), &allocInfo, nullptr, &block->Memory) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate device memory block!");
+		}
+
+		this->m_Blocks.push_back(std::move(block));
+		return *this->m_Blocks.back();
+	}
+
+	void GpuAllocator::FreeRange(Block* block, VkDeviceSize offset, VkDeviceSize size) {
+		block->Used -= size;
+
+		// dedicated blocks go right away, shared ones wait for Defragment so load / unload cycles don't churn blocks
+		if (block->Dedicated) {
+			vkFreeMemory(this->m_Device.GetDevice(), block->Memory, nullptr);
+			this->m_Blocks.erase(std::find_if(this->m_Blocks.begin(), this->m_Blocks.end(),
+				[block](const std::unique_ptr<Block>& candidate) { return candidate.get() == block; }));
+			return;
+		}
+
+		auto next = block->FreeRanges.emplace(offset, size).first;
+		if (next != block->FreeRanges.begin()) {
+			auto previous = std::prev(next);
+			if (previous->first + previous->second == offset) {
+				previous->second += next->second;
+				block->FreeRanges.erase(next);
+				next = previous;
+			}
+		}
+		auto following = std::next(next);
+		if (following != block->FreeRanges.end() && next->first + next->second == following->first) {
+			next->second += following->second;
+			block->FreeRanges.erase(following);
+		}
+	}
+
+	void GpuAllocator::ReleaseEmptyBlocks() {
+		auto empty = std::remove_if(this->m_Blocks.begin(), this->m_Blocks.end(), [this](const std::unique_ptr<Block>& block) {
+			if (block->Used > 0) return false;
+			vkFreeMemory(this->m_Device.GetDevice(), block->Memory, nullptr);
+			this->m_FreedBlocks++;
+			return true;
+		});
+		this->m_Blocks.erase(empty, this->m_Blocks.end());
+	}
+
+	bool GpuAllocator::RecordMove(VkCommandBuffer commandBuffer, Allocation& allocation, const std::vector<Block*>& targets) {
+		VkDevice device = this->m_Device.GetDevice();
+
+		// the same resource again, created from the info it was made with
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkImage image = VK_NULL_HANDLE;
+		VkMemoryRequirements memRequirements;
+		if (allocation.Buffer != VK_NULL_HANDLE) {
+			if (vkCreateBuffer(device, &allocation.BufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create buffer!");
+			}
+			vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+		}
+		else {
+			if (vkCreateImage(device, &allocation.ImageInfo, nullptr, &image) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create image!");
+			}
+			vkGetImageMemoryRequirements(device, image, &memRequirements);
+		}
+
+		Block* target = nullptr;
+		VkDeviceSize offset = 0;
+		for (Block* candidate : targets) {
+			if ((memRequirements.memoryTypeBits & (1u << candidate->MemoryType)) == 0) continue;
+			if (this->AllocateFrom(*candidate, memRequirements, offset)) {
+				target = candidate;
+				break;
+			}
+		}
+
+		if (target == nullptr) {
+			if (buffer != VK_NULL_HANDLE) vkDestroyBuffer(device, buffer, nullptr);
+			if (image != VK_NULL_HANDLE) vkDestroyImage(device, image, nullptr);
+			return false;
+		}
+
+		if (buffer != VK_NULL_HANDLE) {
+			vkBindBufferMemory(device, buffer, target->Memory, offset);
+
+			VkBufferCopy region{ 0, 0, allocation.BufferInfo.size };
+			vkCmdCopyBuffer(commandBuffer, allocation.Buffer, buffer, 1, &region);
+		}
+		else {
+			vkBindImageMemory(device, image, target->Memory, offset);
+
+			const VkImageCreateInfo& imageInfo = allocation.ImageInfo;
+			const VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, imageInfo.mipLevels, 0, imageInfo.arrayLayers };
+
+			// the old image goes back to shader read afterwards, frames recorded before the move may still sample it
+			VkImageMemoryBarrier barriers[2]{};
+			for (auto& barrier : barriers) {
+				barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.subresourceRange = range;
+			}
+			barriers[0].image = allocation.Image;
+			barriers[0].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			barriers[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			barriers[1].image = image;
+			barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barriers[1].srcAccessMask = 0;
+			barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer,
+				VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, 0, nullptr, 0, nullptr, 2, barriers);
+
+			std::vector<VkImageCopy> regions(imageInfo.mipLevels);
+			for (uint32_t level = 0; level < imageInfo.mipLevels; level++) {
+				VkImageCopy& region = regions[level];
+				region = {};
+				region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, imageInfo.arrayLayers };
+				region.dstSubresource = region.srcSubresource;
+				region.extent = {
+					std::max(imageInfo.extent.width >> level, 1u),
+					std::max(imageInfo.extent.height >> level, 1u),
+					std::max(imageInfo.extent.depth >> level, 1u) };
+			}
+			vkCmdCopyImage(commandBuffer,
+				allocation.Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				static_cast<uint32_t>(regions.size()), regions.data());
+
+			barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				0, 0, nullptr, 0, nullptr, 2, barriers);
+		}
+
+		// the old resource and its range stay until frames using them, and the copy itself, have completed
+		Block* oldBlock = allocation.Owner;
+		const VkBuffer oldBuffer = allocation.Buffer;
+		const VkImage oldImage = allocation.Image;
+		const VkDeviceSize oldOffset = allocation.Offset;
+		const VkDeviceSize oldSize = allocation.Size;
+		this->m_Device.GetFrameTimeline().DeferDestroy([this, device, oldBlock, oldBuffer, oldImage, oldOffset, oldSize]() {
+			if (oldBuffer != VK_NULL_HANDLE) vkDestroyBuffer(device, oldBuffer, nullptr);
+			if (oldImage != VK_NULL_HANDLE) vkDestroyImage(device, oldImage, nullptr);
+
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			this->FreeRange(oldBlock, oldOffset, oldSize);
+		});
+
+		oldBlock->Allocations.erase(&allocation);
+		target->Allocations.insert(&allocation);
+		allocation.Owner = target;
+		allocation.Buffer = buffer;
+		allocation.Image = image;
+		allocation.Memory = target->Memory;
+		allocation.Offset = offset;
+		allocation.Size = memRequirements.size;
+		return true;
+	}
+
+	bool GpuAllocator::IsMovable(const Allocation& allocation) {
+		if (!allocation.OnMoved) return false;
+
+		// copies read the old resource and write the new one
+		if (allocation.Buffer != VK_NULL_HANDLE) {
+			constexpr VkBufferUsageFlags transfer = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			return (allocation.BufferInfo.usage & transfer) == transfer;
+		}
+		constexpr VkImageUsageFlags transfer = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		return (allocation.ImageInfo.usage & transfer) == transfer && allocation.ImageInfo.samples == VK_SAMPLE_COUNT_1_BIT;
+	}
+}
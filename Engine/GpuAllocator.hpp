@@ -0,0 +1,119 @@
+#pragma once
+
+#include "./Device.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Engine {
+
+	// Sub-allocates buffers and images out of large device memory blocks, so models and textures don't each cost a
+	// vkAllocateMemory (drivers may allow as few as 4096 of them). Resources whose owner sets OnMoved can be moved by
+	// Defragment, which evacuates the emptiest blocks into the fuller ones a few megabytes per frame and frees the
+	// blocks it empties. Moves are GPU copies recorded like every other upload, nothing waits on them.
+	class GpuAllocator : public NonMoveable, public NonCopyable {
+	public:
+		static constexpr VkDeviceSize BLOCK_SIZE = 32ull * 1024 * 1024;
+		// anything bigger gets a block of its own and is never moved
+		static constexpr VkDeviceSize MAX_SUBALLOCATION_SIZE = BLOCK_SIZE / 2;
+		static constexpr VkDeviceSize DEFAULT_DEFRAGMENT_BYTES = 8ull * 1024 * 1024;
+
+		struct Block;
+
+		// owned by the allocator, the address stays valid until Destroy even when the resource moves
+		struct Allocation {
+			// one of the two is set
+			VkBuffer Buffer = VK_NULL_HANDLE;
+			VkImage Image = VK_NULL_HANDLE;
+			VkDeviceMemory Memory = VK_NULL_HANDLE;
+			VkDeviceSize Offset = 0;
+			VkDeviceSize Size = 0;
+
+			// set by owners that can cope with their resource being replaced, Defragment leaves the allocation alone
+			// otherwise. Called after a move with Buffer / Image already pointing at the new resource, the copy into
+			// it is ordered before any later submission. Images are expected in shader read only layout
+			std::function<void()> OnMoved;
+
+		private:
+			friend class GpuAllocator;
+
+			Block* Owner = nullptr;
+			VkMemoryPropertyFlags Properties = 0;
+			// enough to create the same resource again somewhere else
+			VkBufferCreateInfo BufferInfo = {};
+			VkImageCreateInfo ImageInfo = {};
+		};
+
+		struct Block {
+			VkDeviceMemory Memory = VK_NULL_HANDLE;
+			VkDeviceSize Size = 0;
+			// includes ranges that are only released once frames in flight complete
+			VkDeviceSize Used = 0;
+			uint32_t MemoryType = 0;
+			// buffers and optimal tiling images never share a block, so buffer image granularity never matters
+			bool OptimalTiling = false;
+			bool Dedicated = false;
+			// offset to size, neighbors are merged when ranges are freed
+			std::map<VkDeviceSize, VkDeviceSize> FreeRanges;
+			std::unordered_set<Allocation*> Allocations;
+		};
+
+		struct Stats {
+			uint32_t BlockCount = 0;
+			uint32_t AllocationCount = 0;
+			VkDeviceSize BlockBytes = 0;
+			VkDeviceSize UsedBytes = 0;
+			// totals over every Defragment call
+			uint64_t Moves = 0;
+			uint64_t MovedBytes = 0;
+			uint64_t FreedBlocks = 0;
+		};
+
+		GpuAllocator(Device&);
+		~GpuAllocator();
+
+		Allocation* CreateBuffer(VkDeviceSize, VkBufferUsageFlags, VkMemoryPropertyFlags);
+		Allocation* CreateImage(const VkImageCreateInfo&, VkMemoryPropertyFlags);
+		// the resource and its range are released once the frames in flight have completed
+		void Destroy(Allocation*);
+
+		// copies at most the given bytes, returns how many resources were moved. Only called from the frame loop
+		uint32_t Defragment(VkDeviceSize = DEFAULT_DEFRAGMENT_BYTES);
+
+		Stats GetStats();
+
+	private:
+		Allocation* Bind(std::unique_ptr<Allocation>, const VkMemoryRequirements&);
+		bool AllocateFrom(Block&, const VkMemoryRequirements&, VkDeviceSize&);
+		Block& CreateBlock(uint32_t, bool, VkDeviceSize, bool);
+		void FreeRange(Block*, VkDeviceSize, VkDeviceSize);
+		void ReleaseEmptyBlocks();
+		bool RecordMove(VkCommandBuffer, Allocation&, const std::vector<Block*>&);
+		static bool IsMovable(const Allocation&);
+
+		Device& m_Device;
+
+		std::mutex m_Mutex;
+		std::vector<std::unique_ptr<Block>> m_Blocks;
+		std::unordered_map<Allocation*, std::unique_ptr<Allocation>> m_Allocations;
+		uint64_t m_Moves = 0;
+		uint64_t m_MovedBytes = 0;
+		uint64_t m_FreedBlocks = 0;
+
+		// Defragment's working lists, kept so a frame with nothing to move doesn't touch the heap
+		std::vector<Block*> m_DefragmentBlocks;
+		std::vector<Block*> m_DefragmentTargets;
+		std::vector<Allocation*> m_DefragmentCandidates;
+		std::vector<Allocation*> m_DefragmentMoved;
+	};
+}
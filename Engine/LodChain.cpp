@@ -0,0 +1,135 @@
+#include "./LodChain.hpp"
+#include "./ProceduralGeometry.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+namespace Engine {
+	namespace LodChain {
+		namespace {
+			// merges every vertex inside a cell into their average and drops triangles that collapse
+			Level Cluster(const Level& source, glm::vec2 origin, float cellSize) {
+				struct Cluster {
+					glm::vec2 Position{ 0.0f };
+					glm::vec3 Color{ 0.0f };
+					uint32_t Count = 0;
+				};
+
+				std::unordered_map<uint64_t, uint32_t> cells;
+				std::vector<Cluster> clusters;
+				std::vector<uint32_t> remap(source.Vertices.size());
+
+				for (size_t i = 0; i < source.Vertices.size(); i++) {
+					const Model::Vertex& vertex = source.Vertices[i];
+					const glm::vec2 cell = glm::floor((vertex.position - origin) / cellSize);
+					const uint64_t key = static_cast<uint64_t>(static_cast<uint32_t>(cell.x)) << 32 | static_cast<uint32_t>(cell.y);
+
+					auto [it, inserted] = cells.try_emplace(key, static_cast<uint32_t>(clusters.size()));
+					if (inserted) clusters.emplace_back();
+
+					Cluster& cluster = clusters[it->second];
+					cluster.Position += vertex.position;
+					cluster.Color += vertex.color;
+					cluster.Count++;
+					remap[i] = it->second;
+				}
+
+				Level level;
+				level.Vertices.reserve(clusters.size());
+				for (const auto& cluster : clusters) {
+					const float weight = 1.0f / cluster.Count;
+					level.Vertices.push_back({ cluster.Position * weight, cluster.Color * weight });
+				}
+
+				level.Indices.reserve(source.Indices.size());
+				for (size_t i = 0; i + 2 < source.Indices.size(); i += 3) {
+					const uint32_t a = remap[source.Indices[i]];
+					const uint32_t b = remap[source.Indices[i + 1]];
+					const uint32_t c = remap[source.Indices[i + 2]];
+					if (a == b || b == c || a == c) continue;
+					level.Indices.insert(level.Indices.end(), { a, b, c });
+				}
+				return level;
+			}
+		}
+
+		std::vector<Level> Simplify(const std::vector<Model::Vertex>& vertices, const std::vector<uint32_t>& indices, uint32_t maxLevels) {
+			std::vector<Level> levels(1);
+			levels[0].Vertices = vertices;
+			levels[0].Indices = indices;
+			if (indices.empty()) {
+				levels[0].Indices.resize(vertices.size() - vertices.size() % 3);
+				std::iota(levels[0].Indices.begin(), levels[0].Indices.end(), 0u);
+			}
+			if (vertices.empty()) return levels;
+
+			glm::vec2 min = vertices[0].position;
+			glm::vec2 max = vertices[0].position;
+			for (const auto& vertex : vertices) {
+				min = glm::min(min, vertex.position);
+				max = glm::max(max, vertex.position);
+			}
+			const float extent = std::max(max.x - min.x, max.y - min.y);
+			if (extent <= 0.0f) return levels;
+
+			// about one input vertex per cell to start with, every pass halves the resolution
+			uint32_t resolution = 1;
+			while (resolution * resolution < vertices.size()) resolution *= 2;
+
+			while (levels.size() < maxLevels && resolution > 1) {
+				resolution /= 2;
+				Level level = Cluster(levels.front(), min, extent / resolution * (1.0f + 1e-5f));
+				if (level.Indices.empty()) break;
+
+				// passes that barely reduce anything aren't worth a level, the next coarser grid gets a go instead
+				const size_t previousTriangles = levels.back().Indices.size() / 3;
+				if (level.Indices.size() / 3 > previousTriangles * MAX_TRIANGLE_RATIO) continue;
+				levels.push_back(std::move(level));
+			}
+			return levels;
+		}
+
+		std::shared_ptr<Model> CreateModel(Device& device, const std::vector<Level>& levels) {
+			assert(!levels.empty() && "LOD chain needs at least one level");
+
+			std::vector<Model::MeshSize> sizes;
+			for (const auto& level : levels) {
+				sizes.push_back({ static_cast<uint32_t>(level.Vertices.size()), static_cast<uint32_t>(level.Indices.size()) });
+			}
+
+			float boundingRadius = 0.0f;
+			for (const auto& vertex : levels.front().Vertices) {
+				boundingRadius = std::max(boundingRadius, glm::length(vertex.position));
+			}
+
+			return std::make_shared<Model>(device, sizes, [&levels](uint32_t lod, Model::Vertex* vertices, uint32_t* indices) {
+				const Level& level = levels[lod];
+				std::memcpy(vertices, level.Vertices.data(), sizeof(Model::Vertex) * level.Vertices.size());
+				if (indices != nullptr) {
+					std::memcpy(indices, level.Indices.data(), sizeof(uint32_t) * level.Indices.size());
+				}
+			}, boundingRadius);
+		}
+
+		std::shared_ptr<Model> CreateSierpinski(Device& device, uint32_t depth, uint32_t maxLevels, glm::vec2 left, glm::vec2 right, glm::vec2 top, glm::vec3 color) {
+			const uint32_t levelCount = std::max(1u, std::min(maxLevels, depth + 1));
+
+			std::vector<Model::MeshSize> sizes;
+			for (uint32_t lod = 0; lod < levelCount; lod++) {
+				sizes.push_back(ProceduralGeometry::GetSierpinskiSize(depth - lod));
+			}
+
+			// the gasket never leaves its outer triangle
+			const float boundingRadius = std::max({ glm::length(left), glm::length(right), glm::length(top) });
+
+			return std::make_shared<Model>(device, sizes, [&](uint32_t lod, Model::Vertex* vertices, uint32_t* indices) {
+				ProceduralGeometry::WriteSierpinski(vertices, indices, depth - lod, left, right, top, color);
+			}, boundingRadius);
+		}
+	}
+}
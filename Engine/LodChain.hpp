@@ -0,0 +1,35 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./Model.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std lib headers
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Engine {
+	// Builds Model LOD chains, either by simplifying an arbitrary mesh or by generating a procedural one again at
+	// lower depths. All levels of a chain share one vertex and one index buffer, finest first.
+	namespace LodChain {
+		struct Level {
+			std::vector<Model::Vertex> Vertices;
+			std::vector<uint32_t> Indices;
+		};
+
+		// a coarser level is only kept when it has at most this share of the previous level's triangles
+		constexpr float MAX_TRIANGLE_RATIO = 0.6f;
+
+		// vertex clustering on a grid that coarsens by half per pass, level 0 is the input itself; unindexed input
+		// is treated as a triangle list
+		std::vector<Level> Simplify(const std::vector<Model::Vertex>&, const std::vector<uint32_t>&, uint32_t);
+		std::shared_ptr<Model> CreateModel(Device&, const std::vector<Level>&);
+
+		// the gasket at depth, depth - 1, ... for at most the given number of levels, written straight to staging
+		std::shared_ptr<Model> CreateSierpinski(Device&, uint32_t, uint32_t, glm::vec2, glm::vec2, glm::vec2, glm::vec3 = glm::vec3{ 0.0f });
+	}
+}
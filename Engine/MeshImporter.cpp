@@ -0,0 +1,855 @@
+#include "./MeshImporter.hpp"
+
+#include "./Utils/Hash.hpp"
+#include "./Utils/Json.hpp"
+#include "./Utils/MappedFile.hpp"
+#include "./Utils/ParallelFor.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace Engine {
+	namespace {
+		// bump whenever importer output changes, old cooked files then simply miss
+		constexpr uint32_t COOKED_MESH_VERSION = 1;
+
+		// OBJ text is split into chunks of about this size at line boundaries, one task each
+		constexpr size_t OBJ_CHUNK_SIZE = 1 << 20;
+		constexpr size_t CORNER_GRAIN = 1 << 14;
+
+		constexpr uint32_t GLB_MAGIC = 0x46546c67; // "glTF"
+		constexpr uint32_t GLB_CHUNK_JSON = 0x4e4f534a;
+		constexpr uint32_t GLB_CHUNK_BIN = 0x004e4942;
+
+		using Clock = std::chrono::steady_clock;
+
+		double MillisecondsSince(Clock::time_point start) {
+			return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		}
+
+		inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+		inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+		// the mapping isn't null terminated, so strtod is out; this covers the decimal forms exporters write
+		bool ParseFloat(const char*& cursor, const char* end, float& value) {
+			while (cursor != end && IsBlank(*cursor)) cursor++;
+
+			bool negative = false;
+			if (cursor != end && (*cursor == '-' || *cursor == '+')) negative = *cursor++ == '-';
+
+			uint64_t mantissa = 0;
+			int exponent = 0;
+			bool digits = false;
+			for (; cursor != end && IsDigit(*cursor); cursor++, digits = true) {
+				if (mantissa < 100000000000000000ull) mantissa = mantissa * 10 + (*cursor - '0');
+				else exponent++;
+			}
+			if (cursor != end && *cursor == '.') {
+				for (cursor++; cursor != end && IsDigit(*cursor); cursor++, digits = true) {
+					if (mantissa < 100000000000000000ull) {
+						mantissa = mantissa * 10 + (*cursor - '0');
+						exponent--;
+					}
+				}
+			}
+			if (!digits) return false;
+
+			if (cursor != end && (*cursor == 'e' || *cursor == 'E')) {
+				cursor++;
+				bool negativeExponent = false;
+				if (cursor != end && (*cursor == '-' || *cursor == '+')) negativeExponent = *cursor++ == '-';
+				int written = 0;
+				for (; cursor != end && IsDigit(*cursor); cursor++) {
+					if (written < 10000) written = written * 10 + (*cursor - '0');
+				}
+				exponent += negativeExponent ? -written : written;
+			}
+
+			const double result = static_cast<double>(mantissa) * std::pow(10.0, exponent);
+			value = static_cast<float>(negative ? -result : result);
+			return true;
+		}
+
+		bool ParseInt(const char*& cursor, const char* end, int64_t& value) {
+			while (cursor != end && IsBlank(*cursor)) cursor++;
+
+			bool negative = false;
+			if (cursor != end && (*cursor == '-' || *cursor == '+')) negative = *cursor++ == '-';
+			if (cursor == end || !IsDigit(*cursor)) return false;
+
+			int64_t result = 0;
+			for (; cursor != end && IsDigit(*cursor); cursor++) {
+				if (result < (int64_t{ 1 } << 40)) result = result * 10 + (*cursor - '0');
+			}
+			value = negative ? -result : result;
+			return true;
+		}
+
+		struct ObjChunk {
+			std::vector<float> Positions; // x, y per vertex
+			std::vector<float> Colors; // r, g, b per vertex
+			// zero based vertex indices, relative ones still lack the vertices of earlier chunks
+			std::vector<int64_t> Corners;
+			std::vector<size_t> RelativeCorners;
+			int64_t VertexCount = 0;
+		};
+
+		void ParseObjChunk(const char* cursor, const char* end, ObjChunk& chunk) {
+			std::vector<int64_t> face;
+			std::vector<bool> faceRelative;
+
+			while (cursor < end) {
+				const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+				if (lineEnd == nullptr) lineEnd = end;
+				while (cursor != lineEnd && IsBlank(*cursor)) cursor++;
+
+				if (lineEnd - cursor > 1 && cursor[0] == 'v' && IsBlank(cursor[1])) {
+					cursor++;
+					float values[7];
+					int count = 0;
+					while (count < 7 && ParseFloat(cursor, lineEnd, values[count])) count++;
+					if (count < 3) {
+						throw std::runtime_error("Malformed OBJ vertex");
+					}
+
+					chunk.Positions.insert(chunk.Positions.end(), { values[0], values[1] });
+					// the common "v x y z r g b" extension, everything else is white
+					if (count >= 6) chunk.Colors.insert(chunk.Colors.end(), { values[3], values[4], values[5] });
+					else chunk.Colors.insert(chunk.Colors.end(), { 1.0f, 1.0f, 1.0f });
+					chunk.VertexCount++;
+				} else if (lineEnd - cursor > 1 && cursor[0] == 'f' && IsBlank(cursor[1])) {
+					cursor++;
+					face.clear();
+					faceRelative.clear();
+
+					int64_t index;
+					while (ParseInt(cursor, lineEnd, index)) {
+						if (index == 0) {
+							throw std::runtime_error("Malformed OBJ face");
+						}
+						// texture and normal references don't feed Model::Vertex
+						while (cursor != lineEnd && !IsBlank(*cursor)) cursor++;
+
+						face.push_back(index > 0 ? index - 1 : chunk.VertexCount + index);
+						faceRelative.push_back(index < 0);
+					}
+
+					// polygons become triangle fans
+					for (size_t i = 2; i < face.size(); i++) {
+						for (size_t corner : { size_t{ 0 }, i - 1, i }) {
+							if (faceRelative[corner]) chunk.RelativeCorners.push_back(chunk.Corners.size());
+							chunk.Corners.push_back(face[corner]);
+						}
+					}
+				}
+
+				cursor = lineEnd + 1;
+			}
+		}
+
+		struct GltfBuffer {
+			const unsigned char* Data = nullptr;
+			size_t Size = 0;
+		};
+
+		size_t GetComponentSize(uint32_t componentType) {
+			switch (componentType) {
+			case 5120: case 5121: return 1; // byte, unsigned byte
+			case 5122: case 5123: return 2; // short, unsigned short
+			case 5125: case 5126: return 4; // unsigned int, float
+			default: return 0;
+			}
+		}
+
+		uint32_t GetComponentCount(const std::string& type) {
+			if (type == "SCALAR") return 1;
+			if (type == "VEC2") return 2;
+			if (type == "VEC3") return 3;
+			if (type == "VEC4") return 4;
+			return 0;
+		}
+
+		// json indices are doubles, anything that isn't a valid index maps to SIZE_MAX
+		size_t GetIndex(const JsonValue& value) {
+			const double number = value.GetNumber(-1.0);
+			return number >= 0.0 && number < 4294967296.0 ? static_cast<size_t>(number) : SIZE_MAX;
+		}
+
+		// accessor checked against its buffer once, so element reads need no further bounds checks
+		struct GltfAccessor {
+			const unsigned char* Data = nullptr;
+			size_t Count = 0;
+			size_t Stride = 0;
+			uint32_t ComponentType = 0;
+			uint32_t ComponentCount = 0;
+			bool Normalized = false;
+
+			float ReadFloat(size_t element, uint32_t component) const {
+				const unsigned char* data = this->Data + element * this->Stride + component * GetComponentSize(this->ComponentType);
+				switch (this->ComponentType) {
+				case 5126: { float value; std::memcpy(&value, data, sizeof(value)); return value; }
+				case 5121: return this->Normalized ? *data / 255.0f : *data;
+				case 5123: { uint16_t value; std::memcpy(&value, data, sizeof(value)); return this->Normalized ? value / 65535.0f : value; }
+				case 5125: { uint32_t value; std::memcpy(&value, data, sizeof(value)); return static_cast<float>(value); }
+				case 5120: { int8_t value = static_cast<int8_t>(*data); return this->Normalized ? std::max(value / 127.0f, -1.0f) : value; }
+				case 5122: { int16_t value; std::memcpy(&value, data, sizeof(value)); return this->Normalized ? std::max(value / 32767.0f, -1.0f) : value; }
+				default: return 0.0f;
+				}
+			}
+
+			uint32_t ReadIndex(size_t element) const {
+				const unsigned char* data = this->Data + element * this->Stride;
+				switch (this->ComponentType) {
+				case 5121: return *data;
+				case 5123: { uint16_t value; std::memcpy(&value, data, sizeof(value)); return value; }
+				case 5125: { uint32_t value; std::memcpy(&value, data, sizeof(value)); return value; }
+				default: return UINT32_MAX;
+				}
+			}
+		};
+
+		GltfAccessor ResolveAccessor(const JsonValue& document, const std::vector<GltfBuffer>& buffers, size_t index) {
+			const JsonValue& accessor = document["accessors"][index];
+			if (!accessor.IsObject()) {
+				throw std::runtime_error("glTF accessor out of range");
+			}
+			if (accessor.Has("sparse")) {
+				throw std::runtime_error("Sparse glTF accessors aren't supported");
+			}
+
+			const JsonValue& view = document["bufferViews"][GetIndex(accessor["bufferView"])];
+			const size_t bufferIndex = GetIndex(view["buffer"]);
+			if (!view.IsObject() || bufferIndex >= buffers.size()) {
+				throw std::runtime_error("glTF accessor without a valid buffer view");
+			}
+			const GltfBuffer& buffer = buffers[bufferIndex];
+
+			GltfAccessor result{};
+			result.ComponentType = static_cast<uint32_t>(GetIndex(accessor["componentType"]));
+			result.ComponentCount = GetComponentCount(accessor["type"].GetString());
+			result.Normalized = accessor["normalized"].GetBool();
+			result.Count = GetIndex(accessor["count"]);
+
+			const size_t elementSize = GetComponentSize(result.ComponentType) * result.ComponentCount;
+			const size_t viewOffset = view.Has("byteOffset") ? GetIndex(view["byteOffset"]) : 0;
+			const size_t viewLength = GetIndex(view["byteLength"]);
+			const size_t accessorOffset = accessor.Has("byteOffset") ? GetIndex(accessor["byteOffset"]) : 0;
+			result.Stride = view.Has("byteStride") ? GetIndex(view["byteStride"]) : elementSize;
+
+			const bool valid =
+				elementSize != 0 && result.Count != SIZE_MAX && viewOffset != SIZE_MAX && viewLength != SIZE_MAX &&
+				accessorOffset != SIZE_MAX && result.Stride != SIZE_MAX && result.Stride >= elementSize &&
+				viewOffset <= buffer.Size && viewLength <= buffer.Size - viewOffset &&
+				(result.Count == 0 || (accessorOffset <= viewLength && elementSize <= viewLength - accessorOffset &&
+					result.Count - 1 <= (viewLength - accessorOffset - elementSize) / result.Stride));
+			if (!valid) {
+				throw std::runtime_error("glTF accessor doesn't fit its buffer view");
+			}
+
+			result.Data = buffer.Data + viewOffset + accessorOffset;
+			return result;
+		}
+
+		std::vector<unsigned char> DecodeBase64(const char* text, size_t length) {
+			if (length % 4 != 0) {
+				throw std::runtime_error("Malformed base64 data in glTF buffer");
+			}
+
+			size_t padding = 0;
+			if (length > 0 && text[length - 1] == '=') padding++;
+			if (length > 1 && text[length - 2] == '=') padding++;
+
+			auto decode = [](char c) -> uint32_t {
+				if (c >= 'A' && c <= 'Z') return c - 'A';
+				if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+				if (c >= '0' && c <= '9') return c - '0' + 52;
+				if (c == '+') return 62;
+				if (c == '/') return 63;
+				if (c == '=') return 0;
+				throw std::runtime_error("Malformed base64 data in glTF buffer");
+			};
+
+			// every 4 characters decode into 3 bytes on their own, so groups split freely across threads
+			const size_t groupCount = length / 4;
+			std::vector<unsigned char> bytes(groupCount * 3);
+			ParallelFor(groupCount, 1 << 16, [&](size_t begin, size_t end) {
+				for (size_t group = begin; group < end; group++) {
+					const char* source = text + group * 4;
+					const uint32_t bits = decode(source[0]) << 18 | decode(source[1]) << 12 | decode(source[2]) << 6 | decode(source[3]);
+					bytes[group * 3 + 0] = static_cast<unsigned char>(bits >> 16);
+					bytes[group * 3 + 1] = static_cast<unsigned char>(bits >> 8);
+					bytes[group * 3 + 2] = static_cast<unsigned char>(bits);
+				}
+			});
+			bytes.resize(bytes.size() - padding);
+			return bytes;
+		}
+
+		struct NodeTransform {
+			float Translation[2] = { 0.0f, 0.0f };
+			float Scale[2] = { 1.0f, 1.0f };
+			float Rotation = 0.0f;
+		};
+
+		// the node's transform projected onto the xy plane, rotations are taken about z
+		NodeTransform GetNodeTransform(const JsonValue& node) {
+			NodeTransform transform;
+			const JsonValue& matrix = node["matrix"];
+			if (matrix.Size() == 16) {
+				transform.Translation[0] = static_cast<float>(matrix[12].GetNumber());
+				transform.Translation[1] = static_cast<float>(matrix[13].GetNumber());
+				transform.Scale[0] = static_cast<float>(std::hypot(matrix[0].GetNumber(), matrix[1].GetNumber()));
+				transform.Scale[1] = static_cast<float>(std::hypot(matrix[4].GetNumber(), matrix[5].GetNumber()));
+				transform.Rotation = static_cast<float>(std::atan2(matrix[1].GetNumber(), matrix[0].GetNumber()));
+				return transform;
+			}
+
+			const JsonValue& translation = node["translation"];
+			const JsonValue& rotation = node["rotation"];
+			const JsonValue& scale = node["scale"];
+			transform.Translation[0] = static_cast<float>(translation[0].GetNumber(0.0));
+			transform.Translation[1] = static_cast<float>(translation[1].GetNumber(0.0));
+			transform.Scale[0] = static_cast<float>(scale[0].GetNumber(1.0));
+			transform.Scale[1] = static_cast<float>(scale[1].GetNumber(1.0));
+			transform.Rotation = static_cast<float>(2.0 * std::atan2(rotation[2].GetNumber(0.0), rotation[3].GetNumber(1.0)));
+			return transform;
+		}
+
+		// exact for uniform parent scales, the 2D component can't express shear from non-uniform ones
+		NodeTransform Compose(const NodeTransform& parent, const NodeTransform& local) {
+			const float x = parent.Scale[0] * local.Translation[0];
+			const float y = parent.Scale[1] * local.Translation[1];
+			const float sinR = std::sin(parent.Rotation);
+			const float cosR = std::cos(parent.Rotation);
+
+			NodeTransform world;
+			world.Translation[0] = parent.Translation[0] + cosR * x - sinR * y;
+			world.Translation[1] = parent.Translation[1] + sinR * x + cosR * y;
+			world.Scale[0] = parent.Scale[0] * local.Scale[0];
+			world.Scale[1] = parent.Scale[1] * local.Scale[1];
+			world.Rotation = parent.Rotation + local.Rotation;
+			return world;
+		}
+
+		SceneObjectEntry MakeObject(const NodeTransform& transform, const float color[3], uint32_t meshIndex) {
+			SceneObjectEntry object{};
+			object.Translation[0] = transform.Translation[0];
+			object.Translation[1] = transform.Translation[1];
+			object.Scale[0] = transform.Scale[0];
+			object.Scale[1] = transform.Scale[1];
+			object.Rotation = transform.Rotation;
+			object.Color[0] = color[0];
+			object.Color[1] = color[1];
+			object.Color[2] = color[2];
+			object.MeshIndex = meshIndex;
+			return object;
+		}
+
+		std::string LowerCaseExtension(const std::string& filePath) {
+			std::string extension = std::filesystem::path(filePath).extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return extension;
+		}
+	}
+
+	MeshImporter::MeshImporter(const std::string& cacheDirectory, const MeshImportOptions& options)
+		: m_CacheDirectory{ cacheDirectory }, m_Options{ options } {}
+
+	std::string MeshImporter::Cook(const std::string& sourcePath) {
+		const auto start = Clock::now();
+		MappedFile source{ sourcePath };
+		const char* data = static_cast<const char*>(source.GetData());
+
+		// hashing runs far faster than parsing, so keying by content is cheap and survives renames and touches
+		uint64_t key = HashBytes(data, source.GetSize());
+		HashCombine(key, COOKED_MESH_VERSION);
+		HashCombineBytes(key, this->m_Options.PositionQuantum);
+		HashCombine(key, this->m_Options.QuantizeColors);
+
+		char keyText[17];
+		std::snprintf(keyText, sizeof(keyText), "%016llx", static_cast<unsigned long long>(key));
+		const std::string cookedPath = this->m_CacheDirectory + "/" +
+			std::filesystem::path(sourcePath).stem().string() + "-" + keyText + ".scene";
+
+		if (std::filesystem::exists(cookedPath)) {
+			try {
+				// opening validates the tables, which is all a later load touches before uploading
+				SceneArchive cooked{ cookedPath };
+
+				this->m_LastStats = {};
+				this->m_LastStats.SourceBytes = source.GetSize();
+				this->m_LastStats.CacheHit = true;
+				this->m_LastStats.TotalMilliseconds = MillisecondsSince(start);
+				this->PrintStats(sourcePath);
+				return cookedPath;
+			} catch (const std::runtime_error&) {
+				// truncated by an interrupted write or otherwise unreadable, cook it again
+			}
+		}
+
+		Result result = this->ImportSource(sourcePath, data, source.GetSize());
+		this->WriteCooked(result, cookedPath);
+
+		this->m_LastStats.TotalMilliseconds = MillisecondsSince(start);
+		this->PrintStats(sourcePath);
+		return cookedPath;
+	}
+
+	MeshImporter::Result MeshImporter::Import(const std::string& sourcePath) {
+		const auto start = Clock::now();
+		MappedFile source{ sourcePath };
+
+		Result result = this->ImportSource(sourcePath, static_cast<const char*>(source.GetData()), source.GetSize());
+
+		this->m_LastStats.TotalMilliseconds = MillisecondsSince(start);
+		this->PrintStats(sourcePath);
+		return result;
+	}
+
+	MeshImporter::Result MeshImporter::ImportSource(const std::string& sourcePath, const char* data, size_t size) {
+		this->m_LastStats = {};
+		this->m_LastStats.SourceBytes = size;
+
+		uint32_t magic = 0;
+		if (size >= sizeof(magic)) std::memcpy(&magic, data, sizeof(magic));
+
+		const std::string extension = LowerCaseExtension(sourcePath);
+		if (magic == GLB_MAGIC || extension == ".gltf" || extension == ".glb") {
+			return this->ImportGltf(sourcePath, data, size);
+		}
+		if (extension == ".obj") {
+			return this->ImportObj(sourcePath, data, size);
+		}
+		throw std::runtime_error("Unsupported mesh format: " + sourcePath);
+	}
+
+	MeshImporter::Result MeshImporter::ImportObj(const std::string& sourcePath, const char* data, size_t size) {
+		const auto parseStart = Clock::now();
+
+		std::vector<std::pair<size_t, size_t>> ranges;
+		for (size_t begin = 0; begin < size;) {
+			size_t end = std::min(begin + OBJ_CHUNK_SIZE, size);
+			if (end < size) {
+				const void* newline = std::memchr(data + end, '\n', size - end);
+				end = newline != nullptr ? static_cast<const char*>(newline) - data + 1 : size;
+			}
+			ranges.emplace_back(begin, end);
+			begin = end;
+		}
+
+		std::vector<ObjChunk> chunks(ranges.size());
+		ParallelFor(ranges.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				ParseObjChunk(data + ranges[i].first, data + ranges[i].second, chunks[i]);
+			}
+		});
+
+		// OBJ indices are global, each chunk only learns where its vertices start once all are counted
+		std::vector<int64_t> vertexBase(chunks.size());
+		std::vector<size_t> cornerBase(chunks.size());
+		int64_t vertexCount = 0;
+		size_t cornerCount = 0;
+		for (size_t i = 0; i < chunks.size(); i++) {
+			vertexBase[i] = vertexCount;
+			cornerBase[i] = cornerCount;
+			vertexCount += chunks[i].VertexCount;
+			cornerCount += chunks[i].Corners.size();
+		}
+
+		std::vector<float> positions(static_cast<size_t>(vertexCount) * 2);
+		std::vector<float> colors(static_cast<size_t>(vertexCount) * 3);
+		ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				auto& chunk = chunks[i];
+				std::copy(chunk.Positions.begin(), chunk.Positions.end(), positions.begin() + vertexBase[i] * 2);
+				std::copy(chunk.Colors.begin(), chunk.Colors.end(), colors.begin() + vertexBase[i] * 3);
+				for (size_t corner : chunk.RelativeCorners) {
+					chunk.Corners[corner] += vertexBase[i];
+				}
+				chunk.Positions = {};
+				chunk.Colors = {};
+			}
+		});
+
+		std::vector<Model::Vertex> corners(cornerCount);
+		ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const auto& chunk = chunks[i];
+				for (size_t corner = 0; corner < chunk.Corners.size(); corner++) {
+					const int64_t vertex = chunk.Corners[corner];
+					if (vertex < 0 || vertex >= vertexCount) {
+						throw std::runtime_error("OBJ face refers to a missing vertex in: " + sourcePath);
+					}
+					const float* position = &positions[vertex * 2];
+					const float* color = &colors[vertex * 3];
+					corners[cornerBase[i] + corner] = this->Quantize(position[0], position[1], color[0], color[1], color[2]);
+				}
+			}
+		});
+		this->m_LastStats.ParseMilliseconds = MillisecondsSince(parseStart);
+
+		Result result;
+		if (corners.empty()) {
+			throw std::runtime_error("OBJ file has no faces: " + sourcePath);
+		}
+
+		Mesh mesh;
+		mesh.Name = std::filesystem::path(sourcePath).stem().string();
+		this->Weld(corners, mesh);
+		result.Meshes.push_back(std::move(mesh));
+
+		const float white[3] = { 1.0f, 1.0f, 1.0f };
+		result.Objects.push_back(MakeObject(NodeTransform{}, white, 0));
+		return result;
+	}
+
+	MeshImporter::Result MeshImporter::ImportGltf(const std::string& sourcePath, const char* data, size_t size) {
+		const auto parseStart = Clock::now();
+
+		const char* json = data;
+		size_t jsonSize = size;
+		GltfBuffer binaryChunk{};
+
+		uint32_t magic = 0;
+		if (size >= sizeof(magic)) std::memcpy(&magic, data, sizeof(magic));
+		if (magic == GLB_MAGIC) {
+			// 12 byte header, then length and type prefixed chunks: JSON first, the optional BIN right after
+			uint32_t header[3];
+			if (size < sizeof(header)) {
+				throw std::runtime_error("Truncated glb file: " + sourcePath);
+			}
+			std::memcpy(header, data, sizeof(header));
+			if (header[1] != 2 || header[2] > size) {
+				throw std::runtime_error("Unsupported glb file: " + sourcePath);
+			}
+
+			json = nullptr;
+			for (size_t offset = sizeof(header); offset + 8 <= header[2];) {
+				uint32_t chunkHeader[2];
+				std::memcpy(chunkHeader, data + offset, sizeof(chunkHeader));
+				offset += sizeof(chunkHeader);
+				if (chunkHeader[0] > header[2] - offset) {
+					throw std::runtime_error("Truncated glb chunk in: " + sourcePath);
+				}
+
+				if (chunkHeader[1] == GLB_CHUNK_JSON && json == nullptr) {
+					json = data + offset;
+					jsonSize = chunkHeader[0];
+				} else if (chunkHeader[1] == GLB_CHUNK_BIN && binaryChunk.Data == nullptr) {
+					binaryChunk = { reinterpret_cast<const unsigned char*>(data + offset), chunkHeader[0] };
+				}
+				offset += (chunkHeader[0] + 3) & ~3u;
+			}
+			if (json == nullptr) {
+				throw std::runtime_error("glb file without JSON chunk: " + sourcePath);
+			}
+		}
+
+		const JsonValue document = JsonValue::Parse(json, jsonSize);
+
+		// data URIs are decoded into storage owned here, the glb chunk is read straight from the mapping
+		std::vector<std::vector<unsigned char>> decodedBuffers;
+		std::vector<GltfBuffer> buffers;
+		for (const auto& buffer : document["buffers"].GetArray()) {
+			const std::string& uri = buffer["uri"].GetString();
+			if (!buffer.Has("uri")) {
+				buffers.push_back(binaryChunk);
+			} else if (uri.compare(0, 5, "data:") == 0 && uri.find(";base64,") != std::string::npos) {
+				const size_t payload = uri.find(";base64,") + 8;
+				decodedBuffers.push_back(DecodeBase64(uri.data() + payload, uri.size() - payload));
+				buffers.push_back({ decodedBuffers.back().data(), decodedBuffers.back().size() });
+			} else {
+				throw std::runtime_error("External glTF buffers aren't supported, embed them or use .glb: " + sourcePath);
+			}
+
+			const size_t declaredSize = GetIndex(buffer["byteLength"]);
+			if (declaredSize == SIZE_MAX || declaredSize > buffers.back().Size) {
+				throw std::runtime_error("glTF buffer is smaller than declared in: " + sourcePath);
+			}
+			buffers.back().Size = declaredSize;
+		}
+
+		Result result;
+		double weldMilliseconds = 0.0;
+		const JsonValue& meshes = document["meshes"];
+		// meshes without triangles aren't cooked, nodes referring to them are dropped
+		std::vector<uint32_t> meshIndices(meshes.Size(), UINT32_MAX);
+		std::vector<std::array<float, 3>> meshColors(meshes.Size(), { 1.0f, 1.0f, 1.0f });
+
+		for (size_t meshIndex = 0; meshIndex < meshes.Size(); meshIndex++) {
+			const JsonValue& mesh = meshes[meshIndex];
+			std::vector<Model::Vertex> corners;
+
+			for (const auto& primitive : mesh["primitives"].GetArray()) {
+				// 4 is a triangle list, lines and points have no place in a Model
+				if (primitive.Has("mode") && GetIndex(primitive["mode"]) != 4) continue;
+
+				const JsonValue& attributes = primitive["attributes"];
+				const GltfAccessor positions = ResolveAccessor(document, buffers, GetIndex(attributes["POSITION"]));
+				if (positions.ComponentCount < 2) {
+					throw std::runtime_error("glTF positions must have at least two components in: " + sourcePath);
+				}
+
+				const bool hasColors = attributes.Has("COLOR_0");
+				GltfAccessor colors{};
+				if (hasColors) {
+					colors = ResolveAccessor(document, buffers, GetIndex(attributes["COLOR_0"]));
+					if (colors.ComponentCount < 3) {
+						throw std::runtime_error("glTF colors must be VEC3 or VEC4 in: " + sourcePath);
+					}
+				}
+
+				// the base color is linear like COLOR_0, the two multiply
+				float baseColor[3] = { 1.0f, 1.0f, 1.0f };
+				const JsonValue& material = document["materials"][GetIndex(primitive["material"])];
+				const JsonValue& baseColorFactor = material["pbrMetallicRoughness"]["baseColorFactor"];
+				for (int channel = 0; channel < 3; channel++) {
+					baseColor[channel] = static_cast<float>(baseColorFactor[channel].GetNumber(1.0));
+				}
+				if (corners.empty()) {
+					meshColors[meshIndex] = { baseColor[0], baseColor[1], baseColor[2] };
+				}
+
+				const bool indexed = primitive.Has("indices");
+				GltfAccessor indices{};
+				if (indexed) {
+					indices = ResolveAccessor(document, buffers, GetIndex(primitive["indices"]));
+					if (indices.ComponentCount != 1 || indices.ComponentType == 5126 || GetComponentSize(indices.ComponentType) == 0) {
+						throw std::runtime_error("glTF indices must be unsigned integer scalars in: " + sourcePath);
+					}
+				}
+
+				size_t cornerCount = indexed ? indices.Count : positions.Count;
+				cornerCount -= cornerCount % 3;
+
+				const size_t first = corners.size();
+				corners.resize(first + cornerCount);
+				ParallelFor(cornerCount, CORNER_GRAIN, [&](size_t begin, size_t end) {
+					for (size_t corner = begin; corner < end; corner++) {
+						const size_t vertex = indexed ? indices.ReadIndex(corner) : corner;
+						if (vertex >= positions.Count || (hasColors && vertex >= colors.Count)) {
+							throw std::runtime_error("glTF index out of range in: " + sourcePath);
+						}
+
+						float color[3] = { baseColor[0], baseColor[1], baseColor[2] };
+						if (hasColors) {
+							for (uint32_t channel = 0; channel < 3; channel++) color[channel] *= colors.ReadFloat(vertex, channel);
+						}
+						corners[first + corner] = this->Quantize(positions.ReadFloat(vertex, 0), positions.ReadFloat(vertex, 1), color[0], color[1], color[2]);
+					}
+				});
+			}
+
+			if (corners.empty()) continue;
+
+			const auto weldStart = Clock::now();
+			Mesh cooked;
+			cooked.Name = mesh["name"].IsString() ? mesh["name"].GetString() : "mesh" + std::to_string(meshIndex);
+			this->Weld(corners, cooked);
+			weldMilliseconds += MillisecondsSince(weldStart);
+
+			meshIndices[meshIndex] = static_cast<uint32_t>(result.Meshes.size());
+			result.Meshes.push_back(std::move(cooked));
+		}
+
+		if (result.Meshes.empty()) {
+			throw std::runtime_error("glTF file has no triangle meshes: " + sourcePath);
+		}
+
+		// the hierarchy is flattened into world transforms, the scene graph comes later from the object table
+		const JsonValue& nodes = document["nodes"];
+		const JsonValue& scene = document["scenes"][document.Has("scene") ? GetIndex(document["scene"]) : 0];
+		if (scene.IsObject()) {
+			std::vector<bool> visited(nodes.Size(), false);
+			std::vector<std::pair<size_t, NodeTransform>> stack;
+			for (const auto& root : scene["nodes"].GetArray()) {
+				stack.emplace_back(GetIndex(root), NodeTransform{});
+			}
+
+			while (!stack.empty()) {
+				const auto [nodeIndex, parent] = stack.back();
+				stack.pop_back();
+				if (nodeIndex >= nodes.Size() || visited[nodeIndex]) {
+					throw std::runtime_error("glTF node hierarchy isn't a tree in: " + sourcePath);
+				}
+				visited[nodeIndex] = true;
+
+				const JsonValue& node = nodes[nodeIndex];
+				const NodeTransform world = Compose(parent, GetNodeTransform(node));
+
+				const size_t meshIndex = GetIndex(node["mesh"]);
+				if (meshIndex < meshIndices.size() && meshIndices[meshIndex] != UINT32_MAX) {
+					result.Objects.push_back(MakeObject(world, meshColors[meshIndex].data(), meshIndices[meshIndex]));
+				}
+				for (const auto& child : node["children"].GetArray()) {
+					stack.emplace_back(GetIndex(child), world);
+				}
+			}
+		} else {
+			// no scene to place them, every mesh once at the origin
+			for (size_t meshIndex = 0; meshIndex < meshIndices.size(); meshIndex++) {
+				if (meshIndices[meshIndex] == UINT32_MAX) continue;
+				result.Objects.push_back(MakeObject(NodeTransform{}, meshColors[meshIndex].data(), meshIndices[meshIndex]));
+			}
+		}
+
+		this->m_LastStats.ParseMilliseconds = MillisecondsSince(parseStart) - weldMilliseconds;
+		return result;
+	}
+
+	void MeshImporter::Weld(const std::vector<Model::Vertex>& corners, Mesh& mesh) {
+		const auto weldStart = Clock::now();
+		constexpr uint32_t EMPTY = UINT32_MAX;
+
+		const size_t cornerCount = corners.size();
+		if (cornerCount >= EMPTY) {
+			throw std::runtime_error("Mesh has too many corners to weld");
+		}
+
+		// open addressing table of corner indices, at most half full
+		size_t tableSize = 1;
+		while (tableSize < cornerCount * 2) tableSize <<= 1;
+		const size_t mask = tableSize - 1;
+		std::unique_ptr<std::atomic<uint32_t>[]> table{ new std::atomic<uint32_t>[tableSize] };
+		ParallelFor(tableSize, 1 << 16, [&](size_t begin, size_t end) {
+			for (size_t slot = begin; slot < end; slot++) table[slot].store(EMPTY, std::memory_order_relaxed);
+		});
+
+		// vertices are compared bitwise, quantization already made near duplicates identical
+		auto hashOf = [&corners](uint32_t corner) { return HashBytes(&corners[corner], sizeof(Model::Vertex)); };
+		auto equal = [&corners](uint32_t a, uint32_t b) { return std::memcmp(&corners[a], &corners[b], sizeof(Model::Vertex)) == 0; };
+
+		// a slot ends up holding the lowest corner of its vertex, so the output doesn't depend on thread timing
+		ParallelFor(cornerCount, CORNER_GRAIN, [&](size_t begin, size_t end) {
+			for (size_t corner = begin; corner < end; corner++) {
+				const uint32_t self = static_cast<uint32_t>(corner);
+				size_t slot = hashOf(self) & mask;
+				uint32_t current = table[slot].load(std::memory_order_relaxed);
+				while (true) {
+					if (current == EMPTY) {
+						if (table[slot].compare_exchange_weak(current, self, std::memory_order_relaxed)) break;
+						continue;
+					}
+					if (equal(current, self)) {
+						while (self < current && !table[slot].compare_exchange_weak(current, self, std::memory_order_relaxed)) {}
+						break;
+					}
+					slot = (slot + 1) & mask;
+					current = table[slot].load(std::memory_order_relaxed);
+				}
+			}
+		});
+
+		std::vector<uint32_t> representatives(cornerCount);
+		ParallelFor(cornerCount, CORNER_GRAIN, [&](size_t begin, size_t end) {
+			for (size_t corner = begin; corner < end; corner++) {
+				const uint32_t self = static_cast<uint32_t>(corner);
+				size_t slot = hashOf(self) & mask;
+				while (!equal(table[slot].load(std::memory_order_relaxed), self)) slot = (slot + 1) & mask;
+				representatives[corner] = table[slot].load(std::memory_order_relaxed);
+			}
+		});
+		table.reset();
+
+		// first occurrences keep their order, block counts give each block its output range
+		const size_t blockCount = (cornerCount + CORNER_GRAIN - 1) / CORNER_GRAIN;
+		std::vector<uint32_t> blockBase(blockCount);
+		ParallelFor(blockCount, 1, [&](size_t begin, size_t end) {
+			for (size_t block = begin; block < end; block++) {
+				uint32_t count = 0;
+				for (size_t corner = block * CORNER_GRAIN; corner < std::min(cornerCount, (block + 1) * CORNER_GRAIN); corner++) {
+					count += representatives[corner] == corner;
+				}
+				blockBase[block] = count;
+			}
+		});
+		uint32_t vertexCount = 0;
+		for (auto& base : blockBase) {
+			const uint32_t count = base;
+			base = vertexCount;
+			vertexCount += count;
+		}
+
+		std::vector<uint32_t> remap(cornerCount);
+		mesh.Vertices.resize(vertexCount);
+		ParallelFor(blockCount, 1, [&](size_t begin, size_t end) {
+			for (size_t block = begin; block < end; block++) {
+				uint32_t next = blockBase[block];
+				for (size_t corner = block * CORNER_GRAIN; corner < std::min(cornerCount, (block + 1) * CORNER_GRAIN); corner++) {
+					if (representatives[corner] != corner) continue;
+					remap[corner] = next;
+					mesh.Vertices[next++] = corners[corner];
+				}
+			}
+		});
+
+		mesh.Indices.resize(cornerCount);
+		ParallelFor(cornerCount, CORNER_GRAIN, [&](size_t begin, size_t end) {
+			for (size_t corner = begin; corner < end; corner++) mesh.Indices[corner] = remap[representatives[corner]];
+		});
+
+		this->m_LastStats.Corners += cornerCount;
+		this->m_LastStats.Vertices += vertexCount;
+		this->m_LastStats.WeldMilliseconds += MillisecondsSince(weldStart);
+	}
+
+	Model::Vertex MeshImporter::Quantize(float x, float y, float r, float g, float b) const {
+		const float quantum = this->m_Options.PositionQuantum;
+		// adding zero turns -0 into +0, which would otherwise keep bitwise equal positions apart
+		auto snap = [quantum](float value) { return (quantum > 0.0f ? std::round(value / quantum) * quantum : value) + 0.0f; };
+		auto channel = [this](float value) {
+			return this->m_Options.QuantizeColors ? std::round(std::clamp(value, 0.0f, 1.0f) * 255.0f) / 255.0f : value + 0.0f;
+		};
+
+		return { { snap(x), snap(y) }, { channel(r), channel(g), channel(b) } };
+	}
+
+	void MeshImporter::WriteCooked(const Result& result, const std::string& cookedPath) {
+		SceneArchiveWriter writer;
+		for (const auto& mesh : result.Meshes) {
+			const uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+			const uint32_t indexCount = static_cast<uint32_t>(mesh.Indices.size());
+
+			if (vertexCount <= UINT16_MAX + 1u) {
+				std::vector<uint16_t> indices(mesh.Indices.begin(), mesh.Indices.end());
+				writer.AddMesh(mesh.Vertices.data(), vertexCount, sizeof(Model::Vertex), SCENE_VERTEX_FORMAT_POSITION2_COLOR3,
+					indices.data(), indexCount, sizeof(uint16_t));
+			} else {
+				writer.AddMesh(mesh.Vertices.data(), vertexCount, sizeof(Model::Vertex), SCENE_VERTEX_FORMAT_POSITION2_COLOR3,
+					mesh.Indices.data(), indexCount, sizeof(uint32_t));
+			}
+		}
+		for (const auto& object : result.Objects) {
+			writer.AddObject(object);
+		}
+
+		// written aside and renamed, so a crash mid-write never leaves a cooked file that looks valid
+		std::filesystem::create_directories(this->m_CacheDirectory);
+		const std::string temporaryPath = cookedPath + ".tmp";
+		writer.Write(temporaryPath);
+		std::filesystem::rename(temporaryPath, cookedPath);
+	}
+
+	void MeshImporter::PrintStats(const std::string& sourcePath) const {
+		const auto& stats = this->m_LastStats;
+		std::cout << "mesh import: " << sourcePath << ", " << stats.SourceBytes / (1024.0 * 1024.0) << " MB in "
+			<< stats.TotalMilliseconds << " ms (" << stats.GetMegabytesPerSecond() << " MB/s)";
+		if (stats.CacheHit) {
+			std::cout << ", cooked cache hit" << std::endl;
+		} else {
+			std::cout << ", parse " << stats.ParseMilliseconds << " ms, weld " << stats.WeldMilliseconds << " ms, "
+				<< stats.Corners << " corners welded into " << stats.Vertices << " vertices" << std::endl;
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "./Model.hpp"
+
+#include "./Utils/SceneArchive.hpp"
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine {
+	struct MeshImportOptions {
+		// positions snap to this grid before welding, corners closer than that become one vertex
+		float PositionQuantum = 1.0f / 65536.0f;
+		// color channels are rounded to 8 bits, the precision the art was authored in anyway
+		bool QuantizeColors = true;
+	};
+
+	// Imports OBJ and glTF 2.0 (.gltf with embedded buffers or .glb) into Model::Vertex meshes. Parsing, vertex
+	// decoding and welding run across the worker pool. Cook writes the result as a scene archive named after a
+	// hash of the source, so loading the same file again skips the import and just maps the archive.
+	class MeshImporter : public NonMoveable, public NonCopyable {
+	public:
+		struct Mesh {
+			std::string Name;
+			std::vector<Model::Vertex> Vertices;
+			std::vector<uint32_t> Indices;
+		};
+
+		struct Result {
+			std::vector<Mesh> Meshes;
+			// 2D transforms of the source's nodes, OBJ files get one object per mesh
+			std::vector<SceneObjectEntry> Objects;
+		};
+
+		struct Stats {
+			uint64_t SourceBytes = 0;
+			// triangle corners read from the source and the unique vertices they welded into
+			uint64_t Corners = 0;
+			uint64_t Vertices = 0;
+			double ParseMilliseconds = 0.0;
+			double WeldMilliseconds = 0.0;
+			double TotalMilliseconds = 0.0;
+			bool CacheHit = false;
+
+			inline double GetMegabytesPerSecond() const {
+				return this->TotalMilliseconds > 0.0 ? this->SourceBytes / (1024.0 * 1024.0) / (this->TotalMilliseconds / 1000.0) : 0.0;
+			}
+		};
+
+		explicit MeshImporter(const std::string&, const MeshImportOptions& = MeshImportOptions{});
+
+		// path of the cooked scene archive for the source, imported and written only when the cache has none
+		std::string Cook(const std::string&);
+		// parses the source without touching the cache
+		Result Import(const std::string&);
+
+		inline const Stats& GetLastStats() const { return this->m_LastStats; }
+
+	private:
+		Result ImportSource(const std::string&, const char*, size_t);
+		Result ImportObj(const std::string&, const char*, size_t);
+		Result ImportGltf(const std::string&, const char*, size_t);
+		// welds triangle corners into unique vertices and an index list
+		void Weld(const std::vector<Model::Vertex>&, Mesh&);
+		Model::Vertex Quantize(float, float, float, float, float) const;
+		void WriteCooked(const Result&, const std::string&);
+		void PrintStats(const std::string&) const;
+
+		std::string m_CacheDirectory;
+		MeshImportOptions m_Options;
+		Stats m_LastStats;
+	};
+}
@@ -1,62 +1,272 @@
 #include "Model.hpp"
-
+#include "./StagingBuffer.hpp"
 
 // std lib headers
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
 #include <cstring>
+#include <numeric>
 
 namespace Engine {
-	Model::Model(Device& device, const std::vector<Vertex>& vertices) : m_Device{ device } {
-		this->CreateVertexBuffer(vertices);
+	Model::Model(Device& device, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+		: Model(device, vertices.data(), static_cast<uint32_t>(vertices.size()),
+			indices.empty() ? nullptr : indices.data(), static_cast<uint32_t>(indices.size()), VK_INDEX_TYPE_UINT32) {}
+
+	Model::Model(Device& device, const Vertex* vertices, uint32_t vertexCount, const void* indices, uint32_t indexCount, VkIndexType indexType)
+		: m_Device{ device }, m_VertexCount{ vertexCount }, m_IndexCount{ indexCount }, m_IndexType{ indexType } {
+		assert(this->m_VertexCount >= 3 && "Model must have at least 3 vertices");
+		assert((indexCount == 0 || indices != nullptr) && "Model index count given without index data");
+		assert((indexType == VK_INDEX_TYPE_UINT16 || indexType == VK_INDEX_TYPE_UINT32) && "Model indices must be 16 or 32 bit");
+
+		this->m_Lods.push_back({ 0, indexCount, 0, vertexCount });
+		for (uint32_t i = 0; i < vertexCount; i++) {
+			this->m_BoundingRadius = std::max(this->m_BoundingRadius, glm::length(vertices[i].position));
+		}
+
+		this->CreateBuffers([this, vertices, indices](void* vertexData, void* indexData) {
+			std::memcpy(vertexData, vertices, sizeof(Vertex) * static_cast<size_t>(this->m_VertexCount));
+			if (indexData != nullptr) {
+				std::memcpy(indexData, indices, static_cast<size_t>(this->GetIndexSize()) * this->m_IndexCount);
+			}
+		});
+		this->RegisterResidency();
+	}
+
+	Model::Model(Device& device, uint32_t vertexCount, uint32_t indexCount, const std::function<void(Vertex*, uint32_t*)>& write, float boundingRadius)
+		: Model(device, { MeshSize{ vertexCount, indexCount } }, [&write](uint32_t, Vertex* vertices, uint32_t* indices) { write(vertices, indices); }, boundingRadius) {}
+
+	Model::Model(Device& device, const std::vector<MeshSize>& lodSizes, const std::function<void(uint32_t, Vertex*, uint32_t*)>& write, float boundingRadius)
+		: m_Device{ device }, m_VertexCount{ 0 }, m_IndexCount{ 0 }, m_IndexType{ VK_INDEX_TYPE_UINT32 }, m_BoundingRadius{ boundingRadius } {
+		assert(!lodSizes.empty() && "Model needs at least one level of detail");
+
+		for (const auto& size : lodSizes) {
+			assert(size.VertexCount >= 3 && "Model must have at least 3 vertices");
+			this->m_Lods.push_back({ this->m_IndexCount, size.IndexCount, static_cast<int32_t>(this->m_VertexCount), size.VertexCount });
+			this->m_VertexCount += size.VertexCount;
+			this->m_IndexCount += size.IndexCount;
+		}
+
+		this->CreateBuffers([this, &write](void* vertexData, void* indexData) {
+			for (uint32_t lod = 0; lod < this->m_Lods.size(); lod++) {
+				const Lod& level = this->m_Lods[lod];
+				write(lod, static_cast<Vertex*>(vertexData) + level.VertexOffset,
+					level.IndexCount > 0 ? static_cast<uint32_t*>(indexData) + level.FirstIndex : nullptr);
+			}
+		});
+		this->RegisterResidency();
 	}
 
 	Model::~Model() {
-		if (this->m_VertexBuffer != VK_NULL_HANDLE) {
-			vkDestroyBuffer(this->m_Device.GetDevice(), this->m_VertexBuffer, nullptr);
+		this->m_Device.GetResidencyManager().Unregister(this->m_Residency);
+		this->DestroyBuffers(this->m_VertexAllocation, this->m_IndexAllocation);
+	}
+
+	uint64_t Model::NextVersion() {
+		// models are created and moved from loader threads too
+		static std::atomic<uint64_t> version{ 0 };
+		return ++version;
+	}
+
+	bool Model::DropFinestLod() {
+		if (this->m_MinLod + 1 >= this->m_Lods.size()) return false;
+
+		const Lod& dropped = this->m_Lods[this->m_MinLod];
+		const VkDeviceSize droppedVertexBytes = sizeof(Vertex) * static_cast<VkDeviceSize>(dropped.VertexCount);
+		const VkDeviceSize droppedIndexBytes = this->GetIndexSize() * dropped.IndexCount;
+
+		GpuAllocator::Allocation* oldVertexAllocation = this->m_VertexAllocation;
+		GpuAllocator::Allocation* oldIndexAllocation = this->m_IndexAllocation;
+
+		// the remaining levels keep their layout, only shifted to the start of the new buffers
+		this->m_VertexCount -= dropped.VertexCount;
+		this->m_IndexCount -= dropped.IndexCount;
+		for (uint32_t lod = this->m_MinLod + 1; lod < this->m_Lods.size(); lod++) {
+			this->m_Lods[lod].FirstIndex -= dropped.IndexCount;
+			this->m_Lods[lod].VertexOffset -= static_cast<int32_t>(dropped.VertexCount);
+		}
+		this->m_MinLod++;
+		this->AllocateBuffers();
+
+		// frames in flight only read the old buffers, so the copy doesn't have to wait for them
+		VkCommandBuffer commandBuffer = this->m_Device.BeginSingleTimeCommands();
+		VkBufferCopy vertexCopy{ droppedVertexBytes, 0, sizeof(Vertex) * static_cast<VkDeviceSize>(this->m_VertexCount) };
+		vkCmdCopyBuffer(commandBuffer, oldVertexAllocation->Buffer, this->m_VertexAllocation->Buffer, 1, &vertexCopy);
+		if (this->HasIndexBuffer()) {
+			VkBufferCopy indexCopy{ droppedIndexBytes, 0, this->GetIndexSize() * this->m_IndexCount };
+			vkCmdCopyBuffer(commandBuffer, oldIndexAllocation->Buffer, this->m_IndexAllocation->Buffer, 1, &indexCopy);
 		}
-		if (this->m_VertexBufferMemory != VK_NULL_HANDLE) {
-			vkFreeMemory(this->m_Device.GetDevice(), this->m_VertexBufferMemory, nullptr);
+		this->m_UploadValue = this->m_Device.EndSingleTimeCommandsDeferred(commandBuffer);
+
+		this->DestroyBuffers(oldVertexAllocation, oldIndexAllocation);
+		this->m_Version = NextVersion();
+		return true;
+	}
+
+	void Model::Draw(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance, uint32_t lod) {
+		assert(lod < this->m_Lods.size() && "Model level of detail out of range");
+		const Lod& level = this->m_Lods[std::max(lod, this->m_MinLod)];
+		if (level.IndexCount > 0) {
+			vkCmdDrawIndexed(commandBuffer, level.IndexCount, instanceCount, level.FirstIndex, level.VertexOffset, firstInstance);
+		} else {
+			vkCmdDraw(commandBuffer, level.VertexCount, instanceCount, static_cast<uint32_t>(level.VertexOffset), firstInstance);
 		}
 	}
 
-	void Model::Draw(VkCommandBuffer commandBuffer) {
-		vkCmdDraw(commandBuffer, this->m_VertexCount, 1, 0, 0);
+	uint32_t Model::SelectLod(float projectedArea, uint32_t currentLod) const {
+		const uint32_t lodCount = static_cast<uint32_t>(this->m_Lods.size());
+		if (lodCount == 1 || this->m_BoundingRadius <= 0.0f) return this->m_MinLod;
+
+		auto finestFitting = [this, lodCount](float area) {
+			for (uint32_t lod = 0; lod < lodCount; lod++) {
+				if (this->m_Lods[lod].GetTriangleCount() * LOD_PIXELS_PER_TRIANGLE <= area) return lod;
+			}
+			return lodCount - 1;
+		};
+
+		// any level within the band fits well enough, so the current one only changes once it leaves the band
+		const float band = 1.0f + LOD_HYSTERESIS;
+		const uint32_t finest = finestFitting(projectedArea * band);
+		const uint32_t coarsest = finestFitting(projectedArea / band);
+		return std::max(std::clamp(currentLod, finest, coarsest), this->m_MinLod);
+	}
+
+	void Model::ReadBack(std::vector<Geometry>& levels) {
+		// the resident levels are the whole buffers, copied at once and split up on the CPU
+		const VkDeviceSize vertexBytes = sizeof(Vertex) * static_cast<VkDeviceSize>(this->m_VertexCount);
+		const VkDeviceSize indexBytes = this->GetIndexSize() * this->m_IndexCount;
+		const VkDeviceSize indexReadbackOffset = (vertexBytes + 3) & ~VkDeviceSize{ 3 };
+
+		VkBuffer readbackBuffer;
+		VkDeviceMemory readbackMemory;
+		this->m_Device.CreateBuffer(indexReadbackOffset + indexBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, readbackBuffer, readbackMemory);
+
+		VkCommandBuffer commandBuffer = this->m_Device.BeginSingleTimeCommands();
+		VkBufferCopy vertexCopy{ 0, 0, vertexBytes };
+		vkCmdCopyBuffer(commandBuffer, this->m_VertexAllocation->Buffer, readbackBuffer, 1, &vertexCopy);
+		if (this->m_IndexCount > 0) {
+			VkBufferCopy indexCopy{ 0, indexReadbackOffset, indexBytes };
+			vkCmdCopyBuffer(commandBuffer, this->m_IndexAllocation->Buffer, readbackBuffer, 1, &indexCopy);
+		}
+
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+		this->m_Device.EndSingleTimeCommands(commandBuffer);
+
+		void* data;
+		vkMapMemory(this->m_Device.GetDevice(), readbackMemory, 0, VK_WHOLE_SIZE, 0, &data);
+		const auto* readbackData = static_cast<const unsigned char*>(data);
+		const auto* vertexData = reinterpret_cast<const Vertex*>(readbackData);
+
+		levels.assign(this->m_Lods.size(), Geometry{});
+		for (uint32_t lod = this->m_MinLod; lod < this->m_Lods.size(); lod++) {
+			const Lod& level = this->m_Lods[lod];
+			Geometry& geometry = levels[lod];
+
+			const Vertex* firstVertex = vertexData + level.VertexOffset;
+			geometry.Vertices.assign(firstVertex, firstVertex + level.VertexCount);
+
+			if (level.IndexCount == 0) {
+				geometry.Indices.resize(level.VertexCount);
+				std::iota(geometry.Indices.begin(), geometry.Indices.end(), 0u);
+			} else if (this->m_IndexType == VK_INDEX_TYPE_UINT16) {
+				const auto* source = reinterpret_cast<const uint16_t*>(readbackData + indexReadbackOffset) + level.FirstIndex;
+				geometry.Indices.assign(source, source + level.IndexCount);
+			} else {
+				const auto* source = reinterpret_cast<const uint32_t*>(readbackData + indexReadbackOffset) + level.FirstIndex;
+				geometry.Indices.assign(source, source + level.IndexCount);
+			}
+		}
+
+		vkUnmapMemory(this->m_Device.GetDevice(), readbackMemory);
+		vkDestroyBuffer(this->m_Device.GetDevice(), readbackBuffer, nullptr);
+		vkFreeMemory(this->m_Device.GetDevice(), readbackMemory, nullptr);
 	}
 
 	void Model::Bind(VkCommandBuffer commandBuffer) {
-		VkBuffer vertexBuffers[] = { this->m_VertexBuffer };
+		VkBuffer vertexBuffers[] = { this->m_VertexAllocation->Buffer };
 		VkDeviceSize offsets[] = { 0 };
 		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+
+		if (this->HasIndexBuffer()) {
+			vkCmdBindIndexBuffer(commandBuffer, this->m_IndexAllocation->Buffer, 0, this->m_IndexType);
+		}
 	}
 
-	void Model::CreateVertexBuffer(const std::vector<Vertex>& vertices) {
-		this->m_VertexCount = static_cast<uint32_t>(vertices.size());
-		assert(this->m_VertexCount >= 3 && "Model must have at least 3 vertices");
+	void Model::CreateBuffers(const std::function<void(void*, void*)>& write) {
+		// both blobs share one staging buffer and one submission, the model never waits for its upload
+		const VkDeviceSize vertexBufferSize = sizeof(Vertex) * static_cast<VkDeviceSize>(this->m_VertexCount);
+		const VkDeviceSize indexBufferSize = this->GetIndexSize() * this->m_IndexCount;
+		const VkDeviceSize indexStagingOffset = (vertexBufferSize + 3) & ~VkDeviceSize{ 3 };
 
-		VkDeviceSize bufferSize = sizeof(vertices[0]) * this->m_VertexCount;
-		this->m_Device.CreateBuffer(bufferSize,
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			this->m_VertexBuffer,
-			this->m_VertexBufferMemory);
+		StagingBuffer staging{ this->m_Device, indexStagingOffset + indexBufferSize };
+		auto* stagingData = static_cast<unsigned char*>(staging.GetData());
+		write(stagingData, this->HasIndexBuffer() ? stagingData + indexStagingOffset : nullptr);
 
-		void* data;
-		vkMapMemory(this->m_Device.GetDevice(), this->m_VertexBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-		vkUnmapMemory(this->m_Device.GetDevice(), this->m_VertexBufferMemory);
+		this->AllocateBuffers();
+
+		VkCommandBuffer commandBuffer = this->m_Device.BeginSingleTimeCommands();
+		VkBufferCopy vertexCopy{ 0, 0, vertexBufferSize };
+		vkCmdCopyBuffer(commandBuffer, staging.GetBuffer(), this->m_VertexAllocation->Buffer, 1, &vertexCopy);
+		if (this->HasIndexBuffer()) {
+			VkBufferCopy indexCopy{ indexStagingOffset, 0, indexBufferSize };
+			vkCmdCopyBuffer(commandBuffer, staging.GetBuffer(), this->m_IndexAllocation->Buffer, 1, &indexCopy);
+		}
+		this->m_UploadValue = this->m_Device.EndSingleTimeCommandsDeferred(commandBuffer);
+	}
+
+	void Model::AllocateBuffers() {
+		GpuAllocator& allocator = this->m_Device.GetGpuAllocator();
+		// every draw reads the buffers through the allocations, so a move only has to invalidate recorded draws
+		auto onMoved = [this]() { this->m_Version = NextVersion(); };
+
+		// transfer source too, dropping levels and defragmentation copy out of them
+		this->m_VertexAllocation = allocator.CreateBuffer(sizeof(Vertex) * static_cast<VkDeviceSize>(this->m_VertexCount),
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		this->m_VertexAllocation->OnMoved = onMoved;
 
+		this->m_IndexAllocation = nullptr;
+		if (this->HasIndexBuffer()) {
+			this->m_IndexAllocation = allocator.CreateBuffer(this->GetIndexSize() * this->m_IndexCount,
+				VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			this->m_IndexAllocation->OnMoved = onMoved;
+		}
+	}
+
+	void Model::DestroyBuffers(GpuAllocator::Allocation* vertexAllocation, GpuAllocator::Allocation* indexAllocation) {
+		// the buffers may still be referenced by frames in flight, the allocator releases them once those have completed
+		GpuAllocator& allocator = this->m_Device.GetGpuAllocator();
+		if (vertexAllocation != nullptr) allocator.Destroy(vertexAllocation);
+		if (indexAllocation != nullptr) allocator.Destroy(indexAllocation);
 	}
 
-	std::vector<VkVertexInputBindingDescription> Model::Vertex::GetBindingDescriptions() {
-		return {
+	void Model::RegisterResidency() {
+		// every model counts against the budget, only LOD chains can give memory back
+		this->m_Residency = this->m_Device.GetResidencyManager().Register(this->GetMemorySize(), ResidencyManager::Priority::Normal, [this]() {
+			this->DropFinestLod();
+			return this->GetMemorySize();
+		});
+	}
+
+	std::array<VkVertexInputBindingDescription, 1> Model::Vertex::GetBindingDescriptions() {
+		return { {
 			{ 0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX}
-		};
+		} };
 	}
 
-	std::vector<VkVertexInputAttributeDescription> Model::Vertex::GetAttributeDescriptions() {
-		return {
+	std::array<VkVertexInputAttributeDescription, 2> Model::Vertex::GetAttributeDescriptions() {
+		return { {
 			{ 0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, position) },
 			{ 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color) }
-		};
+		} };
 	}
 }
\ No newline at end of file
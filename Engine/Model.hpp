@@ -1,6 +1,8 @@
 #pragma once
 
 #include "./Device.hpp"
+#include "./GpuAllocator.hpp"
+#include "./ResidencyManager.hpp"
 #include "Utils/NonCopyable.hpp"
 #include "Utils/NonMoveable.hpp"
 
@@ -9,6 +11,9 @@
 #include <glm/glm.hpp>
 
 // std lib headers
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
 namespace Engine {
@@ -18,22 +23,107 @@ namespace Engine {
 			glm::vec2 position;
 			glm::vec3 color;
 
-			static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
-			static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+			static std::array<VkVertexInputBindingDescription, 1> GetBindingDescriptions();
+			static std::array<VkVertexInputAttributeDescription, 2> GetAttributeDescriptions();
 		};
 
-		Model(Device&, const std::vector<Vertex>&);
+		struct MeshSize {
+			uint32_t VertexCount = 0;
+			uint32_t IndexCount = 0;
+		};
+
+		// one level of detail, a range of the model's vertex and index buffers; level 0 is the full mesh
+		struct Lod {
+			uint32_t FirstIndex;
+			// 0 draws the level's vertices as a plain triangle list
+			uint32_t IndexCount;
+			int32_t VertexOffset;
+			uint32_t VertexCount;
+
+			inline uint32_t GetTriangleCount() const { return (this->IndexCount > 0 ? this->IndexCount : this->VertexCount) / 3; }
+		};
+
+		// levels aim for at least this many covered pixels per triangle
+		static constexpr float LOD_PIXELS_PER_TRIANGLE = 8.0f;
+		// a level is kept until the projected area leaves it by this fraction, so objects near a threshold don't pop
+		static constexpr float LOD_HYSTERESIS = 0.25f;
+
+		// no indices draws the vertices as a plain triangle list
+		Model(Device&, const std::vector<Vertex>&, const std::vector<uint32_t>& = {});
+		// raw vertices and 16 or 32 bit indices, e.g. straight out of a mapped scene archive, copied once into staging
+		Model(Device&, const Vertex*, uint32_t, const void* = nullptr, uint32_t = 0, VkIndexType = VK_INDEX_TYPE_UINT32);
+		// vertex and 32 bit index counts, the callback writes both straight into the staging mapping. The bounding
+		// radius around the model origin can't be read back cheaply from there, without one only level 0 is picked
+		Model(Device&, uint32_t, uint32_t, const std::function<void(Vertex*, uint32_t*)>&, float = 0.0f);
+		// LOD chain from finest to coarsest stored back to back in the same buffers, the callback is called once per
+		// level with that level's range; its indices are relative to the level's first vertex
+		Model(Device&, const std::vector<MeshSize>&, const std::function<void(uint32_t, Vertex*, uint32_t*)>&, float = 0.0f);
 		~Model();
 
 		void Bind(VkCommandBuffer);
-		void Draw(VkCommandBuffer);
+		void Draw(VkCommandBuffer, uint32_t = 1, uint32_t = 0, uint32_t = 0);
+
+		// level for an object whose bounding square covers the given pixel area, given the level it had last frame;
+		// never finer than the finest level still resident
+		uint32_t SelectLod(float, uint32_t) const;
+		inline uint32_t GetLodCount() const { return static_cast<uint32_t>(this->m_Lods.size()); }
+		inline const Lod& GetLod(uint32_t lod) const { return this->m_Lods[lod]; }
+		inline float GetBoundingRadius() const { return this->m_BoundingRadius; }
+
+		// marks the model as drawn this frame for the residency manager
+		inline void Touch() { this->m_Device.GetResidencyManager().Touch(this->m_Residency); }
+		inline void SetResidencyPriority(ResidencyManager::Priority priority) { this->m_Device.GetResidencyManager().SetPriority(this->m_Residency, priority); }
+		// copies the coarser levels into smaller buffers on the GPU, draws of dropped levels use the finest one left.
+		// False for single level models and chains down to their coarsest level
+		bool DropFinestLod();
+		inline uint32_t GetMinLod() const { return this->m_MinLod; }
+		// changes whenever the buffers are replaced or moved, recorded draws of an older version are stale. Unique
+		// across all models, so a new model created at a freed one's address never shows an old version
+		inline uint64_t GetVersion() const { return this->m_Version; }
+		// also hands out DynamicModel versions, so the two never collide
+		static uint64_t NextVersion();
+		inline VkDeviceSize GetMemorySize() const { return sizeof(Vertex) * static_cast<VkDeviceSize>(this->m_VertexCount) + this->GetIndexSize() * this->m_IndexCount; }
+
+		inline uint32_t GetVertexCount() const { return this->m_VertexCount; }
+		inline uint32_t GetIndexCount() const { return this->m_IndexCount; }
+		inline bool HasIndexBuffer() const { return this->m_IndexCount > 0; }
+		// timeline value of the upload, submissions drawing the model are ordered after it anyway
+		inline uint64_t GetUploadValue() const { return this->m_UploadValue; }
+
+		// a level's vertices and 32 bit indices, relative to its first vertex (0..n for plain lists)
+		struct Geometry {
+			std::vector<Vertex> Vertices;
+			std::vector<uint32_t> Indices;
+		};
+
+		// copies every resident level back from the GPU in one submission, dropped levels are left empty. Waits for
+		// the queue to go idle, so it's only meant for load time work like StaticBatch taking in a new model
+		void ReadBack(std::vector<Geometry>&);
 
 	private:
-		void CreateVertexBuffer(const std::vector<Vertex>&);
+		// the writer gets the staging addresses of the vertices and, for indexed models, the indices
+		void CreateBuffers(const std::function<void(void*, void*)>&);
+		// device local buffers for the current counts, left unfilled
+		void AllocateBuffers();
+		void DestroyBuffers(GpuAllocator::Allocation*, GpuAllocator::Allocation*);
+		void RegisterResidency();
+		inline VkDeviceSize GetIndexSize() const { return this->m_IndexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t); }
 
 		Device& m_Device;
-		VkBuffer m_VertexBuffer;
-		VkDeviceMemory m_VertexBufferMemory;
+		// sub-allocated, the buffers may be moved by the allocator's defragmentation
+		GpuAllocator::Allocation* m_VertexAllocation = nullptr;
 		uint32_t m_VertexCount;
+
+		GpuAllocator::Allocation* m_IndexAllocation = nullptr;
+		uint32_t m_IndexCount;
+		VkIndexType m_IndexType;
+
+		std::vector<Lod> m_Lods;
+		// levels before it were dropped to save memory, the counts above only cover the resident ones
+		uint32_t m_MinLod = 0;
+		float m_BoundingRadius = 0.0f;
+		uint64_t m_UploadValue = 0;
+		uint64_t m_Version = NextVersion();
+		ResidencyManager::Handle m_Residency = ResidencyManager::INVALID_HANDLE;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "./ModelCache.hpp"
+#include "./Utils/Hash.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <utility>
+
+namespace Engine {
+	namespace {
+		// second seed for the content digests, any value other than HashBytes' default works
+		constexpr uint64_t DIGEST_SEED = 0xc2b2ae3d27d4eb4full;
+	}
+
+	ModelCache::ModelCache(Device& device, VkDeviceSize budget) : m_Device{ device }, m_Budget{ budget } {}
+
+	ModelCache::~ModelCache() {}
+
+	std::shared_ptr<Model> ModelCache::GetOrCreate(const std::vector<Model::Vertex>& vertices, const std::vector<uint32_t>& indices) {
+		return this->GetOrCreate(vertices.data(), static_cast<uint32_t>(vertices.size()),
+			indices.empty() ? nullptr : indices.data(), static_cast<uint32_t>(indices.size()), VK_INDEX_TYPE_UINT32);
+	}
+
+	std::shared_ptr<Model> ModelCache::GetOrCreate(const Model::Vertex* vertices, uint32_t vertexCount, const void* indices, uint32_t indexCount, VkIndexType indexType) {
+		const VkDeviceSize indexSize = indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+		const size_t vertexBytes = sizeof(Model::Vertex) * static_cast<size_t>(vertexCount);
+		const size_t indexBytes = static_cast<size_t>(indexSize) * indexCount;
+
+		// 128 bit digests of the contents, from two differently seeded hashes; the layout goes into the key too,
+		// the same bytes read with another stride or index type are another mesh
+		const size_t hashedIndexBytes = indices != nullptr ? indexBytes : 0;
+		std::vector<uint64_t> key{
+			HashBytes(vertices, vertexBytes),
+			HashBytes(vertices, vertexBytes, DIGEST_SEED),
+			HashBytes(indices, hashedIndexBytes),
+			HashBytes(indices, hashedIndexBytes, DIGEST_SEED),
+			sizeof(Model::Vertex),
+			vertexCount,
+			indexCount,
+			static_cast<uint64_t>(indexType) };
+		const uint64_t hash = HashBytes(key.data(), key.size() * sizeof(uint64_t));
+
+		this->m_RequestCount++;
+
+		auto range = this->m_Entries.equal_range(hash);
+		for (auto found = range.first; found != range.second; ++found) {
+			if (found->second.Key != key) continue;
+
+			found->second.LastUse = this->m_RequestCount;
+			this->m_Stats.Hits++;
+			this->m_Stats.BytesSaved += found->second.Bytes;
+			return found->second.Model;
+		}
+
+		// make room first so an upload over budget doesn't evict models that are about to be asked for again
+		const VkDeviceSize bytes = vertexBytes + indexBytes;
+		this->Evict(this->m_Budget > bytes ? this->m_Budget - bytes : 0);
+
+		auto model = std::make_shared<Model>(this->m_Device, vertices, vertexCount, indices, indexCount, indexType);
+		this->m_Entries.emplace(hash, Entry{ std::move(key), model, bytes, this->m_RequestCount });
+		this->m_ResidentBytes += bytes;
+		this->m_Stats.Misses++;
+		return model;
+	}
+
+	void ModelCache::SetBudget(VkDeviceSize budget) {
+		this->m_Budget = budget;
+		this->Trim();
+	}
+
+	void ModelCache::Trim() {
+		this->Evict(this->m_Budget);
+	}
+
+	void ModelCache::Clear() {
+		this->Evict(0);
+	}
+
+	void ModelCache::Evict(VkDeviceSize targetBytes) {
+		if (this->m_ResidentBytes <= targetBytes) return;
+
+		// only the cache's own reference left, the model's buffers are released through the frame timeline
+		std::vector<std::pair<uint64_t, decltype(this->m_Entries)::iterator>> unreferenced;
+		for (auto entry = this->m_Entries.begin(); entry != this->m_Entries.end(); ++entry) {
+			if (entry->second.Model.use_count() == 1) {
+				unreferenced.emplace_back(entry->second.LastUse, entry);
+			}
+		}
+		// every request has its own counter value, so no two entries tie
+		std::sort(unreferenced.begin(), unreferenced.end(),
+			[](const auto& a, const auto& b) { return a.first < b.first; });
+
+		// erasing leaves the iterators to other entries valid
+		for (const auto& lastUseAndEntry : unreferenced) {
+			if (this->m_ResidentBytes <= targetBytes) break;
+
+			this->m_ResidentBytes -= lastUseAndEntry.second->second.Bytes;
+			this->m_Entries.erase(lastUseAndEntry.second);
+			this->m_Stats.Evictions++;
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./Model.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine {
+
+	// Content addressed models: identical vertex and index data (and layout) uploads once and every later
+	// request shares that model. Models nothing outside the cache holds on to anymore are kept around for
+	// reuse until the cache grows past its budget, then the least recently requested ones are dropped.
+	class ModelCache : public NonMoveable, public NonCopyable {
+	public:
+		static constexpr VkDeviceSize DEFAULT_BUDGET = 64ull * 1024 * 1024;
+
+		struct Stats {
+			uint64_t Hits = 0;
+			uint64_t Misses = 0;
+			// buffer bytes hits didn't have to upload again
+			uint64_t BytesSaved = 0;
+			uint64_t Evictions = 0;
+		};
+
+		ModelCache(Device&, VkDeviceSize = DEFAULT_BUDGET);
+		~ModelCache();
+
+		std::shared_ptr<Model> GetOrCreate(const std::vector<Model::Vertex>&, const std::vector<uint32_t>& = {});
+		// same arguments as the raw Model constructor, the data is only read for hashing on a hit
+		std::shared_ptr<Model> GetOrCreate(const Model::Vertex*, uint32_t, const void* = nullptr, uint32_t = 0, VkIndexType = VK_INDEX_TYPE_UINT32);
+
+		// referenced models never count as evictable, so the cache may stay over budget while they're in use
+		void SetBudget(VkDeviceSize);
+		// drops unreferenced models, least recently requested first, until the cache fits its budget
+		void Trim();
+		// drops every unreferenced model regardless of budget
+		void Clear();
+		// drops unreferenced models, least recently requested first, until at most the given bytes are resident
+		void Evict(VkDeviceSize);
+
+		inline const Stats& GetStats() const { return this->m_Stats; }
+		inline size_t Size() const { return this->m_Entries.size(); }
+		inline VkDeviceSize GetResidentBytes() const { return this->m_ResidentBytes; }
+		inline VkDeviceSize GetBudget() const { return this->m_Budget; }
+
+	private:
+		struct Entry {
+			// content digest and layout, compared on every hit rather than trusting the lookup hash alone
+			std::vector<uint64_t> Key;
+			std::shared_ptr<Engine::Model> Model;
+			VkDeviceSize Bytes;
+			// value of the request counter at the last hit or miss
+			uint64_t LastUse;
+		};
+
+		Device& m_Device;
+
+		std::unordered_multimap<uint64_t, Entry> m_Entries;
+		VkDeviceSize m_ResidentBytes = 0;
+		VkDeviceSize m_Budget;
+		uint64_t m_RequestCount = 0;
+
+		Stats m_Stats;
+	};
+}
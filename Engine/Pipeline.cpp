@@ -1,8 +1,8 @@
 #include "./Pipeline.hpp"
 #include "Model.hpp"
+#include "ShaderRegistry.hpp"
 
 // std lib headers
-#include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <cassert>
@@ -10,76 +10,63 @@
 
 namespace Engine {
 
-	Pipeline::Pipeline(Device& device, const PipelineConfigurationInfo& config, const std::string& vertexShaderPath, const std::string& fragmentShaderPath)
+	Pipeline::Pipeline(Device& device, const PipelineConfigurationInfo& config, VkShaderModule vertexShaderModule, VkShaderModule fragmentShaderModule)
 		: m_Device(device) {
 
-		this->CreateGraphicsPipeline(vertexShaderPath, fragmentShaderPath, config);
+		this->CreateGraphicsPipeline(vertexShaderModule, fragmentShaderModule, config);
 	}
 
-	Pipeline::~Pipeline() {
-		vkDestroyShaderModule(this->m_Device.GetDevice(), this->m_VertexShaderModule, nullptr);
-		vkDestroyShaderModule(this->m_Device.GetDevice(), this->m_FragmentShaderModule, nullptr);
-		vkDestroyPipeline(this->m_Device.GetDevice(), this->m_Pipeline, nullptr);
-	};
-
-	std::vector<char> Pipeline::ReadFile(const std::string& filePath) {
-		std::ifstream file(filePath, std::ios::ate | std::ios::binary);
-
-		if (!file.is_open()) {
-			throw std::runtime_error("Failed to open file: " + filePath);
-		}
-
-		size_t fileSize = (size_t)file.tellg();
-		std::vector<char> buffer(fileSize);
-
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
+	Pipeline::Pipeline(Device& device, const PipelineConfigurationInfo& config, const std::string& vertexShaderName, const std::string& fragmentShaderName)
+		: m_Device(device) {
+		auto vertexShader = this->m_Device.GetShaderRegistry().Acquire(vertexShaderName);
+		auto fragmentShader = this->m_Device.GetShaderRegistry().Acquire(fragmentShaderName);
 
-		file.close();
+		this->CreateGraphicsPipeline(vertexShader->GetModule(), fragmentShader->GetModule(), config);
+	}
 
-		return buffer;
+	Pipeline::~Pipeline() {
+		// shared pipelines can go away mid-run while recorded frames still reference them
+		VkDevice device = this->m_Device.GetDevice();
+		VkPipeline pipeline = this->m_Pipeline;
+		this->m_Device.GetFrameTimeline().DeferDestroy([device, pipeline]() {
+			vkDestroyPipeline(device, pipeline, nullptr);
+		});
 	};
 
-	void Pipeline::CreateGraphicsPipeline(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, const PipelineConfigurationInfo& config) {
+	void Pipeline::CreateGraphicsPipeline(VkShaderModule vertexShaderModule, VkShaderModule fragmentShaderModule, const PipelineConfigurationInfo& config) {
 		assert(config.PipelineLayout != VK_NULL_HANDLE &&
 			"Cannot create graphics pipeline: no PipelineLayout provided in config");
 		assert(config.RenderPass != VK_NULL_HANDLE &&
 			"Cannot create graphics pipeline: no RenderPass provided in config");
 
-		auto vertexShaderCode = ReadFile(vertexShaderPath);
-		auto fragmentShaderCode = ReadFile(fragmentShaderPath);
-
-		CreateShaderModule(vertexShaderCode, &this->m_VertexShaderModule);
-		CreateShaderModule(fragmentShaderCode, &this->m_FragmentShaderModule);
+		VkSpecializationInfo vertexSpecializationInfo = config.VertexSpecialization.GetInfo();
+		VkSpecializationInfo fragmentSpecializationInfo = config.FragmentSpecialization.GetInfo();
 
 		VkPipelineShaderStageCreateInfo saderStageInfo[2];
 		saderStageInfo[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		saderStageInfo[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-		saderStageInfo[0].module = this->m_VertexShaderModule;
+		saderStageInfo[0].module = vertexShaderModule;
 		saderStageInfo[0].pName = "main";
 		saderStageInfo[0].flags = 0;
 		saderStageInfo[0].pNext = nullptr;
-		saderStageInfo[0].pSpecializationInfo = nullptr;
+		saderStageInfo[0].pSpecializationInfo = config.VertexSpecialization.IsEmpty() ? nullptr : &vertexSpecializationInfo;
 
 		saderStageInfo[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		saderStageInfo[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		saderStageInfo[1].module = this->m_FragmentShaderModule;
+		saderStageInfo[1].module = fragmentShaderModule;
 		saderStageInfo[1].pName = "main";
 		saderStageInfo[1].flags = 0;
 		saderStageInfo[1].pNext = nullptr;
-		saderStageInfo[1].pSpecializationInfo = nullptr;
-
-		auto bindingDescription = Model::Vertex::GetBindingDescriptions();
-		auto attributeDescriptions = Model::Vertex::GetAttributeDescriptions();
+		saderStageInfo[1].pSpecializationInfo = config.FragmentSpecialization.IsEmpty() ? nullptr : &fragmentSpecializationInfo;
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-		vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescription.size());
-		vertexInputInfo.pVertexBindingDescriptions = bindingDescription.data();
+		vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(config.BindingDescriptions.size());
+		vertexInputInfo.pVertexBindingDescriptions = config.BindingDescriptions.data();
 
-		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(config.AttributeDescriptions.size());
+		vertexInputInfo.pVertexAttributeDescriptions = config.AttributeDescriptions.data();
 
 		VkGraphicsPipelineCreateInfo pipelineInfo{};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
@@ -101,7 +88,7 @@ namespace Engine {
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 		pipelineInfo.basePipelineIndex = -1;
 
-		if (vkCreateGraphicsPipelines(this->m_Device.GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &this->m_Pipeline) != VK_SUCCESS) {
+		if (vkCreateGraphicsPipelines(this->m_Device.GetDevice(), this->m_Device.GetPipelineCache(), 1, &pipelineInfo, nullptr, &this->m_Pipeline) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create graphics pipeline!");
 		}
 
@@ -112,19 +99,104 @@ namespace Engine {
 	};
 
 
-	void Pipeline::CreateShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) {
-		VkShaderModuleCreateInfo createInfo{};
-		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = code.size();
-		createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+	// with the restricted dynamic topology only lists of the same class can be swapped in at draw time
+	static VkPrimitiveTopology GetTopologyClass(VkPrimitiveTopology topology) {
+		switch (topology) {
+		case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+			return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+			return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+		case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+			return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+		default:
+			return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		}
+	}
 
-		if (vkCreateShaderModule(this->m_Device.GetDevice(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
-			throw std::runtime_error("Failed to create shader module!");
+	RenderState Pipeline::MakeRenderStateDynamic(const Device& device, PipelineConfigurationInfo& configInfo) {
+		const auto& support = device.GetExtendedDynamicStateSupport();
+
+		RenderState state{};
+		state.CullMode = configInfo.RasterizationInfo.cullMode;
+		state.FrontFace = configInfo.RasterizationInfo.frontFace;
+		state.Topology = configInfo.InputAssemblyInfo.topology;
+		state.DepthTestEnable = configInfo.DepthStencilInfo.depthTestEnable;
+		state.DepthWriteEnable = configInfo.DepthStencilInfo.depthWriteEnable;
+		state.DepthCompareOp = configInfo.DepthStencilInfo.depthCompareOp;
+		state.DepthBiasEnable = configInfo.RasterizationInfo.depthBiasEnable;
+		state.PrimitiveRestartEnable = configInfo.InputAssemblyInfo.primitiveRestartEnable;
+
+		const auto& attachment = configInfo.ColorBlendAttachment;
+		state.BlendEnable = attachment.blendEnable;
+		state.BlendEquation = {
+			attachment.srcColorBlendFactor, attachment.dstColorBlendFactor, attachment.colorBlendOp,
+			attachment.srcAlphaBlendFactor, attachment.dstAlphaBlendFactor, attachment.alphaBlendOp };
+		state.ColorWriteMask = attachment.colorWriteMask;
+
+		// the reset values below are what the registry hashes, every variant of a group lands on the same key
+		const RenderState baked{};
+		auto& dynamicStates = configInfo.DynamicStateEnables;
+
+		if (support.State) {
+			state.Dynamic.State = true;
+			dynamicStates.insert(dynamicStates.end(), {
+				VK_DYNAMIC_STATE_CULL_MODE_EXT,
+				VK_DYNAMIC_STATE_FRONT_FACE_EXT,
+				VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT,
+				VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT,
+				VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT,
+				VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT });
+
+			configInfo.RasterizationInfo.cullMode = baked.CullMode;
+			configInfo.RasterizationInfo.frontFace = baked.FrontFace;
+			configInfo.InputAssemblyInfo.topology = support.UnrestrictedTopology ? baked.Topology : GetTopologyClass(state.Topology);
+			configInfo.DepthStencilInfo.depthTestEnable = baked.DepthTestEnable;
+			configInfo.DepthStencilInfo.depthWriteEnable = baked.DepthWriteEnable;
+			configInfo.DepthStencilInfo.depthCompareOp = baked.DepthCompareOp;
+		}
+
+		if (support.State2) {
+			state.Dynamic.State2 = true;
+			dynamicStates.insert(dynamicStates.end(), {
+				VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE_EXT,
+				VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT });
+
+			configInfo.RasterizationInfo.depthBiasEnable = baked.DepthBiasEnable;
+			configInfo.InputAssemblyInfo.primitiveRestartEnable = baked.PrimitiveRestartEnable;
 		}
-	};
 
+		if (support.ColorBlend) {
+			state.Dynamic.ColorBlend = true;
+			dynamicStates.insert(dynamicStates.end(), {
+				VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT,
+				VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT,
+				VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT });
+
+			configInfo.ColorBlendAttachment.blendEnable = baked.BlendEnable;
+			configInfo.ColorBlendAttachment.srcColorBlendFactor = baked.BlendEquation.srcColorBlendFactor;
+			configInfo.ColorBlendAttachment.dstColorBlendFactor = baked.BlendEquation.dstColorBlendFactor;
+			configInfo.ColorBlendAttachment.colorBlendOp = baked.BlendEquation.colorBlendOp;
+			configInfo.ColorBlendAttachment.srcAlphaBlendFactor = baked.BlendEquation.srcAlphaBlendFactor;
+			configInfo.ColorBlendAttachment.dstAlphaBlendFactor = baked.BlendEquation.dstAlphaBlendFactor;
+			configInfo.ColorBlendAttachment.alphaBlendOp = baked.BlendEquation.alphaBlendOp;
+			configInfo.ColorBlendAttachment.colorWriteMask = baked.ColorWriteMask;
+		}
+
+		configInfo.ColorBlendInfo.pAttachments = &configInfo.ColorBlendAttachment;
+		configInfo.DynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+		configInfo.DynamicStateInfo.pDynamicStates = dynamicStates.data();
+		return state;
+	}
 
 	void Pipeline::DefaultPipelineConfigurationInfo(PipelineConfigurationInfo& configInfo) {
+		auto bindingDescriptions = Model::Vertex::GetBindingDescriptions();
+		auto attributeDescriptions = Model::Vertex::GetAttributeDescriptions();
+		configInfo.BindingDescriptions.assign(bindingDescriptions.begin(), bindingDescriptions.end());
+		configInfo.AttributeDescriptions.assign(attributeDescriptions.begin(), attributeDescriptions.end());
+
 		configInfo.InputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
 		configInfo.InputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 		configInfo.InputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
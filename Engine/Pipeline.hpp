@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Device.hpp"
+#include "Specialization.hpp"
+#include "DynamicState.hpp"
 #include "./Utils/NonMoveable.hpp"
 #include "./Utils/NonCopyable.hpp"
 
@@ -10,6 +12,9 @@
 
 namespace Engine {
 	struct PipelineConfigurationInfo {
+		// Model::Vertex by default, systems with their own vertex format replace both
+		std::vector<VkVertexInputBindingDescription> BindingDescriptions;
+		std::vector<VkVertexInputAttributeDescription> AttributeDescriptions;
 		VkPipelineViewportStateCreateInfo ViewportInfo;
 		VkPipelineInputAssemblyStateCreateInfo InputAssemblyInfo;
 		VkPipelineRasterizationStateCreateInfo RasterizationInfo;
@@ -20,6 +25,10 @@ namespace Engine {
 		std::vector<VkDynamicState> DynamicStateEnables;
 		VkPipelineDynamicStateCreateInfo DynamicStateInfo;
 
+		// resolved when the pipeline is compiled, each distinct set of values is its own pipeline
+		ShaderSpecialization VertexSpecialization;
+		ShaderSpecialization FragmentSpecialization;
+
 		VkPipelineLayout PipelineLayout = nullptr;
 		VkRenderPass RenderPass = nullptr;
 		uint32_t Subpass = 0;
@@ -29,22 +38,22 @@ namespace Engine {
 
 	class Pipeline : public NonMoveable {
 	public:
+		// shader modules are only borrowed for the duration of the constructor
+		Pipeline(Device&, const PipelineConfigurationInfo&, VkShaderModule, VkShaderModule);
 		Pipeline(Device&, const PipelineConfigurationInfo&, const std::string&, const std::string&);
 		~Pipeline();
 
 		void Bind(VkCommandBuffer);
 		static void DefaultPipelineConfigurationInfo(PipelineConfigurationInfo&);
+		// Moves whatever the device can set dynamically out of the configuration and returns it, the baked
+		// values are reset so materials that only differ there share one pipeline. The result has to be
+		// applied with DynamicStateCommands after every Bind.
+		static RenderState MakeRenderStateDynamic(const Device&, PipelineConfigurationInfo&);
 	private:
-		static std::vector<char> ReadFile(const std::string&);
-
-		void CreateGraphicsPipeline(const std::string&, const std::string&, const PipelineConfigurationInfo&);
-
-		void CreateShaderModule(const std::vector<char>&, VkShaderModule*);
+		void CreateGraphicsPipeline(VkShaderModule, VkShaderModule, const PipelineConfigurationInfo&);
 
 		Device& m_Device;
 		VkPipeline m_Pipeline;
-		VkShaderModule m_VertexShaderModule;
-		VkShaderModule m_FragmentShaderModule;
 
 	};
 }
\ No newline at end of file
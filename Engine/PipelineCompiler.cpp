@@ -0,0 +1,138 @@
+#include "./PipelineCompiler.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <stdexcept>
+
+namespace Engine {
+	// PipelineHandle
+
+	std::shared_ptr<Pipeline> PipelineHandle::Get() const {
+		if (!this->IsReady()) return nullptr;
+		// aliasing constructor, the pipeline keeps the whole state alive so the registry can still find it
+		return std::shared_ptr<Pipeline>(this->m_State, this->m_State->Result.get());
+	}
+
+	std::shared_ptr<Pipeline> PipelineHandle::Wait() const {
+		assert(this->IsValid() && "Cannot wait on an empty pipeline handle");
+		{
+			std::unique_lock<std::mutex> lock(this->m_State->Mutex);
+			this->m_State->Finished.wait(lock, [this]() { return this->IsReady() || this->HasFailed(); });
+		}
+		if (this->HasFailed()) {
+			std::rethrow_exception(this->m_State->Error);
+		}
+		return this->Get();
+	}
+
+	// PipelineCompiler
+
+	PipelineCompiler::PipelineCompiler(Device& device, uint32_t workerCount) : m_Device{ device } {
+		if (workerCount == 0) {
+			// leave the main and submit threads their cores, compiles are bursty and rarely need more
+			workerCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+		}
+
+		for (uint32_t i = 0; i < workerCount; i++) {
+			this->m_Workers.emplace_back([this]() { this->Run(); });
+		}
+	}
+
+	PipelineCompiler::~PipelineCompiler() {
+		std::deque<std::unique_ptr<Job>> abandoned;
+		{
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			this->m_Running = false;
+			std::swap(abandoned, this->m_Jobs);
+		}
+		this->m_WorkAvailable.notify_all();
+
+		for (auto& worker : this->m_Workers) {
+			worker.join();
+		}
+
+		// nobody should be waiting at this point, but never leave a waiter hanging
+		for (auto& job : abandoned) {
+			std::lock_guard<std::mutex> lock(job->State->Mutex);
+			job->State->Error = std::make_exception_ptr(std::runtime_error("pipeline compiler shut down before compiling!"));
+			job->State->Failed.store(true, std::memory_order_release);
+			job->State->Finished.notify_all();
+		}
+	}
+
+	PipelineHandle PipelineCompiler::Compile(const PipelineConfigurationInfo& config, const std::string& vertexShaderName, const std::string& fragmentShaderName) {
+		auto job = std::make_unique<Job>();
+		job->Config = config;
+		job->VertexShaderName = vertexShaderName;
+		job->FragmentShaderName = fragmentShaderName;
+		job->VertexShader = this->m_Device.GetShaderRegistry().MakeLease(vertexShaderName);
+		job->FragmentShader = this->m_Device.GetShaderRegistry().MakeLease(fragmentShaderName);
+		job->State = std::make_shared<PipelineHandle::State>();
+
+		// re-point what referred into the caller's config at the copy
+		if (config.ColorBlendInfo.pAttachments == &config.ColorBlendAttachment) {
+			job->Config.ColorBlendInfo.pAttachments = &job->Config.ColorBlendAttachment;
+		}
+		if (config.DynamicStateInfo.pDynamicStates == config.DynamicStateEnables.data()) {
+			job->Config.DynamicStateInfo.pDynamicStates = job->Config.DynamicStateEnables.data();
+		}
+
+		PipelineHandle handle{ job->State };
+		{
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			this->m_Jobs.push_back(std::move(job));
+		}
+		this->m_WorkAvailable.notify_one();
+		return handle;
+	}
+
+	std::vector<PipelineCompiler::CompileRecord> PipelineCompiler::GetCompileRecords() {
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+		return this->m_CompileRecords;
+	}
+
+	void PipelineCompiler::Run() {
+		while (true) {
+			std::unique_ptr<Job> job;
+			{
+				std::unique_lock<std::mutex> lock(this->m_Mutex);
+				this->m_WorkAvailable.wait(lock, [this]() { return !this->m_Running || !this->m_Jobs.empty(); });
+				if (!this->m_Running) break;
+
+				job = std::move(this->m_Jobs.front());
+				this->m_Jobs.pop_front();
+			}
+			this->Execute(*job);
+		}
+	}
+
+	void PipelineCompiler::Execute(Job& job) {
+		auto& state = *job.State;
+		auto start = std::chrono::steady_clock::now();
+
+		try {
+			auto vertexShader = job.VertexShader.Get();
+			auto fragmentShader = job.FragmentShader.Get();
+			auto pipeline = std::make_unique<Pipeline>(this->m_Device, job.Config, vertexShader->GetModule(), fragmentShader->GetModule());
+			double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			{
+				std::lock_guard<std::mutex> lock(this->m_Mutex);
+				this->m_CompileRecords.push_back({ job.VertexShaderName + " + " + job.FragmentShaderName, milliseconds });
+			}
+
+			std::lock_guard<std::mutex> lock(state.Mutex);
+			state.Result = std::move(pipeline);
+			state.CompileMilliseconds = milliseconds;
+			state.Ready.store(true, std::memory_order_release);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(state.Mutex);
+			state.Error = std::current_exception();
+			state.Failed.store(true, std::memory_order_release);
+		}
+		state.Finished.notify_all();
+	}
+}
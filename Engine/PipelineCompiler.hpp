@@ -0,0 +1,102 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./Pipeline.hpp"
+#include "./ShaderRegistry.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Engine {
+
+	// Future-like reference to a pipeline that may still be compiling.
+	// Copies share the same pipeline, which lives as long as any handle or pointer obtained from one does.
+	class PipelineHandle {
+	public:
+		struct State {
+			std::atomic<bool> Ready{ false };
+			std::atomic<bool> Failed{ false };
+			std::unique_ptr<Pipeline> Result;
+			std::exception_ptr Error;
+			double CompileMilliseconds = 0.0;
+
+			std::mutex Mutex;
+			std::condition_variable Finished;
+		};
+
+		PipelineHandle() = default;
+		explicit PipelineHandle(std::shared_ptr<State> state) : m_State{ std::move(state) } {}
+
+		inline bool IsValid() const { return this->m_State != nullptr; }
+		inline bool IsReady() const { return this->m_State != nullptr && this->m_State->Ready.load(std::memory_order_acquire); }
+		inline bool HasFailed() const { return this->m_State != nullptr && this->m_State->Failed.load(std::memory_order_acquire); }
+
+		// nullptr until the compile has finished, never blocks
+		std::shared_ptr<Pipeline> Get() const;
+		// the compiled pipeline if ready, otherwise the given fallback (which may be null to skip drawing)
+		inline Pipeline* GetOr(Pipeline* fallback) const { return this->IsReady() ? this->m_State->Result.get() : fallback; }
+		// blocks until the compile has finished, rethrows if it failed
+		std::shared_ptr<Pipeline> Wait() const;
+
+		// wall time spent creating the pipeline, 0 until ready
+		inline double GetCompileMilliseconds() const { return this->IsReady() ? this->m_State->CompileMilliseconds : 0.0; }
+
+		inline const std::shared_ptr<State>& GetState() const { return this->m_State; }
+
+	private:
+		std::shared_ptr<State> m_State;
+	};
+
+	// Compiles graphics pipelines on a small pool of worker threads, sharing the device pipeline cache.
+	class PipelineCompiler : public NonMoveable, public NonCopyable {
+	public:
+		struct CompileRecord {
+			std::string Name;
+			double Milliseconds;
+		};
+
+		PipelineCompiler(Device&, uint32_t = 0);
+		~PipelineCompiler();
+
+		PipelineHandle Compile(const PipelineConfigurationInfo&, const std::string&, const std::string&);
+
+		std::vector<CompileRecord> GetCompileRecords();
+		inline size_t GetWorkerCount() const { return this->m_Workers.size(); }
+
+	private:
+		struct Job {
+			// the config points into itself, so jobs are never moved once the pointers are fixed up
+			PipelineConfigurationInfo Config;
+			std::string VertexShaderName;
+			std::string FragmentShaderName;
+			// taken when queued, so every pipeline waiting on a shader shares one module
+			ShaderRegistry::Lease VertexShader;
+			ShaderRegistry::Lease FragmentShader;
+			std::shared_ptr<PipelineHandle::State> State;
+		};
+
+		void Run();
+		void Execute(Job&);
+
+		Device& m_Device;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_WorkAvailable;
+		std::deque<std::unique_ptr<Job>> m_Jobs;
+		bool m_Running = true;
+
+		std::vector<CompileRecord> m_CompileRecords;
+		std::vector<std::thread> m_Workers;
+	};
+}
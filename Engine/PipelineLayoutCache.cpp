@@ -0,0 +1,136 @@
+#include "./PipelineLayoutCache.hpp"
+#include "./Descriptors.hpp"
+#include "./ShaderRegistry.hpp"
+#include "./Utils/Hash.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <stdexcept>
+
+namespace Engine {
+	PipelineLayoutCache::PipelineLayoutCache(Device& device) : m_Device{ device } {}
+
+	PipelineLayoutCache::~PipelineLayoutCache() {
+		for (auto& hashAndEntry : this->m_PipelineLayouts) {
+			vkDestroyPipelineLayout(this->m_Device.GetDevice(), hashAndEntry.second.Layout, nullptr);
+		}
+	}
+
+	const ReflectedPipelineLayout& PipelineLayoutCache::GetLayout(const std::vector<std::string>& shaderNames, const std::vector<ExternalSetLayout>& externalSets) {
+		std::vector<const ShaderInterface*> stages;
+		for (const auto& shaderName : shaderNames) {
+			stages.push_back(&this->m_Device.GetShaderRegistry().GetInterface(shaderName));
+		}
+		ShaderInterface shaderInterface = ShaderInterface::Merge(stages);
+
+		std::vector<uint64_t> key;
+		shaderInterface.AppendKey(key);
+		for (const auto& external : externalSets) {
+			key.push_back(external.Set);
+			key.push_back(reinterpret_cast<uint64_t>(external.Layout));
+		}
+		const uint64_t hash = HashBytes(key.data(), key.size() * sizeof(uint64_t));
+
+		auto candidates = this->m_ReflectedLayouts.equal_range(hash);
+		for (auto found = candidates.first; found != candidates.second; ++found) {
+			if (found->second.Key == key) return *found->second.Layout;
+		}
+
+		uint32_t setCount = shaderInterface.GetSetCount();
+		for (const auto& external : externalSets) {
+			setCount = std::max(setCount, external.Set + 1);
+		}
+
+		auto layout = std::make_unique<ReflectedPipelineLayout>();
+		layout->SetLayouts.resize(setCount, VK_NULL_HANDLE);
+
+		for (const auto& external : externalSets) {
+			this->ValidateExternalSet(shaderInterface, external);
+			layout->SetLayouts[external.Set] = external.Layout;
+		}
+
+		// every other set, including unused ones in between, gets a layout derived from the shaders
+		for (uint32_t set = 0; set < setCount; set++) {
+			if (layout->SetLayouts[set] != VK_NULL_HANDLE) continue;
+
+			std::vector<VkDescriptorSetLayoutBinding> bindings;
+			for (const auto& reflected : shaderInterface.Bindings) {
+				if (reflected.Set != set) continue;
+				if (reflected.Count == 0) {
+					throw std::runtime_error("Runtime descriptor array " + reflected.Name + " needs an external set layout (e.g. the bindless table)");
+				}
+
+				VkDescriptorSetLayoutBinding binding{};
+				binding.binding = reflected.Binding;
+				binding.descriptorType = reflected.Type;
+				binding.descriptorCount = reflected.Count;
+				binding.stageFlags = reflected.Stages;
+				bindings.push_back(binding);
+			}
+			layout->SetLayouts[set] = this->m_Device.GetDescriptorLayoutCache().GetLayout(bindings);
+		}
+
+		layout->Layout = this->GetPipelineLayout(layout->SetLayouts, shaderInterface.PushConstantRanges);
+		layout->Interface = std::move(shaderInterface);
+
+		return *this->m_ReflectedLayouts.emplace(hash, ReflectedEntry{ std::move(key), std::move(layout) })->second.Layout;
+	}
+
+	VkPipelineLayout PipelineLayoutCache::GetPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstantRanges) {
+		std::vector<uint64_t> key;
+		key.push_back(setLayouts.size());
+		for (auto setLayout : setLayouts) {
+			key.push_back(reinterpret_cast<uint64_t>(setLayout));
+		}
+		for (const auto& range : pushConstantRanges) {
+			AppendKeyBytes(key, range);
+		}
+		const uint64_t hash = HashBytes(key.data(), key.size() * sizeof(uint64_t));
+
+		auto candidates = this->m_PipelineLayouts.equal_range(hash);
+		for (auto found = candidates.first; found != candidates.second; ++found) {
+			if (found->second.Key == key) return found->second.Layout;
+		}
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+		pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+		pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+
+		VkPipelineLayout pipelineLayout;
+		if (vkCreatePipelineLayout(this->m_Device.GetDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline layout!");
+		}
+		this->m_PipelineLayouts.emplace(hash, LayoutEntry{ std::move(key), pipelineLayout });
+		return pipelineLayout;
+	}
+
+	void PipelineLayoutCache::ValidateExternalSet(const ShaderInterface& shaderInterface, const ExternalSetLayout& external) const {
+		const auto* bindings = this->m_Device.GetDescriptorLayoutCache().FindBindings(external.Layout);
+		if (bindings == nullptr) return; // not created through the layout cache, nothing to compare against
+
+		auto compatible = [](VkDescriptorType layoutType, VkDescriptorType shaderType) {
+			// shaders can't tell dynamic offsets apart from plain buffers
+			if (layoutType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) layoutType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			if (layoutType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC) layoutType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			return layoutType == shaderType;
+		};
+
+		for (const auto& reflected : shaderInterface.Bindings) {
+			if (reflected.Set != external.Set) continue;
+
+			auto binding = std::find_if(bindings->begin(), bindings->end(), [&](const VkDescriptorSetLayoutBinding& b) { return b.binding == reflected.Binding; });
+			const bool valid =
+				binding != bindings->end() &&
+				compatible(binding->descriptorType, reflected.Type) &&
+				(binding->stageFlags & reflected.Stages) == reflected.Stages &&
+				(reflected.Count == 0 || binding->descriptorCount >= reflected.Count);
+			if (!valid) {
+				throw std::runtime_error("Shader binding " + reflected.Name + " (set " + std::to_string(reflected.Set) + ", binding " +
+					std::to_string(reflected.Binding) + ") doesn't match the external set layout");
+			}
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./ShaderReflection.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine {
+
+	struct ReflectedPipelineLayout {
+		VkPipelineLayout Layout = VK_NULL_HANDLE;
+		std::vector<VkDescriptorSetLayout> SetLayouts;
+		ShaderInterface Interface;
+	};
+
+	// A set that is bound from descriptor sets created elsewhere (frame ring, bindless table).
+	// Its layout is used as is, the shaders' bindings are only checked against it.
+	struct ExternalSetLayout {
+		uint32_t Set;
+		VkDescriptorSetLayout Layout;
+	};
+
+	// Derives pipeline layouts from the shaders' reflected interface. Systems whose shaders declare the same
+	// interface get the same VkPipelineLayout (and so can share pipelines and bound sets).
+	class PipelineLayoutCache : public NonMoveable, public NonCopyable {
+	public:
+		PipelineLayoutCache(Device&);
+		~PipelineLayoutCache();
+
+		const ReflectedPipelineLayout& GetLayout(const std::vector<std::string>&, const std::vector<ExternalSetLayout>& = {});
+		VkPipelineLayout GetPipelineLayout(const std::vector<VkDescriptorSetLayout>&, const std::vector<VkPushConstantRange>&);
+
+	private:
+		// full keys are compared on a hit, so a hash collision can't hand out another interface's layout
+		struct ReflectedEntry {
+			// merged interface and external sets
+			std::vector<uint64_t> Key;
+			std::unique_ptr<ReflectedPipelineLayout> Layout;
+		};
+
+		struct LayoutEntry {
+			// set layouts and push constant ranges
+			std::vector<uint64_t> Key;
+			VkPipelineLayout Layout;
+		};
+
+		void ValidateExternalSet(const ShaderInterface&, const ExternalSetLayout&) const;
+
+		Device& m_Device;
+
+		// by the hash of the key
+		std::unordered_multimap<uint64_t, ReflectedEntry> m_ReflectedLayouts;
+		std::unordered_multimap<uint64_t, LayoutEntry> m_PipelineLayouts;
+	};
+}
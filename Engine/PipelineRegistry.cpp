@@ -0,0 +1,190 @@
+#include "./PipelineRegistry.hpp"
+#include "./Utils/Hash.hpp"
+
+// std lib headers
+#include <initializer_list>
+
+namespace Engine {
+	PipelineRegistry::PipelineRegistry(Device& device) : m_Device{ device }, m_Compiler{ device } {}
+
+	PipelineHandle PipelineRegistry::GetOrCreateAsync(const PipelineConfigurationInfo& config, const std::string& vertexShaderName, const std::string& fragmentShaderName) {
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+
+		std::vector<uint64_t> key;
+		AppendConfiguration(config, key);
+
+		auto renderPass = this->m_RenderPassKeys.find(config.RenderPass);
+		if (renderPass != this->m_RenderPassKeys.end()) {
+			key.insert(key.end(), renderPass->second.begin(), renderPass->second.end());
+		}
+		else {
+			key.push_back(reinterpret_cast<uint64_t>(config.RenderPass));
+		}
+
+		const uint64_t hash = HashBytes(key.data(), key.size() * sizeof(uint64_t));
+
+		auto candidates = this->m_Pipelines.equal_range(hash);
+		for (auto found = candidates.first; found != candidates.second; ++found) {
+			const Entry& entry = found->second;
+			if (entry.Key != key || entry.VertexShaderName != vertexShaderName || entry.FragmentShaderName != fragmentShaderName) continue;
+
+			// also matches pipelines still compiling, so a variant is never compiled twice
+			if (auto state = entry.State.lock()) {
+				this->m_Stats.Deduplicated++;
+				return PipelineHandle{ std::move(state) };
+			}
+		}
+
+		// drop entries whose pipelines are gone before adding a new one
+		for (auto it = this->m_Pipelines.begin(); it != this->m_Pipelines.end();) {
+			if (it->second.State.expired()) it = this->m_Pipelines.erase(it);
+			else ++it;
+		}
+
+		PipelineHandle handle = this->m_Compiler.Compile(config, vertexShaderName, fragmentShaderName);
+		this->m_Pipelines.emplace(hash, Entry{ std::move(key), vertexShaderName, fragmentShaderName, handle.GetState() });
+		this->m_Stats.Created++;
+		return handle;
+	}
+
+	void PipelineRegistry::RegisterRenderPass(VkRenderPass renderPass, const VkRenderPassCreateInfo& renderPassInfo) {
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+		std::vector<uint64_t>& key = this->m_RenderPassKeys[renderPass];
+		key.clear();
+		AppendRenderPassCompatibility(renderPassInfo, key);
+	}
+
+	void PipelineRegistry::UnregisterRenderPass(VkRenderPass renderPass) {
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+		this->m_RenderPassKeys.erase(renderPass);
+	}
+
+	size_t PipelineRegistry::GetLiveCount() {
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+		size_t count = 0;
+		for (auto& hashAndEntry : this->m_Pipelines) {
+			if (!hashAndEntry.second.State.expired()) count++;
+		}
+		return count;
+	}
+
+	void PipelineRegistry::AppendConfiguration(const PipelineConfigurationInfo& config, std::vector<uint64_t>& key) {
+		// field by field, the create info structs carry pointers and padding that must not leak into the key
+		key.push_back(config.BindingDescriptions.size());
+		for (const auto& binding : config.BindingDescriptions) {
+			AppendKeyBytes(key, binding);
+		}
+		key.push_back(config.AttributeDescriptions.size());
+		for (const auto& attribute : config.AttributeDescriptions) {
+			AppendKeyBytes(key, attribute);
+		}
+
+		key.push_back(config.ViewportInfo.viewportCount);
+		key.push_back(config.ViewportInfo.scissorCount);
+
+		key.push_back(config.InputAssemblyInfo.topology);
+		key.push_back(config.InputAssemblyInfo.primitiveRestartEnable);
+
+		const auto& rasterization = config.RasterizationInfo;
+		key.push_back(rasterization.depthClampEnable);
+		key.push_back(rasterization.rasterizerDiscardEnable);
+		key.push_back(rasterization.polygonMode);
+		key.push_back(rasterization.cullMode);
+		key.push_back(rasterization.frontFace);
+		key.push_back(rasterization.depthBiasEnable);
+		AppendKeyBytes(key, rasterization.depthBiasConstantFactor);
+		AppendKeyBytes(key, rasterization.depthBiasClamp);
+		AppendKeyBytes(key, rasterization.depthBiasSlopeFactor);
+		AppendKeyBytes(key, rasterization.lineWidth);
+
+		const auto& multisample = config.MultisampleInfo;
+		key.push_back(multisample.rasterizationSamples);
+		key.push_back(multisample.sampleShadingEnable);
+		AppendKeyBytes(key, multisample.minSampleShading);
+		key.push_back(multisample.pSampleMask != nullptr ? *multisample.pSampleMask : ~0ull);
+		key.push_back(multisample.alphaToCoverageEnable);
+		key.push_back(multisample.alphaToOneEnable);
+
+		const auto& colorBlend = config.ColorBlendInfo;
+		key.push_back(colorBlend.logicOpEnable);
+		key.push_back(colorBlend.logicOp);
+		key.push_back(colorBlend.attachmentCount);
+		for (uint32_t i = 0; i < colorBlend.attachmentCount; i++) {
+			const auto& attachment = colorBlend.pAttachments[i];
+			key.push_back(attachment.blendEnable);
+			key.push_back(attachment.srcColorBlendFactor);
+			key.push_back(attachment.dstColorBlendFactor);
+			key.push_back(attachment.colorBlendOp);
+			key.push_back(attachment.srcAlphaBlendFactor);
+			key.push_back(attachment.dstAlphaBlendFactor);
+			key.push_back(attachment.alphaBlendOp);
+			key.push_back(attachment.colorWriteMask);
+		}
+		AppendKeyBytes(key, colorBlend.blendConstants);
+
+		const auto& depthStencil = config.DepthStencilInfo;
+		key.push_back(depthStencil.depthTestEnable);
+		key.push_back(depthStencil.depthWriteEnable);
+		key.push_back(depthStencil.depthCompareOp);
+		key.push_back(depthStencil.depthBoundsTestEnable);
+		key.push_back(depthStencil.stencilTestEnable);
+		AppendKeyBytes(key, depthStencil.front);
+		AppendKeyBytes(key, depthStencil.back);
+		AppendKeyBytes(key, depthStencil.minDepthBounds);
+		AppendKeyBytes(key, depthStencil.maxDepthBounds);
+
+		// states made dynamic by Pipeline::MakeRenderStateDynamic were reset to fixed values above,
+		// so only the list itself tells those pipelines apart from fully baked ones
+		key.push_back(config.DynamicStateInfo.dynamicStateCount);
+		for (uint32_t i = 0; i < config.DynamicStateInfo.dynamicStateCount; i++) {
+			key.push_back(config.DynamicStateInfo.pDynamicStates[i]);
+		}
+
+		// variants differ only here, the shaders and state are the same
+		for (const auto* specialization : { &config.VertexSpecialization, &config.FragmentSpecialization }) {
+			key.push_back(specialization->Entries.size());
+			for (const auto& entry : specialization->Entries) {
+				key.push_back(entry.constantID);
+				key.push_back(entry.offset);
+				key.push_back(entry.size);
+			}
+			key.push_back(specialization->Data.size());
+			AppendKeyBytes(key, specialization->Data.data(), specialization->Data.size());
+		}
+
+		key.push_back(reinterpret_cast<uint64_t>(config.PipelineLayout));
+		key.push_back(config.Subpass);
+	}
+
+	void PipelineRegistry::AppendRenderPassCompatibility(const VkRenderPassCreateInfo& renderPassInfo, std::vector<uint64_t>& key) {
+		// everything except what the compatibility rules ignore: layouts and load / store ops
+		key.push_back(renderPassInfo.flags);
+		key.push_back(renderPassInfo.attachmentCount);
+		for (uint32_t i = 0; i < renderPassInfo.attachmentCount; i++) {
+			key.push_back(renderPassInfo.pAttachments[i].format);
+			key.push_back(renderPassInfo.pAttachments[i].samples);
+		}
+
+		auto appendReferences = [&key](uint32_t count, const VkAttachmentReference* references) {
+			key.push_back(count);
+			for (uint32_t i = 0; references != nullptr && i < count; i++) {
+				key.push_back(references[i].attachment);
+			}
+		};
+
+		key.push_back(renderPassInfo.subpassCount);
+		for (uint32_t i = 0; i < renderPassInfo.subpassCount; i++) {
+			const auto& subpass = renderPassInfo.pSubpasses[i];
+			key.push_back(subpass.pipelineBindPoint);
+			appendReferences(subpass.inputAttachmentCount, subpass.pInputAttachments);
+			appendReferences(subpass.colorAttachmentCount, subpass.pColorAttachments);
+			appendReferences(subpass.pResolveAttachments != nullptr ? subpass.colorAttachmentCount : 0, subpass.pResolveAttachments);
+			appendReferences(subpass.pDepthStencilAttachment != nullptr ? 1 : 0, subpass.pDepthStencilAttachment);
+		}
+
+		key.push_back(renderPassInfo.dependencyCount);
+		for (uint32_t i = 0; i < renderPassInfo.dependencyCount; i++) {
+			AppendKeyBytes(key, renderPassInfo.pDependencies[i]);
+		}
+	}
+}
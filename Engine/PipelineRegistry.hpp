@@ -0,0 +1,76 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./Pipeline.hpp"
+#include "./PipelineCompiler.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine {
+
+	// Device wide cache of graphics pipelines keyed by everything that goes into vkCreateGraphicsPipelines.
+	// Pipelines are shared between everyone asking for the same configuration and destroyed with their last user.
+	// New pipelines compile in the background, GetOrCreate simply waits for the result.
+	class PipelineRegistry : public NonMoveable, public NonCopyable {
+	public:
+		struct Stats {
+			uint64_t Created = 0;
+			// requests answered with an already existing pipeline
+			uint64_t Deduplicated = 0;
+		};
+
+		PipelineRegistry(Device&);
+
+		PipelineHandle GetOrCreateAsync(const PipelineConfigurationInfo&, const std::string&, const std::string&);
+		inline std::shared_ptr<Pipeline> GetOrCreate(const PipelineConfigurationInfo& config, const std::string& vertexShaderName, const std::string& fragmentShaderName) {
+			return this->GetOrCreateAsync(config, vertexShaderName, fragmentShaderName).Wait();
+		}
+
+		// Render passes are keyed by compatibility rather than handle, so pipelines survive swap chain recreation.
+		// Unregistered render passes fall back to their handle.
+		void RegisterRenderPass(VkRenderPass, const VkRenderPassCreateInfo&);
+		void UnregisterRenderPass(VkRenderPass);
+
+		// everything but the render pass, as key words compared in full on lookup
+		static void AppendConfiguration(const PipelineConfigurationInfo&, std::vector<uint64_t>&);
+		static void AppendRenderPassCompatibility(const VkRenderPassCreateInfo&, std::vector<uint64_t>&);
+
+		inline Stats GetStats() {
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			return this->m_Stats;
+		}
+		size_t GetLiveCount();
+		inline std::vector<PipelineCompiler::CompileRecord> GetCompileRecords() { return this->m_Compiler.GetCompileRecords(); }
+
+	private:
+		struct Entry {
+			// configuration and render pass compatibility, compared on a hit so a hash collision can't hand out
+			// the wrong pipeline
+			std::vector<uint64_t> Key;
+			std::string VertexShaderName;
+			std::string FragmentShaderName;
+			std::weak_ptr<PipelineHandle::State> State;
+		};
+
+		Device& m_Device;
+
+		std::mutex m_Mutex;
+		// by the hash of the key
+		std::unordered_multimap<uint64_t, Entry> m_Pipelines;
+		std::unordered_map<VkRenderPass, std::vector<uint64_t>> m_RenderPassKeys;
+
+		Stats m_Stats;
+
+		// last, so workers are joined before anything they might touch goes away
+		PipelineCompiler m_Compiler;
+	};
+}
@@ -0,0 +1,283 @@
+#include "./ProceduralGeometry.hpp"
+
+#include "./Utils/ParallelFor.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+// std lib headers
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace Engine {
+	namespace ProceduralGeometry {
+		namespace {
+			// 3^(depth + 1) indices still have to fit 32 bits
+			constexpr uint32_t MAX_SIERPINSKI_DEPTH = 19;
+			// 3 * 4^depth indices
+			constexpr uint32_t MAX_SUBDIVISION_DEPTH = 14;
+			// rows or triangles per task, small outputs run on the calling thread
+			constexpr size_t ROW_GRAIN = 64;
+
+			constexpr std::array<uint64_t, MAX_SIERPINSKI_DEPTH + 2> MakePowersOfThree() {
+				std::array<uint64_t, MAX_SIERPINSKI_DEPTH + 2> powers{};
+				powers[0] = 1;
+				for (size_t i = 1; i < powers.size(); i++) powers[i] = powers[i - 1] * 3;
+				return powers;
+			}
+			constexpr auto POWERS_OF_THREE = MakePowersOfThree();
+
+			uint32_t CheckedCount(uint64_t count, const char* generator) {
+				if (count > UINT32_MAX) {
+					throw std::runtime_error(std::string("procedural ") + generator + " mesh is too large for 32 bit indices!");
+				}
+				return static_cast<uint32_t>(count);
+			}
+
+			// a gasket node owns its triangles and every vertex strictly inside its corners, both as contiguous ranges,
+			// so sibling subtrees never write to the same memory. The corner positions travel with it, the output is
+			// only ever written since it may be a write combined mapping
+			struct SierpinskiNode {
+				uint32_t Corners[3]; // left, right, top
+				glm::vec2 Positions[3];
+				uint32_t Depth;
+				uint32_t InteriorBase;
+				uint32_t FirstTriangle;
+			};
+
+			// writes the node's three edge midpoints and returns its children
+			std::array<SierpinskiNode, 3> SplitSierpinski(Model::Vertex* vertices, const SierpinskiNode& node, const glm::vec3& color) {
+				const uint32_t left = node.Corners[0];
+				const uint32_t right = node.Corners[1];
+				const uint32_t top = node.Corners[2];
+				const uint32_t leftRight = node.InteriorBase;
+				const uint32_t rightTop = node.InteriorBase + 1;
+				const uint32_t leftTop = node.InteriorBase + 2;
+
+				const glm::vec2 leftPosition = node.Positions[0];
+				const glm::vec2 rightPosition = node.Positions[1];
+				const glm::vec2 topPosition = node.Positions[2];
+				const glm::vec2 leftRightPosition = 0.5f * (leftPosition + rightPosition);
+				const glm::vec2 rightTopPosition = 0.5f * (rightPosition + topPosition);
+				const glm::vec2 leftTopPosition = 0.5f * (leftPosition + topPosition);
+
+				vertices[leftRight] = { leftRightPosition, color };
+				vertices[rightTop] = { rightTopPosition, color };
+				vertices[leftTop] = { leftTopPosition, color };
+
+				const uint32_t childDepth = node.Depth - 1;
+				const uint32_t childInterior = static_cast<uint32_t>((POWERS_OF_THREE[node.Depth] - 3) / 2);
+				const uint32_t childTriangles = static_cast<uint32_t>(POWERS_OF_THREE[childDepth]);
+				const uint32_t interiorBase = node.InteriorBase + 3;
+
+				return { {
+					{ { left, leftRight, leftTop }, { leftPosition, leftRightPosition, leftTopPosition },
+						childDepth, interiorBase, node.FirstTriangle },
+					{ { leftRight, right, rightTop }, { leftRightPosition, rightPosition, rightTopPosition },
+						childDepth, interiorBase + childInterior, node.FirstTriangle + childTriangles },
+					{ { leftTop, rightTop, top }, { leftTopPosition, rightTopPosition, topPosition },
+						childDepth, interiorBase + 2 * childInterior, node.FirstTriangle + 2 * childTriangles } } };
+			}
+
+			void EmitSierpinski(Model::Vertex* vertices, uint32_t* indices, const SierpinskiNode& node, const glm::vec3& color) {
+				if (node.Depth == 0) {
+					uint32_t* triangle = indices + static_cast<size_t>(node.FirstTriangle) * 3;
+					triangle[0] = node.Corners[2];
+					triangle[1] = node.Corners[1];
+					triangle[2] = node.Corners[0];
+					return;
+				}
+
+				for (const auto& child : SplitSierpinski(vertices, node, color)) {
+					EmitSierpinski(vertices, indices, child, color);
+				}
+			}
+
+			// repeatable value in [-1, 1] per lattice point
+			float LatticeNoise(uint32_t i, uint32_t j, uint32_t seed) {
+				uint64_t value = (static_cast<uint64_t>(i) << 32 | j) ^ (static_cast<uint64_t>(seed) * 0x9e3779b97f4a7c15ull);
+				value ^= value >> 33;
+				value *= 0xff51afd7ed558ccdull;
+				value ^= value >> 33;
+				value *= 0xc4ceb9fe1a85ec53ull;
+				value ^= value >> 33;
+				return static_cast<float>(value >> 40) / static_cast<float>(1u << 23) - 1.0f;
+			}
+		}
+
+		MeshSize GetSierpinskiSize(uint32_t depth) {
+			if (depth > MAX_SIERPINSKI_DEPTH) {
+				throw std::runtime_error("procedural sierpinski depth is too large for 32 bit indices!");
+			}
+			// the 3 corners plus 3 midpoints per subdivided node: (3^(depth + 1) + 3) / 2
+			return { static_cast<uint32_t>((POWERS_OF_THREE[depth + 1] + 3) / 2), static_cast<uint32_t>(POWERS_OF_THREE[depth + 1]) };
+		}
+
+		void WriteSierpinski(Model::Vertex* vertices, uint32_t* indices, uint32_t depth, glm::vec2 left, glm::vec2 right, glm::vec2 top, glm::vec3 color) {
+			GetSierpinskiSize(depth);
+
+			vertices[0] = { left, color };
+			vertices[1] = { right, color };
+			vertices[2] = { top, color };
+
+			// the first levels are split here until there are enough independent subtrees to keep every thread busy
+			const size_t targetTasks = WorkerPool::Get().GetThreadCount() * 4;
+			std::vector<SierpinskiNode> tasks{ { { 0, 1, 2 }, { left, right, top }, depth, 3, 0 } };
+			while (tasks.size() < targetTasks && tasks.front().Depth > 0) {
+				std::vector<SierpinskiNode> children;
+				children.reserve(tasks.size() * 3);
+				for (const auto& task : tasks) {
+					for (const auto& child : SplitSierpinski(vertices, task, color)) children.push_back(child);
+				}
+				tasks = std::move(children);
+			}
+
+			ParallelFor(tasks.size(), 1, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) EmitSierpinski(vertices, indices, tasks[i], color);
+			});
+		}
+
+		MeshSize GetGridSize(uint32_t columns, uint32_t rows) {
+			if (columns == 0 || rows == 0) {
+				throw std::runtime_error("procedural grid needs at least one cell!");
+			}
+			return { CheckedCount((static_cast<uint64_t>(columns) + 1) * (static_cast<uint64_t>(rows) + 1), "grid"),
+				CheckedCount(static_cast<uint64_t>(columns) * rows * 6, "grid") };
+		}
+
+		void WriteGrid(Model::Vertex* vertices, uint32_t* indices, uint32_t columns, uint32_t rows, glm::vec2 min, glm::vec2 max, glm::vec3 color) {
+			GetGridSize(columns, rows);
+			const glm::vec2 step = (max - min) / glm::vec2{ columns, rows };
+			const size_t stride = static_cast<size_t>(columns) + 1;
+
+			ParallelFor(static_cast<size_t>(rows) + 1, ROW_GRAIN, [&](size_t begin, size_t end) {
+				for (size_t row = begin; row < end; row++) {
+					for (size_t column = 0; column < stride; column++) {
+						vertices[row * stride + column] = { min + step * glm::vec2{ column, row }, color };
+					}
+				}
+			});
+
+			ParallelFor(rows, ROW_GRAIN, [&](size_t begin, size_t end) {
+				for (size_t row = begin; row < end; row++) {
+					for (size_t column = 0; column < columns; column++) {
+						const uint32_t topLeft = static_cast<uint32_t>(row * stride + column);
+						const uint32_t bottomLeft = static_cast<uint32_t>(topLeft + stride);
+						uint32_t* cell = indices + (row * columns + column) * 6;
+						cell[0] = topLeft;
+						cell[1] = topLeft + 1;
+						cell[2] = bottomLeft + 1;
+						cell[3] = bottomLeft + 1;
+						cell[4] = bottomLeft;
+						cell[5] = topLeft;
+					}
+				}
+			});
+		}
+
+		MeshSize GetPolygonSize(uint32_t sides) {
+			if (sides < 3) {
+				throw std::runtime_error("procedural polygon needs at least 3 sides!");
+			}
+			return { CheckedCount(static_cast<uint64_t>(sides) + 1, "polygon"), CheckedCount(static_cast<uint64_t>(sides) * 3, "polygon") };
+		}
+
+		void WritePolygon(Model::Vertex* vertices, uint32_t* indices, uint32_t sides, glm::vec2 center, float radius, glm::vec3 color) {
+			GetPolygonSize(sides);
+			vertices[0] = { center, color };
+
+			// starts at the top, angles grow clockwise on screen since y points down
+			ParallelFor(sides, ROW_GRAIN * 64, [&](size_t begin, size_t end) {
+				for (size_t side = begin; side < end; side++) {
+					const float angle = glm::two_pi<float>() * side / sides - glm::half_pi<float>();
+					vertices[side + 1] = { center + radius * glm::vec2{ std::cos(angle), std::sin(angle) }, color };
+
+					uint32_t* triangle = indices + side * 3;
+					triangle[0] = 0;
+					triangle[1] = static_cast<uint32_t>(side + 1);
+					triangle[2] = static_cast<uint32_t>((side + 1) % sides + 1);
+				}
+			});
+		}
+
+		MeshSize GetSubdivisionSize(uint32_t depth) {
+			if (depth > MAX_SUBDIVISION_DEPTH) {
+				throw std::runtime_error("procedural subdivision depth is too large for 32 bit indices!");
+			}
+			const uint64_t segments = uint64_t{ 1 } << depth;
+			return { static_cast<uint32_t>((segments + 1) * (segments + 2) / 2), static_cast<uint32_t>(segments * segments * 3) };
+		}
+
+		void WriteSubdivision(Model::Vertex* vertices, uint32_t* indices, uint32_t depth, glm::vec2 a, glm::vec2 b, glm::vec2 c, float roughness, uint32_t seed, glm::vec3 color) {
+			const MeshSize size = GetSubdivisionSize(depth);
+
+			// triangular lattice, point (i, j) sits at a + i/n (b - a) + j/n (c - a) with i + j <= n, stored row by row
+			const uint32_t segments = 1u << depth;
+			auto rowStart = [segments](size_t row) { return row * (segments + 1) - row * (row - 1) / 2; };
+
+			// displaced midpoints are read back by finer levels, from this copy since the output is only ever written
+			std::vector<glm::vec2> positions(size.VertexCount);
+			auto positionAt = [&](size_t i, size_t j) { return positions[rowStart(j) + i]; };
+			auto writeAt = [&](size_t i, size_t j, glm::vec2 position) {
+				positions[rowStart(j) + i] = position;
+				vertices[rowStart(j) + i] = { position, color };
+			};
+
+			writeAt(0, 0, a);
+			writeAt(segments, 0, b);
+			writeAt(0, segments, c);
+
+			// midpoint displacement, level by level since a midpoint needs its displaced endpoints; within a level
+			// every new point only reads coarser ones, so rows run in parallel
+			for (uint32_t level = 1; level <= depth; level++) {
+				const uint32_t step = segments >> level;
+				const float amplitude = roughness * 0.5f;
+				const size_t rowCount = segments / step + 1;
+
+				ParallelFor(rowCount, ROW_GRAIN, [&](size_t begin, size_t end) {
+					for (size_t row = begin; row < end; row++) {
+						const uint32_t j = static_cast<uint32_t>(row * step);
+						for (uint32_t i = 0; i + j <= segments; i += step) {
+							const bool oddI = (i / step) & 1;
+							const bool oddJ = (j / step) & 1;
+							if (!oddI && !oddJ) continue;
+
+							// horizontal, vertical or diagonal lattice edge the point halves
+							glm::vec2 from, to;
+							if (oddI && !oddJ) { from = positionAt(i - step, j); to = positionAt(i + step, j); }
+							else if (!oddI && oddJ) { from = positionAt(i, j - step); to = positionAt(i, j + step); }
+							else { from = positionAt(i + step, j - step); to = positionAt(i - step, j + step); }
+
+							const glm::vec2 edge = to - from;
+							const glm::vec2 normal{ -edge.y, edge.x };
+							writeAt(i, j, 0.5f * (from + to) + normal * (amplitude * LatticeNoise(i, j, seed)));
+						}
+					}
+				});
+			}
+
+			// row j holds n - j triangles pointing like the input and n - j - 1 flipped ones in between, both keep its winding
+			ParallelFor(segments, ROW_GRAIN, [&](size_t begin, size_t end) {
+				for (size_t j = begin; j < end; j++) {
+					uint32_t* triangle = indices + (2 * segments * j - j * j) * 3;
+					for (size_t i = 0; i + j < segments; i++) {
+						const uint32_t corner = static_cast<uint32_t>(rowStart(j) + i);
+						const uint32_t above = static_cast<uint32_t>(rowStart(j + 1) + i);
+						triangle[0] = corner;
+						triangle[1] = corner + 1;
+						triangle[2] = above;
+						triangle += 3;
+
+						if (i + j + 1 < segments) {
+							triangle[0] = corner + 1;
+							triangle[1] = above + 1;
+							triangle[2] = above;
+							triangle += 3;
+						}
+					}
+				}
+			});
+		}
+	}
+}
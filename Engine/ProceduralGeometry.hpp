@@ -0,0 +1,37 @@
+#pragma once
+
+#include "./Model.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std lib headers
+#include <cstdint>
+
+namespace Engine {
+	// Indexed meshes generated straight into caller provided storage. Every generator has a size query, so the
+	// output (a pre-sized vector or the staging mapping handed out by Model's writer constructor) is sized once
+	// and never grows while being written. Large outputs are split across the worker pool by subtree or row.
+	// Triangles come out clockwise in the engine's y down space when the given corners are.
+	namespace ProceduralGeometry {
+		using MeshSize = Model::MeshSize;
+
+		// gasket of 3^depth triangles, midpoints shared between neighbors
+		MeshSize GetSierpinskiSize(uint32_t);
+		void WriteSierpinski(Model::Vertex*, uint32_t*, uint32_t, glm::vec2, glm::vec2, glm::vec2, glm::vec3 = glm::vec3{ 0.0f });
+
+		// columns x rows quads spanning the rectangle from min to max
+		MeshSize GetGridSize(uint32_t, uint32_t);
+		void WriteGrid(Model::Vertex*, uint32_t*, uint32_t, uint32_t, glm::vec2, glm::vec2, glm::vec3 = glm::vec3{ 1.0f });
+
+		// regular n-gon fanned around its center, circles are just n-gons with enough sides
+		MeshSize GetPolygonSize(uint32_t);
+		void WritePolygon(Model::Vertex*, uint32_t*, uint32_t, glm::vec2, float, glm::vec3 = glm::vec3{ 1.0f });
+
+		// triangle split into 4^depth, every new edge midpoint is pushed sideways by up to roughness times half
+		// the edge length; 0 gives a flat regular subdivision, the seed makes the displacement repeatable
+		MeshSize GetSubdivisionSize(uint32_t);
+		void WriteSubdivision(Model::Vertex*, uint32_t*, uint32_t, glm::vec2, glm::vec2, glm::vec2, float = 0.0f, uint32_t = 0, glm::vec3 = glm::vec3{ 1.0f });
+	}
+}
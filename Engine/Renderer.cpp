@@ -1,19 +1,48 @@
 #include "Renderer.hpp"
+#include "GpuAllocator.hpp"
+#include "ResidencyManager.hpp"
 
 // std lib headers
 #include <array>
 
 namespace Engine {
 
-	Renderer::Renderer(Engine::Window& window, Engine::Device& device) : m_Window{ window }, m_Device{ device }, m_IsFrameStarted{ false }, m_CurrentFrameIndex{ 0 }{
+	Renderer::Renderer(Engine::Window& window, Engine::Device& device) : m_Window{ window }, m_Device{ device }, m_CommandBufferCache{ device }, m_FrameRing{ device }, m_IsFrameStarted{ false }, m_CurrentFrameIndex{ 0 }{
 		this->RecreateSwapChain();
 		this->CreateCommandBuffers();
+
+		for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			this->m_FrameArenas.push_back(std::make_unique<LinearArena>());
+		}
+
+		if (this->m_Device.SupportsBindless()) {
+			this->m_BindlessTable = std::make_unique<BindlessTable>(this->m_Device);
+		}
+	}
+
+	SpriteBatch* Renderer::GetSpriteBatch() {
+		// its buffers and pipeline are only paid for by apps that draw sprites
+		if (this->m_SpriteBatch == nullptr && this->m_BindlessTable != nullptr) {
+			this->m_SpriteBatch = std::make_unique<SpriteBatch>(
+				this->m_Device,
+				this->m_SwapChain->GetRenderPass(),
+				this->m_FrameRing.GetDescriptorSetLayout(),
+				*this->m_BindlessTable);
+			if (this->m_IsFrameStarted) this->m_SpriteBatch->BeginFrame(this->m_CurrentFrameIndex);
+		}
+		return this->m_SpriteBatch.get();
 	}
 
 	Renderer::~Renderer() {
+		this->WaitIdle();
 		this->FreeCommandBuffers();
 	}
 
+	void Renderer::WaitIdle() {
+		this->m_SubmitThread.Flush();
+		this->m_Device.WaitIdle();
+	}
+
 
 	void Renderer::RecreateSwapChain() {
 		auto extent = this->m_Window.GetExtent();
@@ -23,7 +52,8 @@ namespace Engine {
 			glfwWaitEvents();
 		}
 
-		vkDeviceWaitIdle(this->m_Device.GetDevice());
+		// nothing may still be presenting to the swap chain that is about to be replaced
+		this->WaitIdle();
 
 		if (this->m_SwapChain == nullptr)
 			this->m_SwapChain = std::make_unique<Engine::SwapChain>(this->m_Device, extent);
@@ -37,10 +67,14 @@ namespace Engine {
 
 		}
 
+		// recorded against the old framebuffers and extent
+		this->m_CommandBufferCache.Invalidate();
+
 	}
 
 	void Renderer::CreateCommandBuffers() {
 		this->m_CommandBuffers.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+		this->m_CommandBufferTimelineValues.assign(SwapChain::MAX_FRAMES_IN_FLIGHT, 0);
 
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -62,6 +96,25 @@ namespace Engine {
 	VkCommandBuffer Renderer::BeginFrame() {
 		assert(!this->m_IsFrameStarted && "Cannot begin frame when one is already in progress!");
 
+		// release whatever was waiting on frames the GPU has finished since the last call
+		this->m_Device.GetFrameTimeline().Collect();
+
+		this->m_CommandBufferCache.Trim();
+
+		// memory of whatever gets downgraded here is released with the frames that still use it
+		this->m_Device.GetResidencyManager().Update();
+		// a few megabytes of compaction per frame, owners of moved resources patch their handles before recording
+		this->m_Device.GetGpuAllocator().Defragment();
+
+		// out of date results from earlier presents arrive asynchronously
+		if (this->m_SubmitThread.ConsumeOutOfDate()) {
+			this->RecreateSwapChain();
+			return nullptr;
+		}
+
+		// acquiring past the swap chain's limit of unpresented images could block forever
+		this->m_SubmitThread.WaitForPending(this->m_SwapChain->GetMaxAcquiredImages() - 1);
+
 		auto result = this->m_SwapChain->AcquireNextImage(&this->m_CurrentImageIndex);
 
 		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
@@ -76,6 +129,14 @@ namespace Engine {
 		this->m_IsFrameStarted = true;
 		auto commandBuffer = this->GetCurrentCommandBuffer();
 
+		// the command buffer may still be pending on the GPU from its last use
+		this->m_Device.GetFrameTimeline().Wait(this->m_CommandBufferTimelineValues[this->m_CurrentFrameIndex]);
+
+		// everything else tied to the frame slot is free again as well
+		this->m_FrameArenas[this->m_CurrentFrameIndex]->Reset();
+		this->m_FrameRing.BeginFrame(this->m_CurrentFrameIndex);
+		if (this->m_SpriteBatch) this->m_SpriteBatch->BeginFrame(this->m_CurrentFrameIndex);
+
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
@@ -95,21 +156,27 @@ namespace Engine {
 			throw std::runtime_error("failed to record command buffer!");
 		}
 
-		auto result = this->m_SwapChain->SubmitCommandBuffers(&commandBuffer, &this->m_CurrentImageIndex);
+		// the value is claimed here, on the main thread, so deferred work queued while recording
+		// the next frame already targets that next frame
+		FrameSubmission submission{};
+		submission.Target = this->m_SwapChain.get();
+		submission.CommandBuffer = commandBuffer;
+		submission.ImageIndex = this->m_CurrentImageIndex;
+		submission.TimelineValue = this->m_Device.GetFrameTimeline().NextValue();
+		this->m_CommandBufferTimelineValues[this->m_CurrentFrameIndex] = submission.TimelineValue;
 
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || this->m_Window.WasWindowResized()) {
-			this->m_Window.ResetWindowResizedFlag();
-			this->RecreateSwapChain();
-		}
-		else if (result != VK_SUCCESS) {
-			throw std::runtime_error("failed to present swap chain image!");
-		}
+		this->m_SubmitThread.Push(submission);
 
 		this->m_IsFrameStarted = false;
 		this->m_CurrentFrameIndex = (this->m_CurrentFrameIndex + 1) % SwapChain::MAX_FRAMES_IN_FLIGHT;
+
+		if (this->m_Window.WasWindowResized()) {
+			this->m_Window.ResetWindowResizedFlag();
+			this->RecreateSwapChain();
+		}
 	};
 
-	void Renderer::BeginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
+	void Renderer::BeginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents) {
 		assert(this->m_IsFrameStarted && "Cannot begin render pass when one is not in progress!");
 		assert(commandBuffer == this->GetCurrentCommandBuffer() && "Cannot begin render pass with a command buffer that is not the current command buffer!");
 
@@ -127,8 +194,15 @@ namespace Engine {
 		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 		renderPassInfo.pClearValues = clearValues.data();
 
-		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
 
+		// with secondary contents the dynamic state has to be set inside the secondary buffers
+		if (contents == VK_SUBPASS_CONTENTS_INLINE) {
+			this->SetViewportAndScissor(commandBuffer);
+		}
+	}
+
+	void Renderer::SetViewportAndScissor(VkCommandBuffer commandBuffer) {
 		VkViewport viewport{};
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
@@ -140,8 +214,29 @@ namespace Engine {
 
 		VkRect2D scissor{ { 0, 0 }, this->m_SwapChain->GetSwapChainExtent() };
 		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	}
+
+	void Renderer::RecordSwapChainRenderPass(VkCommandBuffer commandBuffer, CommandBufferKey& key, const std::function<void(VkCommandBuffer)>& record) {
+		this->BeginSwapChainRenderPass(commandBuffer, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass = this->m_SwapChain->GetRenderPass();
+		inheritanceInfo.subpass = 0;
+		inheritanceInfo.framebuffer = this->m_SwapChain->GetFrameBuffer(this->m_CurrentImageIndex);
+
+		// each image gets its own entry, a cached buffer is only reused once the image's last frame is done
+		key.Add(this->m_CurrentImageIndex);
+
+		VkCommandBuffer secondary = this->m_CommandBufferCache.GetOrRecord(key, inheritanceInfo, [&](VkCommandBuffer secondaryCommandBuffer) {
+			this->SetViewportAndScissor(secondaryCommandBuffer);
+			record(secondaryCommandBuffer);
+		});
+		vkCmdExecuteCommands(commandBuffer, 1, &secondary);
+
+		this->EndSwapChainRenderPass(commandBuffer);
 	}
+
 	void Renderer::EndSwapChainRenderPass(VkCommandBuffer commandBuffer) {
 		assert(this->m_IsFrameStarted && "Cannot end render pass when one is not in progress!");
 		assert(commandBuffer == this->GetCurrentCommandBuffer() && "Cannot end render pass with a command buffer that is not the current command buffer!");
@@ -3,7 +3,13 @@
 #include "../Engine/Window.hpp"
 #include "../Engine/Device.hpp"
 #include "../Engine/SwapChain.hpp"
+#include "../Engine/SubmitThread.hpp"
+#include "../Engine/CommandBufferCache.hpp"
+#include "../Engine/FrameRingBuffer.hpp"
+#include "../Engine/Descriptors.hpp"
+#include "../Engine/SpriteBatch.hpp"
 
+#include "../Engine/Utils/LinearArena.hpp"
 #include "../Engine/Utils/NonMoveable.hpp"
 #include "../Engine/Utils/NonCopyable.hpp"
 
@@ -11,6 +17,7 @@
 #include <memory>
 #include <vector>
 #include <cassert>
+#include <functional>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -26,11 +33,24 @@ namespace Engine {
 		~Renderer();
 
 		inline VkRenderPass GetSwapChainRenderPass() const { return this->m_SwapChain->GetRenderPass(); }
+		inline VkExtent2D GetSwapChainExtent() const { return this->m_SwapChain->GetSwapChainExtent(); }
 		inline bool IsFrameInProgress() const { return this->m_IsFrameStarted; }
 		inline VkCommandBuffer GetCurrentCommandBuffer() const {
 			assert(this->m_IsFrameStarted && "Cannot get current command buffer when frame is not in progress");
 			return this->m_CommandBuffers[this->m_CurrentFrameIndex];
 		}
+		// scratch memory that stays valid until the same frame slot comes around again
+		inline LinearArena& GetFrameArena() {
+			assert(this->m_IsFrameStarted && "Cannot get frame arena when frame is not in progress");
+			return *this->m_FrameArenas[this->m_CurrentFrameIndex];
+		}
+		// uniform / storage blocks for the current frame, bound through dynamic offsets
+		inline FrameRingBuffer& GetFrameRing() { return this->m_FrameRing; }
+		// null when the device lacks descriptor indexing
+		inline BindlessTable* GetBindlessTable() { return this->m_BindlessTable.get(); }
+		// created on first use, null without a bindless table. Its vertices change every frame, so draw it in an
+		// inline render pass rather than through RecordSwapChainRenderPass
+		SpriteBatch* GetSpriteBatch();
 		int GetCurrentFrameIndex() const {
 			assert(this->m_IsFrameStarted && "Cannot get current frame Index when frame is not in progress");
 			return this->m_CurrentFrameIndex;
@@ -39,21 +59,38 @@ namespace Engine {
 
 		VkCommandBuffer BeginFrame();
 		void EndFrame();
+		void WaitIdle();
 
-		void BeginSwapChainRenderPass(VkCommandBuffer);
+		void BeginSwapChainRenderPass(VkCommandBuffer, VkSubpassContents = VK_SUBPASS_CONTENTS_INLINE);
 		void EndSwapChainRenderPass(VkCommandBuffer);
 
+		// Records the whole swap chain render pass, replaying a cached secondary command buffer
+		// when the key (everything the callback draws) is unchanged for this image. The image index is appended to it.
+		void RecordSwapChainRenderPass(VkCommandBuffer, CommandBufferKey&, const std::function<void(VkCommandBuffer)>&);
+		inline const CommandBufferCache::Stats& GetCommandBufferCacheStats() const { return this->m_CommandBufferCache.GetStats(); }
+
 
 	private:
 		void CreateCommandBuffers();
 		void FreeCommandBuffers();
 		void RecreateSwapChain();
+		void SetViewportAndScissor(VkCommandBuffer);
 
 
 		Engine::Window& m_Window;
 		Engine::Device& m_Device;
 		std::unique_ptr <Engine::SwapChain> m_SwapChain;
 		std::vector<VkCommandBuffer> m_CommandBuffers;
+		// frame timeline value each command buffer was last submitted with
+		std::vector<uint64_t> m_CommandBufferTimelineValues;
+		Engine::CommandBufferCache m_CommandBufferCache;
+		std::vector<std::unique_ptr<LinearArena>> m_FrameArenas;
+		Engine::FrameRingBuffer m_FrameRing;
+		std::unique_ptr<BindlessTable> m_BindlessTable;
+		std::unique_ptr<SpriteBatch> m_SpriteBatch;
+
+		// declared after the swap chain so it is joined before the swap chain goes away
+		Engine::SubmitThread m_SubmitThread;
 
 		uint32_t m_CurrentImageIndex;
 		int m_CurrentFrameIndex;
@@ -0,0 +1,140 @@
+#include "./ResidencyManager.hpp"
+#include "./ModelCache.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <tuple>
+
+namespace Engine {
+	ResidencyManager::ResidencyManager(Device& device) : m_Device{ device } {}
+
+	ResidencyManager::~ResidencyManager() {
+		assert(this->m_Entries.size() == this->m_FreeHandles.size() && "Resources still registered with the residency manager");
+	}
+
+	ResidencyManager::Handle ResidencyManager::Register(VkDeviceSize bytes, Priority priority, std::function<VkDeviceSize()> downgrade) {
+		Handle handle;
+		if (!this->m_FreeHandles.empty()) {
+			handle = this->m_FreeHandles.back();
+			this->m_FreeHandles.pop_back();
+		}
+		else {
+			handle = static_cast<Handle>(this->m_Entries.size());
+			this->m_Entries.emplace_back();
+		}
+
+		Entry& entry = this->m_Entries[handle];
+		entry.Bytes = bytes;
+		entry.Priority = priority;
+		// counts as used right away, nothing is downgraded before it had a chance to be drawn
+		entry.LastUsedFrame = this->m_Frame;
+		entry.Downgrade = std::move(downgrade);
+		entry.Registered = true;
+		entry.Exhausted = false;
+
+		this->m_TrackedBytes += bytes;
+		return handle;
+	}
+
+	void ResidencyManager::Unregister(Handle handle) {
+		Entry& entry = this->m_Entries[handle];
+		assert(entry.Registered && "Resource isn't registered with the residency manager");
+
+		this->m_TrackedBytes -= entry.Bytes;
+		entry = Entry{};
+		this->m_FreeHandles.push_back(handle);
+	}
+
+	void ResidencyManager::Touch(Handle handle) {
+		this->m_Entries[handle].LastUsedFrame = this->m_Frame;
+	}
+
+	void ResidencyManager::SetPriority(Handle handle, Priority priority) {
+		this->m_Entries[handle].Priority = priority;
+	}
+
+	void ResidencyManager::SetSize(Handle handle, VkDeviceSize bytes) {
+		Entry& entry = this->m_Entries[handle];
+		this->m_TrackedBytes = this->m_TrackedBytes - entry.Bytes + bytes;
+		entry.Bytes = bytes;
+		entry.Exhausted = false;
+	}
+
+	void ResidencyManager::Update() {
+		this->m_Frame++;
+
+		Stats stats{};
+		stats.Frame = this->m_Frame;
+		stats.Budget = this->m_Device.QueryMemoryBudget();
+
+		// the slot being reused belongs to a frame that has completed, its memory is really gone by now
+		auto& reclaimedSlot = this->m_RecentlyReclaimed[this->m_Frame % MIN_IDLE_FRAMES];
+		reclaimedSlot = 0;
+		const VkDeviceSize pending = std::accumulate(this->m_RecentlyReclaimed.begin(), this->m_RecentlyReclaimed.end(), VkDeviceSize{ 0 });
+
+		VkDeviceSize usage = stats.Budget.Usage > pending ? stats.Budget.Usage - pending : 0;
+		usage = std::max(usage, this->m_TrackedBytes);
+		stats.Budget.Usage = usage;
+
+		const VkDeviceSize highWatermark = stats.Budget.Budget / 100 * HIGH_WATERMARK_PERCENT;
+		const VkDeviceSize lowWatermark = stats.Budget.Budget / 100 * LOW_WATERMARK_PERCENT;
+		if (usage > highWatermark) {
+			this->m_Stats = stats;
+			reclaimedSlot = this->Reclaim(usage - lowWatermark);
+			stats = this->m_Stats;
+		}
+
+		stats.TrackedBytes = this->m_TrackedBytes;
+		stats.Resources = static_cast<uint32_t>(this->m_Entries.size() - this->m_FreeHandles.size());
+		this->m_Stats = stats;
+	}
+
+	VkDeviceSize ResidencyManager::Reclaim(VkDeviceSize target) {
+		// models nothing references anymore only sit in the cache for reuse, they go before anything visible loses
+		// detail; just enough of them to cover the target, the rest may still be asked for again
+		VkDeviceSize trackedBefore = this->m_TrackedBytes;
+		ModelCache& modelCache = this->m_Device.GetModelCache();
+		const uint64_t evictionsBefore = modelCache.GetStats().Evictions;
+		const VkDeviceSize cached = modelCache.GetResidentBytes();
+		modelCache.Evict(cached > target ? cached - target : 0);
+
+		this->m_Stats.Evictions += static_cast<uint32_t>(modelCache.GetStats().Evictions - evictionsBefore);
+		VkDeviceSize reclaimed = trackedBefore - this->m_TrackedBytes;
+
+		std::vector<std::tuple<Priority, uint64_t, Handle>> candidates;
+		for (Handle handle = 0; handle < this->m_Entries.size(); handle++) {
+			const Entry& entry = this->m_Entries[handle];
+			if (!entry.Registered || entry.Exhausted || !entry.Downgrade || entry.Priority == Priority::Pinned) continue;
+			if (this->m_Frame - entry.LastUsedFrame < MIN_IDLE_FRAMES) continue;
+			candidates.emplace_back(entry.Priority, entry.LastUsedFrame, handle);
+		}
+		std::sort(candidates.begin(), candidates.end());
+
+		for (const auto& candidate : candidates) {
+			if (reclaimed >= target || this->m_Stats.Downgrades >= MAX_DOWNGRADES_PER_FRAME) break;
+
+			// the callback may register other resources and grow the entries, so it runs from a copy and the entry
+			// is looked up again afterwards
+			const Handle handle = std::get<2>(candidate);
+			const VkDeviceSize bytesBefore = this->m_Entries[handle].Bytes;
+			const auto downgrade = this->m_Entries[handle].Downgrade;
+			const VkDeviceSize bytesAfter = downgrade();
+
+			Entry& entry = this->m_Entries[handle];
+			if (bytesAfter >= bytesBefore) {
+				entry.Exhausted = true;
+				continue;
+			}
+
+			this->m_TrackedBytes -= bytesBefore - bytesAfter;
+			entry.Bytes = bytesAfter;
+			reclaimed += bytesBefore - bytesAfter;
+			this->m_Stats.Downgrades++;
+		}
+
+		this->m_Stats.ReclaimedBytes = reclaimed;
+		return reclaimed;
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "./Device.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Engine {
+
+	// Keeps the device memory held by models and textures under the budget the driver reports. Resources register
+	// with a priority and are touched whenever they're drawn. Once usage gets close to the budget, unreferenced models
+	// in the model cache are evicted first, then the least recently used, lowest priority resources are asked to drop
+	// detail (a model its finest LOD, a texture its top mip). Like the caches it's only used from the render thread.
+	class ResidencyManager : public NonMoveable, public NonCopyable {
+	public:
+		enum class Priority { Low, Normal, High, Pinned };
+
+		using Handle = uint32_t;
+		static constexpr Handle INVALID_HANDLE = UINT32_MAX;
+
+		// reclaiming starts above the high mark and goes on until usage is back under the low one
+		static constexpr VkDeviceSize HIGH_WATERMARK_PERCENT = 90;
+		static constexpr VkDeviceSize LOW_WATERMARK_PERCENT = 80;
+		// anything drawn more recently is left alone, and memory given back is only freed after this many frames
+		static constexpr uint64_t MIN_IDLE_FRAMES = 3;
+		// every downgrade records a GPU copy, the rest waits for the next frame
+		static constexpr uint32_t MAX_DOWNGRADES_PER_FRAME = 8;
+
+		struct Stats {
+			uint64_t Frame = 0;
+			// as reported by the device, usage is the tracked bytes when the device can't report it
+			MemoryBudget Budget;
+			VkDeviceSize TrackedBytes = 0;
+			uint32_t Resources = 0;
+			uint32_t Evictions = 0;
+			uint32_t Downgrades = 0;
+			VkDeviceSize ReclaimedBytes = 0;
+		};
+
+		ResidencyManager(Device&);
+		~ResidencyManager();
+
+		// the callback drops one step of detail and returns the bytes the resource holds afterwards, returning the
+		// same size tells the manager there's nothing left to drop
+		Handle Register(VkDeviceSize, Priority, std::function<VkDeviceSize()>);
+		void Unregister(Handle);
+
+		void Touch(Handle);
+		void SetPriority(Handle, Priority);
+		// for resources whose size changes other than through the callback
+		void SetSize(Handle, VkDeviceSize);
+
+		// once per frame before recording, queries the budget and reclaims memory when usage gets close to it
+		void Update();
+
+		inline const Stats& GetFrameStats() const { return this->m_Stats; }
+		inline uint64_t GetFrame() const { return this->m_Frame; }
+		inline VkDeviceSize GetTrackedBytes() const { return this->m_TrackedBytes; }
+
+	private:
+		struct Entry {
+			VkDeviceSize Bytes = 0;
+			ResidencyManager::Priority Priority = ResidencyManager::Priority::Normal;
+			uint64_t LastUsedFrame = 0;
+			std::function<VkDeviceSize()> Downgrade;
+			bool Registered = false;
+			// the last downgrade had nothing left to drop
+			bool Exhausted = false;
+		};
+
+		VkDeviceSize Reclaim(VkDeviceSize);
+
+		Device& m_Device;
+
+		std::vector<Entry> m_Entries;
+		std::vector<Handle> m_FreeHandles;
+		VkDeviceSize m_TrackedBytes = 0;
+
+		// memory given back in the last few frames is only freed once they complete, the driver still counts it
+		std::array<VkDeviceSize, MIN_IDLE_FRAMES> m_RecentlyReclaimed{};
+		uint64_t m_Frame = 0;
+
+		Stats m_Stats;
+	};
+}
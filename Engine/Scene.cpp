@@ -0,0 +1,52 @@
+#include "./Scene.hpp"
+#include "./ModelCache.hpp"
+
+// std lib headers
+#include <stdexcept>
+
+namespace Engine {
+	static_assert(sizeof(Model::Vertex) == sizeof(float) * 5, "Model::Vertex must match SCENE_VERTEX_FORMAT_POSITION2_COLOR3");
+
+	Scene::Scene(Device& device, const std::string& filePath)
+		: m_Device{ device }, m_Archive{ filePath }, m_Models(m_Archive.GetMeshCount()) {}
+
+	std::shared_ptr<Model> Scene::GetModel(uint32_t meshIndex) {
+		if (meshIndex >= this->m_Models.size()) {
+			throw std::runtime_error("scene mesh index out of range!");
+		}
+
+		auto& model = this->m_Models[meshIndex];
+		if (model) return model;
+
+		const auto& mesh = this->m_Archive.GetMesh(meshIndex);
+		if (mesh.VertexFormat != SCENE_VERTEX_FORMAT_POSITION2_COLOR3 || mesh.VertexStride != sizeof(Model::Vertex)) {
+			throw std::runtime_error("unsupported scene mesh vertex format!");
+		}
+
+		// the mapped blobs go to staging as they are, nothing is parsed or converted; meshes some other scene
+		// (or this one) already uploaded come back from the cache instead
+		model = this->m_Device.GetModelCache().GetOrCreate(
+			static_cast<const Model::Vertex*>(this->m_Archive.GetVertexData(mesh)), mesh.VertexCount,
+			mesh.IndexCount > 0 ? this->m_Archive.GetIndexData(mesh) : nullptr, mesh.IndexCount,
+			mesh.IndexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+		return model;
+	}
+
+	void Scene::CreateGameObjects(std::vector<GameObject>& gameObjects) {
+		const uint32_t objectCount = this->m_Archive.GetObjectCount();
+		gameObjects.reserve(gameObjects.size() + objectCount);
+
+		for (uint32_t i = 0; i < objectCount; i++) {
+			const auto& entry = this->m_Archive.GetObject(i);
+
+			auto gameObject = GameObject::CreateGameObject();
+			gameObject.Model = this->GetModel(entry.MeshIndex);
+			gameObject.Color = { entry.Color[0], entry.Color[1], entry.Color[2] };
+			gameObject.Transform.Translation = { entry.Translation[0], entry.Translation[1] };
+			gameObject.Transform.Scale = { entry.Scale[0], entry.Scale[1] };
+			gameObject.Transform.Rotation = entry.Rotation;
+
+			gameObjects.push_back(std::move(gameObject));
+		}
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./GameObject.hpp"
+#include "./Model.hpp"
+
+#include "./Utils/SceneArchive.hpp"
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Engine {
+	// Scene loaded from a binary scene archive. Opening maps the file and reads the object table only,
+	// a mesh is uploaded from the mapping the first time something asks for its model.
+	class Scene : public NonMoveable, public NonCopyable {
+	public:
+		Scene(Device&, const std::string&);
+
+		// uploads the mesh on first use, later calls share the same model
+		std::shared_ptr<Model> GetModel(uint32_t);
+		// one game object per object table entry, uploading the meshes they reference
+		void CreateGameObjects(std::vector<GameObject>&);
+
+		inline uint32_t GetMeshCount() const { return this->m_Archive.GetMeshCount(); }
+		inline uint32_t GetObjectCount() const { return this->m_Archive.GetObjectCount(); }
+		inline const SceneArchive& GetArchive() const { return this->m_Archive; }
+
+	private:
+		Device& m_Device;
+		SceneArchive m_Archive;
+		std::vector<std::shared_ptr<Model>> m_Models;
+	};
+}
@@ -0,0 +1,519 @@
+#include "./ShaderReflection.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace Engine {
+	namespace {
+		// the handful of SPIR-V enumerants reflection needs, values from the SPIR-V specification
+		constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+		constexpr size_t SPIRV_HEADER_WORDS = 5;
+
+		enum Op : uint32_t {
+			OpName = 5,
+			OpEntryPoint = 15,
+			OpTypeBool = 20,
+			OpTypeInt = 21,
+			OpTypeFloat = 22,
+			OpTypeVector = 23,
+			OpTypeMatrix = 24,
+			OpTypeImage = 25,
+			OpTypeSampler = 26,
+			OpTypeSampledImage = 27,
+			OpTypeArray = 28,
+			OpTypeRuntimeArray = 29,
+			OpTypeStruct = 30,
+			OpTypePointer = 32,
+			OpConstant = 43,
+			OpVariable = 59,
+			OpDecorate = 71,
+			OpMemberDecorate = 72,
+		};
+
+		enum Decoration : uint32_t {
+			DecorationBlock = 2,
+			DecorationBufferBlock = 3,
+			DecorationArrayStride = 6,
+			DecorationMatrixStride = 7,
+			DecorationBuiltIn = 11,
+			DecorationLocation = 30,
+			DecorationBinding = 33,
+			DecorationDescriptorSet = 34,
+			DecorationOffset = 35,
+		};
+
+		enum StorageClass : uint32_t {
+			StorageClassUniformConstant = 0,
+			StorageClassInput = 1,
+			StorageClassUniform = 2,
+			StorageClassPushConstant = 9,
+			StorageClassStorageBuffer = 12,
+		};
+
+		constexpr uint32_t DIM_BUFFER = 5;
+		constexpr uint32_t DIM_SUBPASS_DATA = 6;
+
+		struct Type {
+			uint32_t Opcode = 0;
+			// scalar bit width, component / column / array length, element type
+			uint32_t Width = 0;
+			uint32_t Length = 0;
+			uint32_t ElementType = 0;
+			uint32_t ArrayStride = 0;
+			// images
+			uint32_t Dim = 0;
+			uint32_t Sampled = 0;
+			// structs
+			std::vector<uint32_t> Members;
+			std::vector<uint32_t> MemberOffsets;
+			std::vector<uint32_t> MemberMatrixStrides;
+			bool Block = false;
+			bool BufferBlock = false;
+		};
+
+		struct Variable {
+			uint32_t Type = 0;
+			uint32_t StorageClass = 0;
+		};
+
+		struct Decorations {
+			uint32_t Set = 0;
+			uint32_t Binding = 0;
+			uint32_t Location = UINT32_MAX;
+			bool HasBinding = false;
+			bool BuiltIn = false;
+		};
+
+		class Parser {
+		public:
+			Parser(const uint32_t* code, size_t wordCount) {
+				if (wordCount < SPIRV_HEADER_WORDS || code[0] != SPIRV_MAGIC) {
+					throw std::runtime_error("Not a SPIR-V module!");
+				}
+
+				for (size_t i = SPIRV_HEADER_WORDS; i < wordCount;) {
+					const uint32_t opcode = code[i] & 0xffff;
+					const uint32_t count = code[i] >> 16;
+					if (count == 0 || i + count > wordCount) {
+						throw std::runtime_error("Malformed SPIR-V instruction stream!");
+					}
+					this->Parse(opcode, code + i + 1, count - 1);
+					i += count;
+				}
+			}
+
+			ShaderInterface BuildInterface() {
+				ShaderInterface shaderInterface{};
+				shaderInterface.Stages = this->m_Stage;
+				uint32_t pushConstantBegin = UINT32_MAX, pushConstantEnd = 0;
+
+				for (auto& idAndVariable : this->m_Variables) {
+					const uint32_t id = idAndVariable.first;
+					const Variable& variable = idAndVariable.second;
+					const Decorations& decorations = this->m_Decorations[id];
+					const uint32_t typeId = this->m_Types[variable.Type].ElementType;
+
+					if (variable.StorageClass == StorageClassPushConstant) {
+						const Type& block = this->m_Types[typeId];
+						for (size_t m = 0; m < block.Members.size(); m++) {
+							pushConstantBegin = std::min(pushConstantBegin, block.MemberOffsets[m]);
+						}
+						pushConstantEnd = std::max(pushConstantEnd, this->SizeOf(typeId));
+					}
+					else if (variable.StorageClass == StorageClassInput) {
+						if (this->m_Stage != VK_SHADER_STAGE_VERTEX_BIT || decorations.BuiltIn || decorations.Location == UINT32_MAX) continue;
+						shaderInterface.VertexInputs.push_back({ decorations.Location, this->FormatOf(typeId), this->m_Names[id] });
+					}
+					else if (decorations.HasBinding) {
+						shaderInterface.Bindings.push_back(this->ReflectBinding(id, variable, typeId, decorations));
+					}
+				}
+
+				if (pushConstantEnd > 0) {
+					shaderInterface.PushConstantRanges.push_back({ this->m_Stage, pushConstantBegin, pushConstantEnd - pushConstantBegin });
+				}
+
+				std::sort(shaderInterface.Bindings.begin(), shaderInterface.Bindings.end(), [](const ReflectedBinding& a, const ReflectedBinding& b) {
+					return a.Set != b.Set ? a.Set < b.Set : a.Binding < b.Binding;
+				});
+				std::sort(shaderInterface.VertexInputs.begin(), shaderInterface.VertexInputs.end(), [](const ReflectedVertexInput& a, const ReflectedVertexInput& b) {
+					return a.Location < b.Location;
+				});
+				return shaderInterface;
+			}
+
+		private:
+			void Parse(uint32_t opcode, const uint32_t* operands, uint32_t count) {
+				switch (opcode) {
+				case OpEntryPoint:
+					this->m_Stage = StageOf(operands[0]);
+					break;
+				case OpName:
+					if (count >= 2) this->m_Names[operands[0]] = reinterpret_cast<const char*>(operands + 1);
+					break;
+				case OpTypeBool:
+				case OpTypeSampler:
+					this->m_Types[operands[0]].Opcode = opcode;
+					break;
+				case OpTypeInt:
+				case OpTypeFloat:
+					this->m_Types[operands[0]].Opcode = opcode;
+					this->m_Types[operands[0]].Width = operands[1];
+					break;
+				case OpTypeVector:
+				case OpTypeMatrix: {
+					Type& type = this->m_Types[operands[0]];
+					type.Opcode = opcode;
+					type.ElementType = operands[1];
+					type.Length = operands[2];
+					break;
+				}
+				case OpTypeImage: {
+					Type& type = this->m_Types[operands[0]];
+					type.Opcode = opcode;
+					type.Dim = operands[2];
+					type.Sampled = operands[6];
+					break;
+				}
+				case OpTypeSampledImage:
+				case OpTypeRuntimeArray:
+					this->m_Types[operands[0]].Opcode = opcode;
+					this->m_Types[operands[0]].ElementType = operands[1];
+					break;
+				case OpTypeArray: {
+					Type& type = this->m_Types[operands[0]];
+					type.Opcode = opcode;
+					type.ElementType = operands[1];
+					// resolved once all constants are known, array lengths are always constant ids
+					type.Length = operands[2];
+					break;
+				}
+				case OpTypeStruct: {
+					Type& type = this->m_Types[operands[0]];
+					type.Opcode = opcode;
+					type.Members.assign(operands + 1, operands + count);
+					type.MemberOffsets.resize(type.Members.size(), 0);
+					type.MemberMatrixStrides.resize(type.Members.size(), 0);
+					break;
+				}
+				case OpTypePointer:
+					this->m_Types[operands[0]].Opcode = opcode;
+					this->m_Types[operands[0]].ElementType = operands[2];
+					break;
+				case OpConstant:
+					// only 32 bit integers matter here (array lengths)
+					this->m_Constants[operands[1]] = operands[2];
+					break;
+				case OpVariable:
+					this->m_Variables[operands[1]] = { operands[0], operands[2] };
+					break;
+				case OpDecorate:
+					this->Decorate(operands[0], operands[1], count > 2 ? operands[2] : 0);
+					break;
+				case OpMemberDecorate: {
+					Type& type = this->m_Types[operands[0]];
+					const uint32_t member = operands[1];
+					if (type.MemberOffsets.size() <= member) {
+						type.MemberOffsets.resize(member + 1, 0);
+						type.MemberMatrixStrides.resize(member + 1, 0);
+					}
+					if (operands[2] == DecorationOffset) type.MemberOffsets[member] = operands[3];
+					if (operands[2] == DecorationMatrixStride) type.MemberMatrixStrides[member] = operands[3];
+					break;
+				}
+				default:
+					break;
+				}
+			}
+
+			void Decorate(uint32_t id, uint32_t decoration, uint32_t value) {
+				switch (decoration) {
+				case DecorationBlock: this->m_Types[id].Block = true; break;
+				case DecorationBufferBlock: this->m_Types[id].BufferBlock = true; break;
+				case DecorationArrayStride: this->m_Types[id].ArrayStride = value; break;
+				case DecorationBuiltIn: this->m_Decorations[id].BuiltIn = true; break;
+				case DecorationLocation: this->m_Decorations[id].Location = value; break;
+				case DecorationDescriptorSet: this->m_Decorations[id].Set = value; break;
+				case DecorationBinding:
+					this->m_Decorations[id].Binding = value;
+					this->m_Decorations[id].HasBinding = true;
+					break;
+				default: break;
+				}
+			}
+
+			ReflectedBinding ReflectBinding(uint32_t id, const Variable& variable, uint32_t typeId, const Decorations& decorations) {
+				ReflectedBinding binding{};
+				binding.Set = decorations.Set;
+				binding.Binding = decorations.Binding;
+				binding.Stages = this->m_Stage;
+				binding.Name = this->m_Names[id];
+
+				// arrays of descriptors
+				const Type* type = &this->m_Types[typeId];
+				if (type->Opcode == OpTypeArray) {
+					binding.Count = this->m_Constants[type->Length];
+					typeId = type->ElementType;
+				}
+				else if (type->Opcode == OpTypeRuntimeArray) {
+					binding.Count = 0;
+					typeId = type->ElementType;
+				}
+				type = &this->m_Types[typeId];
+
+				if (type->Opcode == OpTypeStruct) {
+					const bool storage = variable.StorageClass == StorageClassStorageBuffer || type->BufferBlock;
+					binding.Type = storage ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+					binding.BlockSize = this->SizeOf(typeId);
+
+					// a trailing runtime array is sized by the buffer, report its stride instead
+					if (!type->Members.empty() && this->m_Types[type->Members.back()].Opcode == OpTypeRuntimeArray) {
+						binding.ArrayStride = this->m_Types[type->Members.back()].ArrayStride;
+						binding.BlockSize = type->MemberOffsets.back();
+					}
+				}
+				else if (type->Opcode == OpTypeSampledImage) {
+					binding.Type = this->m_Types[type->ElementType].Dim == DIM_BUFFER ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				}
+				else if (type->Opcode == OpTypeImage) {
+					if (type->Dim == DIM_SUBPASS_DATA) binding.Type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+					else if (type->Dim == DIM_BUFFER) binding.Type = type->Sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+					else binding.Type = type->Sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+				}
+				else if (type->Opcode == OpTypeSampler) {
+					binding.Type = VK_DESCRIPTOR_TYPE_SAMPLER;
+				}
+				else {
+					throw std::runtime_error("Unsupported descriptor type in shader: " + binding.Name);
+				}
+
+				return binding;
+			}
+
+			uint32_t SizeOf(uint32_t typeId, uint32_t matrixStride = 0) {
+				const Type& type = this->m_Types[typeId];
+				switch (type.Opcode) {
+				case OpTypeBool: return 4;
+				case OpTypeInt:
+				case OpTypeFloat: return type.Width / 8;
+				case OpTypeVector: return type.Length * this->SizeOf(type.ElementType);
+				case OpTypeMatrix: return type.Length * (matrixStride != 0 ? matrixStride : this->SizeOf(type.ElementType));
+				case OpTypeArray: {
+					const uint32_t length = this->m_Constants[type.Length];
+					return length * (type.ArrayStride != 0 ? type.ArrayStride : this->SizeOf(type.ElementType));
+				}
+				case OpTypeRuntimeArray: return 0;
+				case OpTypeStruct: {
+					uint32_t size = 0;
+					for (size_t m = 0; m < type.Members.size(); m++) {
+						size = std::max(size, type.MemberOffsets[m] + this->SizeOf(type.Members[m], type.MemberMatrixStrides[m]));
+					}
+					return size;
+				}
+				default: return 0;
+				}
+			}
+
+			VkFormat FormatOf(uint32_t typeId) {
+				const Type& type = this->m_Types[typeId];
+				const uint32_t components = type.Opcode == OpTypeVector ? type.Length : 1;
+				const Type& scalar = type.Opcode == OpTypeVector ? this->m_Types[type.ElementType] : type;
+
+				static const VkFormat floatFormats[] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+				static const VkFormat intFormats[] = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+				if (components < 1 || components > 4 || scalar.Width != 32) return VK_FORMAT_UNDEFINED;
+				if (scalar.Opcode == OpTypeFloat) return floatFormats[components - 1];
+				if (scalar.Opcode == OpTypeInt) return intFormats[components - 1];
+				return VK_FORMAT_UNDEFINED;
+			}
+
+			static VkShaderStageFlagBits StageOf(uint32_t executionModel) {
+				switch (executionModel) {
+				case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+				case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+				case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+				case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+				case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+				case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+				default: throw std::runtime_error("Unsupported shader execution model!");
+				}
+			}
+
+			VkShaderStageFlagBits m_Stage = VK_SHADER_STAGE_VERTEX_BIT;
+			std::unordered_map<uint32_t, Type> m_Types;
+			std::unordered_map<uint32_t, Variable> m_Variables;
+			std::unordered_map<uint32_t, Decorations> m_Decorations;
+			std::unordered_map<uint32_t, uint32_t> m_Constants;
+			std::unordered_map<uint32_t, std::string> m_Names;
+		};
+	}
+
+	ShaderInterface ShaderInterface::Reflect(const uint32_t* code, size_t wordCount) {
+		return Parser{ code, wordCount }.BuildInterface();
+	}
+
+	ShaderInterface ShaderInterface::Merge(const std::vector<const ShaderInterface*>& stages) {
+		ShaderInterface merged{};
+
+		for (const ShaderInterface* stage : stages) {
+			merged.Stages |= stage->Stages;
+
+			for (const auto& binding : stage->Bindings) {
+				auto existing = std::find_if(merged.Bindings.begin(), merged.Bindings.end(), [&](const ReflectedBinding& other) {
+					return other.Set == binding.Set && other.Binding == binding.Binding;
+				});
+				if (existing == merged.Bindings.end()) {
+					merged.Bindings.push_back(binding);
+					continue;
+				}
+				if (existing->Type != binding.Type || existing->Count != binding.Count) {
+					throw std::runtime_error("Shader stages disagree on set " + std::to_string(binding.Set) + " binding " + std::to_string(binding.Binding));
+				}
+				existing->Stages |= binding.Stages;
+				existing->BlockSize = std::max(existing->BlockSize, binding.BlockSize);
+			}
+
+			// a single range visible to every stage using push constants keeps layouts simple and compatible
+			for (const auto& range : stage->PushConstantRanges) {
+				if (merged.PushConstantRanges.empty()) {
+					merged.PushConstantRanges.push_back(range);
+					continue;
+				}
+				auto& mergedRange = merged.PushConstantRanges.front();
+				const uint32_t end = std::max(mergedRange.offset + mergedRange.size, range.offset + range.size);
+				mergedRange.offset = std::min(mergedRange.offset, range.offset);
+				mergedRange.size = end - mergedRange.offset;
+			}
+			for (const auto& range : stage->PushConstantRanges) {
+				merged.PushConstantRanges.front().stageFlags |= range.stageFlags;
+			}
+
+			if (stage->Stages & VK_SHADER_STAGE_VERTEX_BIT) {
+				merged.VertexInputs = stage->VertexInputs;
+			}
+		}
+
+		std::sort(merged.Bindings.begin(), merged.Bindings.end(), [](const ReflectedBinding& a, const ReflectedBinding& b) {
+			return a.Set != b.Set ? a.Set < b.Set : a.Binding < b.Binding;
+		});
+		return merged;
+	}
+
+	const ReflectedBinding* ShaderInterface::FindBinding(uint32_t set, uint32_t binding) const {
+		for (const auto& reflected : this->Bindings) {
+			if (reflected.Set == set && reflected.Binding == binding) return &reflected;
+		}
+		return nullptr;
+	}
+
+	uint32_t ShaderInterface::GetSetCount() const {
+		return this->Bindings.empty() ? 0 : this->Bindings.back().Set + 1;
+	}
+
+	void ShaderInterface::AppendKey(std::vector<uint64_t>& key) const {
+		// names are left out on purpose, systems with the same interface share a layout whatever they call things
+		key.push_back(this->Stages);
+		key.push_back(this->Bindings.size());
+		for (const auto& binding : this->Bindings) {
+			key.push_back(binding.Set);
+			key.push_back(binding.Binding);
+			key.push_back(binding.Type);
+			key.push_back(binding.Count);
+			key.push_back(binding.Stages);
+			// not part of the layout, but callers validate their C++ mirrors against the cached interface
+			key.push_back(binding.BlockSize);
+			key.push_back(binding.ArrayStride);
+		}
+		key.push_back(this->PushConstantRanges.size());
+		for (const auto& range : this->PushConstantRanges) {
+			key.push_back(range.stageFlags);
+			key.push_back(range.offset);
+			key.push_back(range.size);
+		}
+		key.push_back(this->VertexInputs.size());
+		for (const auto& input : this->VertexInputs) {
+			key.push_back(input.Location);
+			key.push_back(input.Format);
+		}
+	}
+
+	void ShaderInterface::ValidateBlockSize(uint32_t set, uint32_t binding, size_t size, const char* typeName) const {
+		const ReflectedBinding* reflected = this->FindBinding(set, binding);
+		if (reflected == nullptr) {
+			throw std::runtime_error(std::string(typeName) + ": shaders have no block at set " + std::to_string(set) + " binding " + std::to_string(binding));
+		}
+		// C++ may round the struct up to its alignment, anything beyond that means the layouts drifted apart
+		const size_t paddedSize = (static_cast<size_t>(reflected->BlockSize) + 15) / 16 * 16;
+		if (size < reflected->BlockSize || size > paddedSize) {
+			throw std::runtime_error(std::string(typeName) + " is " + std::to_string(size) + " bytes but block " + reflected->Name +
+				" is " + std::to_string(reflected->BlockSize) + " bytes");
+		}
+	}
+
+	void ShaderInterface::ValidateArrayStride(uint32_t set, uint32_t binding, size_t stride, const char* typeName) const {
+		const ReflectedBinding* reflected = this->FindBinding(set, binding);
+		if (reflected == nullptr || reflected->ArrayStride == 0) {
+			throw std::runtime_error(std::string(typeName) + ": shaders have no runtime array at set " + std::to_string(set) + " binding " + std::to_string(binding));
+		}
+		if (stride != reflected->ArrayStride) {
+			throw std::runtime_error(std::string(typeName) + " is " + std::to_string(stride) + " bytes but elements of " + reflected->Name +
+				" are " + std::to_string(reflected->ArrayStride) + " bytes apart");
+		}
+	}
+
+	void ShaderInterface::ValidatePushConstantSize(size_t size, const char* typeName) const {
+		const uint32_t reflectedSize = this->PushConstantRanges.empty() ? 0 : this->PushConstantRanges.front().offset + this->PushConstantRanges.front().size;
+		const size_t paddedSize = (static_cast<size_t>(reflectedSize) + 15) / 16 * 16;
+		if (size < reflectedSize || size > paddedSize) {
+			throw std::runtime_error(std::string(typeName) + " is " + std::to_string(size) + " bytes but the push constant block is " +
+				std::to_string(reflectedSize) + " bytes");
+		}
+	}
+
+	// what a vertex attribute looks like to the shader, normalized and half formats read as floats
+	// and reflection doesn't keep integer signedness apart
+	static VkFormat GetShaderVisibleFormat(VkFormat format) {
+		switch (format) {
+		case VK_FORMAT_R32_UINT: return VK_FORMAT_R32_SINT;
+		case VK_FORMAT_R32G32_UINT: return VK_FORMAT_R32G32_SINT;
+		case VK_FORMAT_R32G32B32_UINT: return VK_FORMAT_R32G32B32_SINT;
+		case VK_FORMAT_R32G32B32A32_UINT: return VK_FORMAT_R32G32B32A32_SINT;
+
+		case VK_FORMAT_R8G8_UNORM:
+		case VK_FORMAT_R8G8_SNORM:
+		case VK_FORMAT_R16G16_UNORM:
+		case VK_FORMAT_R16G16_SNORM:
+		case VK_FORMAT_R16G16_SFLOAT:
+			return VK_FORMAT_R32G32_SFLOAT;
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+		case VK_FORMAT_R16G16B16A16_UNORM:
+		case VK_FORMAT_R16G16B16A16_SNORM:
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+			return VK_FORMAT_R32G32B32A32_SFLOAT;
+
+		default:
+			return format;
+		}
+	}
+
+	void ShaderInterface::ValidateVertexInputs(const VkVertexInputAttributeDescription* attributes, size_t attributeCount) const {
+		for (const auto& input : this->VertexInputs) {
+			const VkVertexInputAttributeDescription* match = nullptr;
+			for (size_t i = 0; i < attributeCount; i++) {
+				if (attributes[i].location == input.Location) match = &attributes[i];
+			}
+			if (match == nullptr) {
+				throw std::runtime_error("Vertex input " + input.Name + " at location " + std::to_string(input.Location) + " has no vertex attribute");
+			}
+			if (input.Format != VK_FORMAT_UNDEFINED && GetShaderVisibleFormat(match->format) != input.Format) {
+				throw std::runtime_error("Vertex input " + input.Name + " at location " + std::to_string(input.Location) + " doesn't match the vertex attribute format");
+			}
+		}
+	}
+}
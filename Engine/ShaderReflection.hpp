@@ -0,0 +1,58 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+// std lib headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+	struct ReflectedBinding {
+		uint32_t Set = 0;
+		uint32_t Binding = 0;
+		VkDescriptorType Type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+		// 0 for runtime sized descriptor arrays
+		uint32_t Count = 1;
+		VkShaderStageFlags Stages = 0;
+		// buffers only: size of the block without a trailing runtime array, and that array's stride
+		uint32_t BlockSize = 0;
+		uint32_t ArrayStride = 0;
+		std::string Name;
+	};
+
+	struct ReflectedVertexInput {
+		uint32_t Location;
+		VkFormat Format;
+		std::string Name;
+	};
+
+	// Resource interface of one or more shader stages, read straight from SPIR-V.
+	struct ShaderInterface {
+		VkShaderStageFlags Stages = 0;
+		// sorted by set, then binding
+		std::vector<ReflectedBinding> Bindings;
+		// one range covering every stage's push constant block, empty without push constants
+		std::vector<VkPushConstantRange> PushConstantRanges;
+		// vertex stage only, sorted by location
+		std::vector<ReflectedVertexInput> VertexInputs;
+
+		static ShaderInterface Reflect(const uint32_t*, size_t);
+		// combines the interfaces of stages that make up one pipeline, throws if they disagree on a binding
+		static ShaderInterface Merge(const std::vector<const ShaderInterface*>&);
+
+		const ReflectedBinding* FindBinding(uint32_t, uint32_t) const;
+		uint32_t GetSetCount() const;
+		// appends everything but the names as key words, see AppendKeyBytes
+		void AppendKey(std::vector<uint64_t>&) const;
+
+		// startup checks that C++ mirrors of shader blocks still match, they throw with a description of the mismatch
+		void ValidateBlockSize(uint32_t, uint32_t, size_t, const char*) const;
+		void ValidateArrayStride(uint32_t, uint32_t, size_t, const char*) const;
+		void ValidatePushConstantSize(size_t, const char*) const;
+		void ValidateVertexInputs(const VkVertexInputAttributeDescription*, size_t) const;
+	};
+}
@@ -0,0 +1,163 @@
+#include "./ShaderRegistry.hpp"
+#include "./Utils/Hash.hpp"
+#include "./Utils/MappedFile.hpp"
+
+// std lib headers
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace Engine {
+	// ShaderModule
+
+	ShaderModule::ShaderModule(VkDevice device, const void* code, size_t codeSize, uint64_t contentHash)
+		: m_Device{ device }, m_ContentHash{ contentHash },
+		m_Code(static_cast<const uint32_t*>(code), static_cast<const uint32_t*>(code) + codeSize / sizeof(uint32_t)) {
+		VkShaderModuleCreateInfo createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		createInfo.codeSize = codeSize;
+		createInfo.pCode = static_cast<const uint32_t*>(code);
+
+		if (vkCreateShaderModule(this->m_Device, &createInfo, nullptr, &this->m_Module) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create shader module!");
+		}
+	}
+
+	ShaderModule::~ShaderModule() {
+		// pipelines don't reference their modules after creation, no need to defer
+		vkDestroyShaderModule(this->m_Device, this->m_Module, nullptr);
+	}
+
+	bool ShaderModule::HasCode(const void* code, size_t codeSize) const {
+		return codeSize == this->m_Code.size() * sizeof(uint32_t) && std::memcmp(code, this->m_Code.data(), codeSize) == 0;
+	}
+
+	// ShaderRegistry::Lease
+
+	ShaderRegistry::Lease::Lease(ShaderRegistry& registry, const std::string& shaderName) : m_Registry{ &registry }, m_ShaderName{ shaderName } {
+		this->m_Registry->Retain(this->m_ShaderName);
+	}
+
+	ShaderRegistry::Lease::~Lease() {
+		if (this->m_Registry != nullptr) {
+			this->m_Registry->Release(this->m_ShaderName);
+		}
+	}
+
+	ShaderRegistry::Lease::Lease(Lease&& other) noexcept
+		: m_Registry{ std::exchange(other.m_Registry, nullptr) }, m_ShaderName{ std::move(other.m_ShaderName) } {}
+
+	ShaderRegistry::Lease& ShaderRegistry::Lease::operator=(Lease&& other) noexcept {
+		if (this != &other) {
+			if (this->m_Registry != nullptr) {
+				this->m_Registry->Release(this->m_ShaderName);
+			}
+			this->m_Registry = std::exchange(other.m_Registry, nullptr);
+			this->m_ShaderName = std::move(other.m_ShaderName);
+		}
+		return *this;
+	}
+
+	// ShaderRegistry
+
+	ShaderRegistry::ShaderRegistry(VkDevice device, const std::string& archivePath) : m_Device{ device } {
+		if (::access(archivePath.c_str(), R_OK) == 0) {
+			this->m_Archive = ShaderArchive{ archivePath };
+		}
+	}
+
+	std::shared_ptr<ShaderModule> ShaderRegistry::Acquire(const std::string& shaderName) {
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+
+		NameEntry& entry = this->m_Names[shaderName];
+		if (auto module = entry.Module.lock()) {
+			return module;
+		}
+
+		std::shared_ptr<ShaderModule> module;
+		if (const ShaderArchiveEntry* archived = this->m_Archive.Find(shaderName)) {
+			this->m_Stats.ArchiveLookups++;
+			// blobs are aligned inside the mapping and their hash was computed when packing
+			module = this->FindOrCreateModule(this->m_Archive.GetData(*archived), archived->DataSize, archived->ContentHash);
+		}
+		else {
+			// page aligned, so the mapping satisfies pCode's alignment without a copy
+			MappedFile file{ LOOSE_SHADER_DIRECTORY + shaderName + ".spv" };
+			this->m_Stats.FilesMapped++;
+			if (file.GetSize() == 0 || file.GetSize() % sizeof(uint32_t) != 0) {
+				throw std::runtime_error("Invalid SPIR-V file for shader: " + shaderName);
+			}
+			module = this->FindOrCreateModule(file.GetData(), file.GetSize(), HashBytes(file.GetData(), file.GetSize()));
+		}
+
+		entry.Module = module;
+		if (entry.Leases > 0) {
+			entry.Pinned = module;
+		}
+		return module;
+	}
+
+	const ShaderInterface& ShaderRegistry::GetInterface(const std::string& shaderName) {
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+
+		auto& shaderInterface = this->m_Interfaces[shaderName];
+		if (shaderInterface) {
+			return *shaderInterface;
+		}
+
+		if (const ShaderArchiveEntry* archived = this->m_Archive.Find(shaderName)) {
+			this->m_Stats.ArchiveLookups++;
+			shaderInterface = std::make_unique<ShaderInterface>(ShaderInterface::Reflect(
+				static_cast<const uint32_t*>(this->m_Archive.GetData(*archived)), archived->DataSize / sizeof(uint32_t)));
+		}
+		else {
+			MappedFile file{ LOOSE_SHADER_DIRECTORY + shaderName + ".spv" };
+			this->m_Stats.FilesMapped++;
+			shaderInterface = std::make_unique<ShaderInterface>(ShaderInterface::Reflect(
+				static_cast<const uint32_t*>(file.GetData()), file.GetSize() / sizeof(uint32_t)));
+		}
+		return *shaderInterface;
+	}
+
+	std::shared_ptr<ShaderModule> ShaderRegistry::FindOrCreateModule(const void* code, size_t codeSize, uint64_t contentHash) {
+		auto range = this->m_Modules.equal_range(contentHash);
+		for (auto entry = range.first; entry != range.second;) {
+			std::shared_ptr<ShaderModule> module = entry->second.lock();
+			if (!module) {
+				entry = this->m_Modules.erase(entry);
+				continue;
+			}
+			if (module->HasCode(code, codeSize)) {
+				this->m_Stats.ContentMatches++;
+				return module;
+			}
+			++entry;
+		}
+
+		auto module = std::make_shared<ShaderModule>(this->m_Device, code, codeSize, contentHash);
+		this->m_Modules.emplace(contentHash, module);
+		this->m_Stats.ModulesCreated++;
+		return module;
+	}
+
+	void ShaderRegistry::Retain(const std::string& shaderName) {
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+		NameEntry& entry = this->m_Names[shaderName];
+		entry.Leases++;
+		if (!entry.Pinned) {
+			entry.Pinned = entry.Module.lock();
+		}
+	}
+
+	void ShaderRegistry::Release(const std::string& shaderName) {
+		std::shared_ptr<ShaderModule> released;
+		{
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			NameEntry& entry = this->m_Names[shaderName];
+			if (--entry.Leases == 0) {
+				// destroyed outside the lock if this was the last reference
+				released = std::move(entry.Pinned);
+			}
+		}
+	}
+}
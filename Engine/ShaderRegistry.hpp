@@ -0,0 +1,112 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./ShaderReflection.hpp"
+
+#include "./Utils/ShaderArchive.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine {
+
+	class ShaderModule : public NonMoveable, public NonCopyable {
+	public:
+		ShaderModule(VkDevice, const void*, size_t, uint64_t);
+		~ShaderModule();
+
+		inline VkShaderModule GetModule() const { return this->m_Module; }
+		inline uint64_t GetContentHash() const { return this->m_ContentHash; }
+		// compares the whole SPIR-V, the content hash alone could collide
+		bool HasCode(const void*, size_t) const;
+
+	private:
+		VkDevice m_Device;
+		VkShaderModule m_Module = VK_NULL_HANDLE;
+		uint64_t m_ContentHash;
+		// kept while the module lives, it's only a few kilobytes per shader
+		std::vector<uint32_t> m_Code;
+	};
+
+	// Creates one VkShaderModule per unique SPIR-V blob, looked up by name ("SimpleShader.vert").
+	// Shaders come from the packed archive the build produces, mapped once at startup, and fall back to
+	// mapping the loose .spv file when the archive is missing or doesn't have them (e.g. while iterating on a shader).
+	// Modules are only needed while pipelines are being created, so they die with their last user.
+	// A lease keeps a shader's module alive across pipeline compiles that are queued but not yet started,
+	// so a batch of pipelines sharing a shader reads and creates it once.
+	class ShaderRegistry : public NonMoveable, public NonCopyable {
+	public:
+		class Lease : public NonCopyable {
+		public:
+			Lease() = default;
+			Lease(ShaderRegistry&, const std::string&);
+			~Lease();
+
+			Lease(Lease&&) noexcept;
+			Lease& operator=(Lease&&) noexcept;
+
+			inline std::shared_ptr<ShaderModule> Get() const { return this->m_Registry->Acquire(this->m_ShaderName); }
+
+		private:
+			ShaderRegistry* m_Registry = nullptr;
+			std::string m_ShaderName;
+		};
+
+		static constexpr const char* DEFAULT_ARCHIVE_PATH = "./Shaders/Shaders.pak";
+		static constexpr const char* LOOSE_SHADER_DIRECTORY = "./Shaders/";
+
+		struct Stats {
+			uint64_t ArchiveLookups = 0;
+			// loose .spv files that had to be opened
+			uint64_t FilesMapped = 0;
+			uint64_t ModulesCreated = 0;
+			// files whose content matched a module created from another path
+			uint64_t ContentMatches = 0;
+		};
+
+		ShaderRegistry(VkDevice, const std::string& = DEFAULT_ARCHIVE_PATH);
+
+		std::shared_ptr<ShaderModule> Acquire(const std::string&);
+		inline Lease MakeLease(const std::string& shaderName) { return Lease{ *this, shaderName }; }
+
+		// reflected once per shader and kept for the registry's lifetime, unlike the module itself
+		const ShaderInterface& GetInterface(const std::string&);
+
+		inline Stats GetStats() {
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			return this->m_Stats;
+		}
+		// zero when the archive wasn't found and shaders are loaded from loose files
+		inline uint32_t GetArchiveEntryCount() const { return this->m_Archive.GetEntryCount(); }
+
+	private:
+		struct NameEntry {
+			std::weak_ptr<ShaderModule> Module;
+			// strong reference held while leases are outstanding
+			std::shared_ptr<ShaderModule> Pinned;
+			uint32_t Leases = 0;
+		};
+
+		void Retain(const std::string&);
+		void Release(const std::string&);
+		std::shared_ptr<ShaderModule> FindOrCreateModule(const void*, size_t, uint64_t);
+
+		VkDevice m_Device;
+		ShaderArchive m_Archive;
+
+		std::mutex m_Mutex;
+		std::unordered_map<std::string, NameEntry> m_Names;
+		std::unordered_multimap<uint64_t, std::weak_ptr<ShaderModule>> m_Modules;
+		std::unordered_map<std::string, std::unique_ptr<ShaderInterface>> m_Interfaces;
+
+		Stats m_Stats;
+	};
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+// std lib headers
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Engine {
+
+	// Type erased specialization constants for one shader stage, what PipelineConfigurationInfo stores.
+	// Owns its data, so configs stay safe to copy (the background compiler does).
+	struct ShaderSpecialization {
+		std::vector<VkSpecializationMapEntry> Entries;
+		std::vector<std::byte> Data;
+
+		inline bool IsEmpty() const { return this->Entries.empty(); }
+
+		// only valid as long as this object is neither modified nor destroyed
+		inline VkSpecializationInfo GetInfo() const {
+			VkSpecializationInfo info{};
+			info.mapEntryCount = static_cast<uint32_t>(this->Entries.size());
+			info.pMapEntries = this->Entries.data();
+			info.dataSize = this->Data.size();
+			info.pData = this->Data.data();
+			return info;
+		}
+	};
+
+	// GLSL scalar a C++ type maps to, bool becomes VkBool32 like the spec wants
+	template<typename T> struct SpecializationType;
+	template<> struct SpecializationType<bool> { using Type = VkBool32; };
+	template<> struct SpecializationType<int32_t> { using Type = int32_t; };
+	template<> struct SpecializationType<uint32_t> { using Type = uint32_t; };
+	template<> struct SpecializationType<float> { using Type = float; };
+	template<> struct SpecializationType<int64_t> { using Type = int64_t; };
+	template<> struct SpecializationType<uint64_t> { using Type = uint64_t; };
+	template<> struct SpecializationType<double> { using Type = double; };
+
+	// Typed set of specialization constants, constant I of the list matches layout(constant_id = I) in the shader:
+	//   SpecializationConstants<bool, float> constants{ true, 0.5f };
+	//   config.VertexSpecialization = constants.ToShaderSpecialization();
+	// The map entry table is built at compile time from the type list.
+	template<typename... Ts>
+	class SpecializationConstants {
+	public:
+		static constexpr size_t COUNT = sizeof...(Ts);
+		static_assert(COUNT > 0, "SpecializationConstants needs at least one constant");
+
+		SpecializationConstants() = default;
+		SpecializationConstants(Ts... values) { this->SetAll(std::index_sequence_for<Ts...>{}, values...); }
+
+		template<size_t I>
+		void Set(const std::tuple_element_t<I, std::tuple<Ts...>>& value) {
+			using Stored = typename SpecializationType<std::tuple_element_t<I, std::tuple<Ts...>>>::Type;
+			Stored stored = static_cast<Stored>(value);
+			std::memcpy(this->m_Data.data() + OFFSETS[I], &stored, sizeof(Stored));
+		}
+
+		template<size_t I>
+		std::tuple_element_t<I, std::tuple<Ts...>> Get() const {
+			using Stored = typename SpecializationType<std::tuple_element_t<I, std::tuple<Ts...>>>::Type;
+			Stored stored;
+			std::memcpy(&stored, this->m_Data.data() + OFFSETS[I], sizeof(Stored));
+			return static_cast<std::tuple_element_t<I, std::tuple<Ts...>>>(stored);
+		}
+
+		inline static constexpr const std::array<VkSpecializationMapEntry, COUNT>& GetEntries() { return ENTRIES; }
+
+		ShaderSpecialization ToShaderSpecialization() const {
+			ShaderSpecialization specialization{};
+			specialization.Entries.assign(ENTRIES.begin(), ENTRIES.end());
+			specialization.Data.assign(this->m_Data.begin(), this->m_Data.end());
+			return specialization;
+		}
+
+	private:
+		static constexpr std::array<size_t, COUNT> SIZES = { sizeof(typename SpecializationType<Ts>::Type)... };
+
+		static constexpr std::array<uint32_t, COUNT> ComputeOffsets() {
+			std::array<uint32_t, COUNT> offsets{};
+			uint32_t offset = 0;
+			for (size_t i = 0; i < COUNT; i++) {
+				offsets[i] = offset;
+				offset += static_cast<uint32_t>(SIZES[i]);
+			}
+			return offsets;
+		}
+
+		static constexpr size_t ComputeSize() {
+			size_t size = 0;
+			for (size_t i = 0; i < COUNT; i++) size += SIZES[i];
+			return size;
+		}
+
+		template<size_t... Is>
+		static constexpr std::array<VkSpecializationMapEntry, COUNT> ComputeEntries(std::index_sequence<Is...>) {
+			return { { VkSpecializationMapEntry{ static_cast<uint32_t>(Is), OFFSETS[Is], SIZES[Is] }... } };
+		}
+
+		template<size_t... Is>
+		void SetAll(std::index_sequence<Is...>, Ts... values) {
+			(this->Set<Is>(values), ...);
+		}
+
+		static constexpr std::array<uint32_t, COUNT> OFFSETS = ComputeOffsets();
+		static constexpr std::array<VkSpecializationMapEntry, COUNT> ENTRIES = ComputeEntries(std::index_sequence_for<Ts...>{});
+
+		// constants are packed back to back, entries carry the offsets so no padding is needed
+		std::array<std::byte, ComputeSize()> m_Data{};
+	};
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "./TransformHierarchy.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+// std lib headers
+#include <cstdint>
+
+namespace Engine {
+
+	struct Sprite {
+		// unit quad centered on the origin, scaled and rotated before it is translated
+		Transform2DComponent Transform{};
+		// min and max corner of the texture region, the whole texture by default
+		glm::vec4 TexCoords{ 0.0f, 0.0f, 1.0f, 1.0f };
+		glm::vec4 Color{ 1.0f };
+		// BindlessTable texture index
+		uint32_t Texture = 0;
+	};
+
+	struct SpriteVertex {
+		glm::vec2 Position;
+		glm::vec2 TexCoord;
+		uint32_t Color; // RGBA8, normalized in the shader
+		uint32_t Texture;
+	};
+
+	// the sprite's four corners, counter clockwise from the min one. Only writes, so the destination can be a
+	// write combined mapping
+	inline void WriteSpriteQuad(SpriteVertex* vertices, const Sprite& sprite) {
+		const glm::mat2 transform = sprite.Transform.GetTransformMatrix();
+		const glm::vec2 translation = sprite.Transform.Translation;
+		const uint32_t color = glm::packUnorm4x8(sprite.Color);
+		const glm::vec4& uv = sprite.TexCoords;
+
+		vertices[0] = { transform * glm::vec2{ -0.5f, -0.5f } + translation, { uv.x, uv.y }, color, sprite.Texture };
+		vertices[1] = { transform * glm::vec2{ 0.5f, -0.5f } + translation, { uv.z, uv.y }, color, sprite.Texture };
+		vertices[2] = { transform * glm::vec2{ 0.5f, 0.5f } + translation, { uv.z, uv.w }, color, sprite.Texture };
+		vertices[3] = { transform * glm::vec2{ -0.5f, 0.5f } + translation, { uv.x, uv.w }, color, sprite.Texture };
+	}
+}
@@ -0,0 +1,180 @@
+#include "./SpriteBatch.hpp"
+#include "./PipelineLayoutCache.hpp"
+#include "./StagingBuffer.hpp"
+
+// std lib headers
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace Engine {
+	constexpr const char* SPRITE_VERTEX_SHADER = "Sprite.vert";
+	constexpr const char* SPRITE_FRAGMENT_SHADER = "Sprite.frag";
+
+	static std::vector<VkVertexInputAttributeDescription> GetSpriteAttributeDescriptions() {
+		return {
+			{ 0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(SpriteVertex, Position) },
+			{ 1, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(SpriteVertex, TexCoord) },
+			{ 2, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(SpriteVertex, Color) },
+			{ 3, 0, VK_FORMAT_R32_UINT, offsetof(SpriteVertex, Texture) } };
+	}
+
+	SpriteBatch::SpriteBatch(Device& device, VkRenderPass renderPass, VkDescriptorSetLayout frameSetLayout, BindlessTable& bindlessTable, uint32_t maxSprites)
+		: m_Device{ device }, m_BindlessTable{ bindlessTable }, m_MaxSprites{ maxSprites } {
+		assert(maxSprites > 0 && "Sprite batch needs room for at least one sprite");
+
+		this->CreateVertexBuffer();
+		this->CreateIndexBuffer();
+		this->CreatePipelineLayout(frameSetLayout);
+		this->CreatePipeline(renderPass);
+	}
+
+	SpriteBatch::~SpriteBatch() {
+		VkDevice device = this->m_Device.GetDevice();
+		VkBuffer vertexBuffer = this->m_VertexBuffer;
+		VkDeviceMemory vertexBufferMemory = this->m_VertexBufferMemory;
+		VkBuffer indexBuffer = this->m_IndexBuffer;
+		VkDeviceMemory indexBufferMemory = this->m_IndexBufferMemory;
+
+		this->m_Device.GetFrameTimeline().DeferDestroy([device, vertexBuffer, vertexBufferMemory, indexBuffer, indexBufferMemory]() {
+			vkUnmapMemory(device, vertexBufferMemory);
+			vkDestroyBuffer(device, vertexBuffer, nullptr);
+			vkFreeMemory(device, vertexBufferMemory, nullptr);
+			vkDestroyBuffer(device, indexBuffer, nullptr);
+			vkFreeMemory(device, indexBufferMemory, nullptr);
+		});
+	}
+
+	void SpriteBatch::BeginFrame(int frameIndex) {
+		this->m_FrameBegin = this->m_MaxSprites * static_cast<uint32_t>(frameIndex);
+		this->m_Head = this->m_FrameBegin;
+		this->m_RenderedHead = this->m_FrameBegin;
+		this->m_TouchedTexture = BindlessTable::INVALID_INDEX;
+		this->m_FrameStats = {};
+	}
+
+	void SpriteBatch::Draw(const Sprite& sprite) {
+		if (this->m_Head - this->m_FrameBegin == this->m_MaxSprites) {
+			this->m_FrameStats.Dropped++;
+			return;
+		}
+
+		// expanded on the CPU and written straight into the mapping, nothing is staged
+		WriteSpriteQuad(this->m_Vertices + static_cast<size_t>(this->m_Head) * 4, sprite);
+
+		// runs of sprites mostly share a texture, once per run is enough for the residency manager
+		if (sprite.Texture != this->m_TouchedTexture) {
+			this->m_BindlessTable.TouchTexture(sprite.Texture);
+			this->m_TouchedTexture = sprite.Texture;
+		}
+
+		this->m_Head++;
+		this->m_FrameStats.Sprites++;
+	}
+
+	void SpriteBatch::Render(VkCommandBuffer commandBuffer, FrameRingBuffer& frameRing, uint32_t viewOffset) {
+		const uint32_t firstSprite = this->m_RenderedHead;
+		const uint32_t spriteCount = this->m_Head - firstSprite;
+		this->m_RenderedHead = this->m_Head;
+
+		Pipeline* pipeline = this->m_Pipeline.GetOr(nullptr);
+		if (spriteCount == 0 || pipeline == nullptr) return;
+
+		pipeline->Bind(commandBuffer);
+		this->m_Device.GetDynamicStateCommands().Apply(commandBuffer, this->m_RenderState);
+		frameRing.Bind(commandBuffer, this->m_PipelineLayout, 0, viewOffset, 0);
+		this->m_BindlessTable.Bind(commandBuffer, this->m_PipelineLayout, 1);
+
+		VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &this->m_VertexBuffer, &offset);
+		vkCmdBindIndexBuffer(commandBuffer, this->m_IndexBuffer, 0, this->m_IndexType);
+
+		// the index pattern only covers one frame's worth of quads, the vertex offset moves it into place
+		vkCmdDrawIndexed(commandBuffer, spriteCount * 6, 1, 0, static_cast<int32_t>(firstSprite * 4), 0);
+		this->m_FrameStats.Draws++;
+	}
+
+	void SpriteBatch::CreateVertexBuffer() {
+		VkDeviceSize bufferSize = sizeof(SpriteVertex) * 4 * static_cast<VkDeviceSize>(this->m_MaxSprites) * SwapChain::MAX_FRAMES_IN_FLIGHT;
+
+		this->m_Device.CreateBuffer(bufferSize,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			this->m_VertexBuffer,
+			this->m_VertexBufferMemory);
+
+		void* data;
+		vkMapMemory(this->m_Device.GetDevice(), this->m_VertexBufferMemory, 0, bufferSize, 0, &data);
+		this->m_Vertices = static_cast<SpriteVertex*>(data);
+	}
+
+	void SpriteBatch::CreateIndexBuffer() {
+		// the same two triangles per quad every frame, so the indices are uploaded once to device local memory
+		const uint32_t vertexCount = this->m_MaxSprites * 4;
+		this->m_IndexType = vertexCount <= UINT16_MAX + 1u ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+		const VkDeviceSize indexSize = this->m_IndexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+		const VkDeviceSize bufferSize = indexSize * 6 * this->m_MaxSprites;
+
+		StagingBuffer staging{ this->m_Device, bufferSize };
+		auto writeIndices = [this](auto* indices) {
+			constexpr uint32_t pattern[6] = { 0, 1, 2, 2, 3, 0 };
+			for (uint32_t sprite = 0; sprite < this->m_MaxSprites; sprite++) {
+				for (uint32_t i = 0; i < 6; i++) {
+					indices[sprite * 6 + i] = static_cast<std::remove_pointer_t<decltype(indices)>>(sprite * 4 + pattern[i]);
+				}
+			}
+		};
+		if (this->m_IndexType == VK_INDEX_TYPE_UINT16) writeIndices(static_cast<uint16_t*>(staging.GetData()));
+		else writeIndices(static_cast<uint32_t*>(staging.GetData()));
+
+		this->m_Device.CreateBuffer(bufferSize,
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			this->m_IndexBuffer,
+			this->m_IndexBufferMemory);
+
+		VkCommandBuffer commandBuffer = this->m_Device.BeginSingleTimeCommands();
+		VkBufferCopy copyRegion{ 0, 0, bufferSize };
+		vkCmdCopyBuffer(commandBuffer, staging.GetBuffer(), this->m_IndexBuffer, 1, &copyRegion);
+		this->m_Device.EndSingleTimeCommandsDeferred(commandBuffer);
+	}
+
+	void SpriteBatch::CreatePipelineLayout(VkDescriptorSetLayout frameSetLayout) {
+		// set 0 is the frame ring for the view, set 1 the bindless table
+		const auto& layout = this->m_Device.GetPipelineLayoutCache().GetLayout(
+			{ SPRITE_VERTEX_SHADER, SPRITE_FRAGMENT_SHADER },
+			{ { 0, frameSetLayout }, { 1, this->m_BindlessTable.GetDescriptorSetLayout() } });
+
+		layout.Interface.ValidateBlockSize(0, 0, sizeof(ViewData), "SpriteBatch::ViewData");
+		auto attributeDescriptions = GetSpriteAttributeDescriptions();
+		layout.Interface.ValidateVertexInputs(attributeDescriptions.data(), attributeDescriptions.size());
+
+		this->m_PipelineLayout = layout.Layout;
+	}
+
+	void SpriteBatch::CreatePipeline(VkRenderPass renderPass) {
+		assert(this->m_PipelineLayout != nullptr && "Can't create pipeline without pipeline layout");
+
+		PipelineConfigurationInfo config{};
+		Pipeline::DefaultPipelineConfigurationInfo(config);
+
+		config.BindingDescriptions = { { 0, sizeof(SpriteVertex), VK_VERTEX_INPUT_RATE_VERTEX } };
+		config.AttributeDescriptions = GetSpriteAttributeDescriptions();
+
+		// drawn in submission order with straight alpha, no depth
+		config.ColorBlendAttachment.blendEnable = VK_TRUE;
+		config.ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		config.ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		config.ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		config.ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		config.DepthStencilInfo.depthTestEnable = VK_FALSE;
+		config.DepthStencilInfo.depthWriteEnable = VK_FALSE;
+
+		config.RenderPass = renderPass;
+		config.PipelineLayout = this->m_PipelineLayout;
+		this->m_RenderState = Pipeline::MakeRenderStateDynamic(this->m_Device, config);
+
+		this->m_Pipeline = this->m_Device.GetPipelineRegistry().GetOrCreateAsync(config, SPRITE_VERTEX_SHADER, SPRITE_FRAGMENT_SHADER);
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./Sprite.hpp"
+#include "./PipelineRegistry.hpp"
+#include "./FrameRingBuffer.hpp"
+#include "./Descriptors.hpp"
+#include "./SwapChain.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std lib headers
+#include <cstdint>
+
+namespace Engine {
+
+	// Streams textured quads into a persistently mapped vertex buffer with one region per frame in flight.
+	// Textures are picked per sprite from the bindless table, so everything added between two Render calls
+	// is a single indexed draw no matter how many different images it uses. Atlases work through TexCoords.
+	class SpriteBatch : public NonMoveable, public NonCopyable {
+	public:
+		// 4 vertices per sprite, so a full frame still fits 16 bit indices
+		static constexpr uint32_t DEFAULT_MAX_SPRITES = 16384;
+
+		// matches GlobalData in Sprite.vert (std140)
+		struct ViewData {
+			glm::vec4 Transform{ 1.0f, 0.0f, 0.0f, 1.0f }; // mat2 packed by columns
+			glm::vec2 Offset{ 0.0f };
+		};
+
+		struct Stats {
+			uint32_t Sprites = 0;
+			uint32_t Draws = 0;
+			// sprites that didn't fit into this frame's region
+			uint32_t Dropped = 0;
+		};
+
+		SpriteBatch(Device&, VkRenderPass, VkDescriptorSetLayout, BindlessTable&, uint32_t = DEFAULT_MAX_SPRITES);
+		~SpriteBatch();
+
+		// called once the frame slot's previous use has completed on the GPU, like FrameRingBuffer::BeginFrame
+		void BeginFrame(int);
+
+		// also marks the sprite's texture as sampled this frame
+		void Draw(const Sprite&);
+		// draws everything added since the last call, the view block comes from the frame ring
+		void Render(VkCommandBuffer, FrameRingBuffer&, uint32_t);
+
+		inline const Stats& GetFrameStats() const { return this->m_FrameStats; }
+		inline uint32_t GetMaxSprites() const { return this->m_MaxSprites; }
+
+	private:
+		void CreateVertexBuffer();
+		void CreateIndexBuffer();
+		void CreatePipelineLayout(VkDescriptorSetLayout);
+		void CreatePipeline(VkRenderPass);
+
+		Device& m_Device;
+		BindlessTable& m_BindlessTable;
+		uint32_t m_MaxSprites;
+
+		VkBuffer m_VertexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_VertexBufferMemory = VK_NULL_HANDLE;
+		SpriteVertex* m_Vertices = nullptr;
+
+		VkBuffer m_IndexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_IndexBufferMemory = VK_NULL_HANDLE;
+		VkIndexType m_IndexType;
+
+		PipelineHandle m_Pipeline;
+		VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+		RenderState m_RenderState;
+
+		// sprite indices into the whole buffer, the current frame's region starts at m_FrameBegin
+		uint32_t m_FrameBegin = 0;
+		uint32_t m_Head = 0;
+		uint32_t m_RenderedHead = 0;
+		uint32_t m_TouchedTexture = BindlessTable::INVALID_INDEX;
+		Stats m_FrameStats;
+	};
+}
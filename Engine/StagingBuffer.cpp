@@ -0,0 +1,35 @@
+#include "./StagingBuffer.hpp"
+
+// std lib headers
+#include <cassert>
+#include <cstring>
+
+namespace Engine {
+	StagingBuffer::StagingBuffer(Device& device, VkDeviceSize size) : m_Device{ device }, m_Size{ size } {
+		this->m_Device.CreateBuffer(size,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			this->m_Buffer,
+			this->m_Memory);
+
+		vkMapMemory(this->m_Device.GetDevice(), this->m_Memory, 0, size, 0, &this->m_Data);
+	}
+
+	StagingBuffer::~StagingBuffer() {
+		// copies recorded from this buffer complete with the frame currently being recorded at the latest
+		VkDevice device = this->m_Device.GetDevice();
+		VkBuffer buffer = this->m_Buffer;
+		VkDeviceMemory memory = this->m_Memory;
+
+		this->m_Device.GetFrameTimeline().DeferDestroy([device, buffer, memory]() {
+			vkUnmapMemory(device, memory);
+			vkDestroyBuffer(device, buffer, nullptr);
+			vkFreeMemory(device, memory, nullptr);
+		});
+	}
+
+	void StagingBuffer::Write(const void* data, VkDeviceSize size, VkDeviceSize offset) {
+		assert(offset + size <= this->m_Size && "Staging write out of bounds");
+		std::memcpy(static_cast<unsigned char*>(this->m_Data) + offset, data, static_cast<size_t>(size));
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "./Device.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+namespace Engine {
+	// Host visible, persistently mapped source for a one off upload. Meant to be recorded into a single time
+	// command buffer ended with Device::EndSingleTimeCommandsDeferred, the buffer is released once the frame
+	// timeline has passed that submission, so the caller never waits for the copy.
+	class StagingBuffer : public NonMoveable, public NonCopyable {
+	public:
+		StagingBuffer(Device&, VkDeviceSize);
+		~StagingBuffer();
+
+		// copies into the mapping, offsets are in bytes from the start of the buffer
+		void Write(const void*, VkDeviceSize, VkDeviceSize = 0);
+
+		inline VkBuffer GetBuffer() const { return this->m_Buffer; }
+		inline void* GetData() const { return this->m_Data; }
+		inline VkDeviceSize GetSize() const { return this->m_Size; }
+
+	private:
+		Device& m_Device;
+		VkBuffer m_Buffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_Memory = VK_NULL_HANDLE;
+		void* m_Data = nullptr;
+		VkDeviceSize m_Size;
+	};
+}
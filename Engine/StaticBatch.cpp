@@ -0,0 +1,192 @@
+#include "./StaticBatch.hpp"
+#include "./Utils/Hash.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+	namespace {
+		// the level baking reads, dropped levels fall back to the finest one left like drawing does
+		uint32_t GetBakedLod(const GameObject& obj) {
+			return std::max(std::min(obj.Lod, obj.Model->GetLodCount() - 1), obj.Model->GetMinLod());
+		}
+	}
+
+	StaticBatch::StaticBatch(Device& device) : m_Device{ device } {}
+
+	StaticBatch::~StaticBatch() {}
+
+	void StaticBatch::Update(std::vector<GameObject>& gameObjects) {
+		this->m_Frame++;
+
+		for (auto& obj : gameObjects) {
+			auto member = this->m_Members.find(obj.GetId());
+
+			// objects in a hierarchy move with their parents, they're never baked
+			if (!obj.Static || obj.Model == nullptr || obj.Node != TransformHierarchy::INVALID_NODE) {
+				if (member != this->m_Members.end()) {
+					this->Unbake(member->first, member->second);
+					this->m_Members.erase(member);
+				}
+				obj.Baked = false;
+				continue;
+			}
+
+			const uint64_t fingerprint = GetFingerprint(obj);
+			if (member == this->m_Members.end()) {
+				// new static objects are taken at their word and baked right away
+				member = this->m_Members.emplace(obj.GetId(), Member{}).first;
+				member->second.Fingerprint = fingerprint;
+				member->second.StableFrames = REBAKE_FRAMES;
+			}
+
+			Member& data = member->second;
+			data.LastSeen = this->m_Frame;
+
+			if (data.Fingerprint != fingerprint) {
+				// changed after all, drawn on its own until it settles again
+				this->Unbake(member->first, data);
+				data.Fingerprint = fingerprint;
+				data.StableFrames = 0;
+			} else if (!data.Baked && ++data.StableFrames >= REBAKE_FRAMES) {
+				this->Bake(obj, data);
+			}
+
+			obj.Baked = data.Baked;
+		}
+
+		// objects that were removed from the list
+		for (auto member = this->m_Members.begin(); member != this->m_Members.end();) {
+			if (member->second.LastSeen == this->m_Frame) {
+				++member;
+				continue;
+			}
+			this->Unbake(member->first, member->second);
+			member = this->m_Members.erase(member);
+		}
+
+		bool rebuilt = false;
+		for (auto chunk = this->m_Chunks.begin(); chunk != this->m_Chunks.end();) {
+			if (chunk->second.Dirty) {
+				this->RebuildChunk(chunk->second);
+				rebuilt = true;
+			}
+			chunk = chunk->second.Model == nullptr ? this->m_Chunks.erase(chunk) : std::next(chunk);
+		}
+
+		for (auto source = this->m_Sources.begin(); source != this->m_Sources.end();) {
+			source = source->second.Model.expired() ? this->m_Sources.erase(source) : std::next(source);
+		}
+
+		if (!rebuilt) return;
+
+		this->m_Version++;
+		this->m_ChunkList.clear();
+		this->m_Stats.BakedTriangles = 0;
+		for (const auto& chunk : this->m_Chunks) {
+			this->m_ChunkList.push_back({ chunk.second.Model, chunk.second.Min, chunk.second.Max });
+			this->m_Stats.BakedTriangles += chunk.second.Model->GetIndexCount() / 3;
+		}
+		this->m_Stats.Chunks = static_cast<uint32_t>(this->m_ChunkList.size());
+	}
+
+	uint64_t StaticBatch::GetFingerprint(const GameObject& obj) {
+		uint64_t hash = reinterpret_cast<uintptr_t>(obj.Model.get());
+		HashCombine(hash, GetBakedLod(obj));
+		HashCombineBytes(hash, obj.Color);
+		HashCombineBytes(hash, obj.Transform.Translation);
+		HashCombineBytes(hash, obj.Transform.Scale);
+		HashCombineBytes(hash, obj.Transform.Rotation);
+		return hash;
+	}
+
+	const Model::Geometry& StaticBatch::GetSource(const GameObject& obj) {
+		Source& source = this->m_Sources[obj.Model.get()];
+
+		// a different model may have been created at the address of an expired one
+		if (source.Model.expired()) {
+			source.Model = obj.Model;
+			obj.Model->ReadBack(source.Levels);
+		}
+		// levels only ever get dropped, so the baked one was resident when the model was read back
+		return source.Levels[GetBakedLod(obj)];
+	}
+
+	void StaticBatch::Bake(const GameObject& obj, Member& member) {
+		const Model::Geometry& source = this->GetSource(obj);
+		const glm::mat2 transform = obj.Transform.GetTransformMatrix();
+
+		member.Vertices.resize(source.Vertices.size());
+		for (size_t i = 0; i < source.Vertices.size(); i++) {
+			member.Vertices[i].position = transform * source.Vertices[i].position + obj.Transform.Translation;
+			member.Vertices[i].color = obj.Color;
+		}
+		member.Indices = source.Indices;
+
+		member.Key = {
+			static_cast<int32_t>(std::floor(obj.Transform.Translation.x / CHUNK_SIZE)),
+			static_cast<int32_t>(std::floor(obj.Transform.Translation.y / CHUNK_SIZE)) };
+		ChunkData& chunk = this->m_Chunks[member.Key];
+		chunk.Members.push_back(obj.GetId());
+		chunk.Dirty = true;
+
+		member.Baked = true;
+		this->m_Stats.BakedObjects++;
+	}
+
+	void StaticBatch::Unbake(GameObject::IdType id, Member& member) {
+		if (!member.Baked) return;
+
+		ChunkData& chunk = this->m_Chunks[member.Key];
+		auto position = std::find(chunk.Members.begin(), chunk.Members.end(), id);
+		*position = chunk.Members.back();
+		chunk.Members.pop_back();
+		chunk.Dirty = true;
+
+		member.Baked = false;
+		member.Vertices = {};
+		member.Indices = {};
+		this->m_Stats.BakedObjects--;
+		this->m_Stats.Unbakes++;
+	}
+
+	void StaticBatch::RebuildChunk(ChunkData& chunk) {
+		chunk.Dirty = false;
+		// frames in flight keep drawing the old model, its buffers are released once they complete
+		chunk.Model = nullptr;
+		if (chunk.Members.empty()) return;
+
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+		for (GameObject::IdType id : chunk.Members) {
+			const Member& member = this->m_Members.at(id);
+			vertexCount += member.Vertices.size();
+			indexCount += member.Indices.size();
+		}
+
+		std::vector<Model::Vertex> vertices;
+		std::vector<uint32_t> indices;
+		vertices.reserve(vertexCount);
+		indices.reserve(indexCount);
+		chunk.Min = glm::vec2{ INFINITY };
+		chunk.Max = glm::vec2{ -INFINITY };
+
+		for (GameObject::IdType id : chunk.Members) {
+			const Member& member = this->m_Members.at(id);
+			const uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
+
+			for (const auto& vertex : member.Vertices) {
+				chunk.Min = glm::min(chunk.Min, vertex.position);
+				chunk.Max = glm::max(chunk.Max, vertex.position);
+				vertices.push_back(vertex);
+			}
+			for (uint32_t index : member.Indices) {
+				indices.push_back(baseVertex + index);
+			}
+		}
+
+		chunk.Model = std::make_shared<Model>(this->m_Device, vertices, indices);
+		this->m_Stats.Rebuilds++;
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./GameObject.hpp"
+#include "./Model.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std lib headers
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Engine {
+
+	// Merges game objects flagged static into pre-transformed geometry, their transform and color are applied to
+	// the vertices once and every chunk of CHUNK_SIZE square is a single model drawn with one call. An object that
+	// changes anyway is unbaked and drawn on its own again, until it has stayed unchanged for REBAKE_FRAMES.
+	class StaticBatch : public NonMoveable, public NonCopyable {
+	public:
+		// world units a side, objects are binned by their origin so chunk bounds can reach a little further
+		static constexpr float CHUNK_SIZE = 0.5f;
+		static constexpr uint32_t REBAKE_FRAMES = 60;
+
+		struct Chunk {
+			// vertex colored, positions already in world space
+			std::shared_ptr<Engine::Model> Model;
+			glm::vec2 Min;
+			glm::vec2 Max;
+		};
+
+		struct Stats {
+			uint32_t Chunks = 0;
+			uint32_t BakedObjects = 0;
+			uint64_t BakedTriangles = 0;
+			// totals over every Update call
+			uint64_t Rebuilds = 0;
+			uint64_t Unbakes = 0;
+		};
+
+		StaticBatch(Device&);
+		~StaticBatch();
+
+		// bakes new static objects, unbakes changed or removed ones and rebuilds the chunks they touched; sets
+		// every object's Baked flag. Meant to run once per frame after levels of detail were picked
+		void Update(std::vector<GameObject>&);
+
+		inline const std::vector<Chunk>& GetChunks() const { return this->m_ChunkList; }
+		// changes whenever a chunk is rebuilt or removed, a new chunk model may reuse the address of an old one
+		inline uint64_t GetVersion() const { return this->m_Version; }
+		inline const Stats& GetStats() const { return this->m_Stats; }
+
+	private:
+		using ChunkKey = std::pair<int32_t, int32_t>;
+
+		struct Member {
+			ChunkKey Key;
+			uint64_t Fingerprint;
+			uint32_t StableFrames = 0;
+			uint64_t LastSeen = 0;
+			bool Baked = false;
+			std::vector<Model::Vertex> Vertices;
+			std::vector<uint32_t> Indices;
+		};
+
+		struct ChunkData {
+			std::vector<GameObject::IdType> Members;
+			std::shared_ptr<Engine::Model> Model;
+			glm::vec2 Min;
+			glm::vec2 Max;
+			bool Dirty = false;
+		};
+
+		// every level of a model read back when its first static object shows up, shared by all objects baked
+		// from it while the model lives. Later level changes and dropped levels rebake from here without a readback
+		struct Source {
+			std::weak_ptr<Engine::Model> Model;
+			std::vector<Engine::Model::Geometry> Levels;
+		};
+
+		static uint64_t GetFingerprint(const GameObject&);
+		const Model::Geometry& GetSource(const GameObject&);
+		void Bake(const GameObject&, Member&);
+		void Unbake(GameObject::IdType, Member&);
+		void RebuildChunk(ChunkData&);
+
+		Device& m_Device;
+
+		std::unordered_map<GameObject::IdType, Member> m_Members;
+		std::map<ChunkKey, ChunkData> m_Chunks;
+		std::unordered_map<const Engine::Model*, Source> m_Sources;
+		// flattened for drawing, rebuilt whenever a chunk is
+		std::vector<Chunk> m_ChunkList;
+		uint64_t m_Frame = 0;
+		uint64_t m_Version = 0;
+
+		Stats m_Stats;
+	};
+}
@@ -0,0 +1,93 @@
+#include "./SubmitThread.hpp"
+
+// std lib headers
+#include <stdexcept>
+
+namespace Engine {
+	SubmitThread::SubmitThread() {
+		this->m_Thread = std::thread([this]() { this->Run(); });
+	}
+
+	SubmitThread::~SubmitThread() {
+		{
+			std::lock_guard<std::mutex> lock(this->m_WakeMutex);
+			this->m_Running = false;
+		}
+		this->m_WorkAvailable.notify_one();
+		this->m_Thread.join();
+	}
+
+	void SubmitThread::Push(const FrameSubmission& submission) {
+		this->RethrowPendingError();
+
+		while (!this->m_Queue.TryPush(submission)) {
+			this->WaitForPending(SwapChain::MAX_FRAMES_IN_FLIGHT - 1);
+		}
+
+		{
+			// taking the lock orders the push before the consumer's next emptiness check
+			std::lock_guard<std::mutex> lock(this->m_WakeMutex);
+			this->m_PushedCount++;
+		}
+		this->m_WorkAvailable.notify_one();
+	}
+
+	void SubmitThread::WaitForPending(uint32_t maxPending) {
+		{
+			std::unique_lock<std::mutex> lock(this->m_WakeMutex);
+			this->m_FramePresented.wait(lock, [this, maxPending]() {
+				return this->m_PushedCount - this->m_PresentedCount <= maxPending;
+			});
+		}
+		this->RethrowPendingError();
+	}
+
+	void SubmitThread::RethrowPendingError() {
+		std::exception_ptr error;
+		{
+			std::lock_guard<std::mutex> lock(this->m_WakeMutex);
+			std::swap(error, this->m_Error);
+		}
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+	void SubmitThread::Run() {
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(this->m_WakeMutex);
+				this->m_WorkAvailable.wait(lock, [this]() { return !this->m_Running || !this->m_Queue.IsEmpty(); });
+			}
+
+			FrameSubmission submission;
+			if (!this->m_Queue.TryPop(submission)) {
+				// woken for shutdown with nothing left to present
+				if (!this->m_Running) break;
+				continue;
+			}
+
+			try {
+				uint32_t imageIndex = submission.ImageIndex;
+				auto result = submission.Target->SubmitCommandBuffers(&submission.CommandBuffer, &imageIndex, submission.TimelineValue);
+
+				if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+					this->m_OutOfDate = true;
+				}
+				else if (result != VK_SUCCESS) {
+					throw std::runtime_error("failed to present swap chain image!");
+				}
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(this->m_WakeMutex);
+				this->m_Error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(this->m_WakeMutex);
+				this->m_PresentedCount++;
+			}
+			this->m_FramePresented.notify_all();
+		}
+	}
+}
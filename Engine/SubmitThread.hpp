@@ -0,0 +1,59 @@
+#pragma once
+
+#include "./SwapChain.hpp"
+
+#include "./Utils/SPSCQueue.hpp"
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace Engine {
+
+	struct FrameSubmission {
+		SwapChain* Target = nullptr;
+		VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+		uint32_t ImageIndex = 0;
+		uint64_t TimelineValue = 0;
+	};
+
+	// Submits and presents recorded frames off the main thread, so a present blocking on vblank
+	// doesn't hold up simulating and recording the next frame.
+	class SubmitThread : public NonMoveable, public NonCopyable {
+	public:
+		SubmitThread();
+		~SubmitThread();
+
+		void Push(const FrameSubmission&);
+		// blocks until at most the given number of pushed frames are still waiting to be presented
+		void WaitForPending(uint32_t);
+		inline void Flush() { this->WaitForPending(0); }
+
+		// true once if a present reported the swap chain as out of date or suboptimal since the last call
+		inline bool ConsumeOutOfDate() { return this->m_OutOfDate.exchange(false); }
+
+	private:
+		void Run();
+		void RethrowPendingError();
+
+		SPSCQueue<FrameSubmission, SwapChain::MAX_FRAMES_IN_FLIGHT> m_Queue;
+
+		std::atomic<uint64_t> m_PushedCount{ 0 };
+		std::atomic<uint64_t> m_PresentedCount{ 0 };
+		std::atomic<bool> m_OutOfDate{ false };
+		std::atomic<bool> m_Running{ true };
+
+		// only used to put either side to sleep, the queue itself is lock free
+		std::mutex m_WakeMutex;
+		std::condition_variable m_WorkAvailable;
+		std::condition_variable m_FramePresented;
+
+		std::exception_ptr m_Error;
+		std::thread m_Thread;
+	};
+}
@@ -1,6 +1,8 @@
 #include "./SwapChain.hpp"
+#include "./PipelineRegistry.hpp"
 
 // std lib headers
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <cstring>
@@ -53,46 +55,58 @@ namespace Engine {
 			vkDestroyFramebuffer(this->m_Device.GetDevice(), framebuffer, nullptr);
 		}
 
+		this->m_Device.GetPipelineRegistry().UnregisterRenderPass(this->m_RenderPass);
 		vkDestroyRenderPass(this->m_Device.GetDevice(), this->m_RenderPass, nullptr);
 
 		// cleanup synchronization objects
 		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
 			vkDestroySemaphore(this->m_Device.GetDevice(), this->m_RenderFinishedSemaphores[i], nullptr);
 			vkDestroySemaphore(this->m_Device.GetDevice(), this->m_ImageAvailableSemaphores[i], nullptr);
-			vkDestroyFence(this->m_Device.GetDevice(), this->m_InFlightFences[i], nullptr);
 		}
 	}
 
 	VkResult SwapChain::AcquireNextImage(uint32_t* imageIndex) {
-		vkWaitForFences(
-			this->m_Device.GetDevice(),
-			1,
-			&this->m_InFlightFences[m_CurrentFrame],
-			VK_TRUE,
-			std::numeric_limits<uint64_t>::max());
-
-		VkResult result = vkAcquireNextImageKHR(
-			this->m_Device.GetDevice(),
-			this->m_SwapChain,
-			std::numeric_limits<uint64_t>::max(),
-			this->m_ImageAvailableSemaphores[this->m_CurrentFrame], // must be a not signaled semaphore
-			VK_NULL_HANDLE,
-			imageIndex);
+		FrameTimeline& timeline = this->m_Device.GetFrameTimeline();
+
+		// the frame slot's semaphores are free again once the frame that last used them has completed
+		timeline.Wait(this->m_FrameTimelineValues[this->m_AcquireFrame]);
+
+		// the handle is shared with the submit thread's present, so the lock is only held for a short wait at a
+		// time; an image only frees up once a present went through, which could never happen while waiting locked
+		VkResult result;
+		do {
+			std::lock_guard<std::mutex> lock(this->m_SwapChainMutex);
+			result = vkAcquireNextImageKHR(
+				this->m_Device.GetDevice(),
+				this->m_SwapChain,
+				ACQUIRE_TIMEOUT,
+				this->m_ImageAvailableSemaphores[this->m_AcquireFrame], // must be a not signaled semaphore
+				VK_NULL_HANDLE,
+				imageIndex);
+		} while (result == VK_TIMEOUT || result == VK_NOT_READY);
+
+		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+			return result;
+		}
+
+		// images can be returned out of order, so the image may still be rendered by an older frame;
+		// this is a no-op in the common case since that frame is older than the one waited on above
+		timeline.Wait(this->m_ImageTimelineValues[*imageIndex]);
+
+		this->m_FrameTimelineValues[this->m_AcquireFrame] = timeline.GetPendingValue();
+		this->m_ImageTimelineValues[*imageIndex] = timeline.GetPendingValue();
+		this->m_AcquireFrame = (this->m_AcquireFrame + 1) % this->MAX_FRAMES_IN_FLIGHT;
 
 		return result;
 	}
 
+	// Called from the submit thread; only touches state that the acquiring thread leaves alone.
 	VkResult SwapChain::SubmitCommandBuffers(
-		const VkCommandBuffer* buffers, uint32_t* imageIndex) {
-		if (this->m_ImagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
-			vkWaitForFences(this->m_Device.GetDevice(), 1, &this->m_ImagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
-		}
-		this->m_ImagesInFlight[*imageIndex] = this->m_InFlightFences[this->m_CurrentFrame];
-
+		const VkCommandBuffer* buffers, uint32_t* imageIndex, uint64_t signalValue) {
 		VkSubmitInfo submitInfo = {};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-		VkSemaphore waitSemaphores[] = { this->m_ImageAvailableSemaphores[this->m_CurrentFrame] };
+		VkSemaphore waitSemaphores[] = { this->m_ImageAvailableSemaphores[this->m_SubmitFrame] };
 		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 		submitInfo.waitSemaphoreCount = 1;
 		submitInfo.pWaitSemaphores = waitSemaphores;
@@ -101,21 +115,30 @@ namespace Engine {
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = buffers;
 
-		VkSemaphore signalSemaphores[] = { this->m_RenderFinishedSemaphores[this->m_CurrentFrame] };
-		submitInfo.signalSemaphoreCount = 1;
+		VkSemaphore signalSemaphores[] = {
+			this->m_RenderFinishedSemaphores[this->m_SubmitFrame],
+			this->m_Device.GetFrameTimeline().GetSemaphore()
+		};
+		submitInfo.signalSemaphoreCount = 2;
 		submitInfo.pSignalSemaphores = signalSemaphores;
 
-		vkResetFences(this->m_Device.GetDevice(), 1, &this->m_InFlightFences[this->m_CurrentFrame]);
-		if (vkQueueSubmit(this->m_Device.GraphicsQueue(), 1, &submitInfo, this->m_InFlightFences[this->m_CurrentFrame]) !=
-			VK_SUCCESS) {
-			throw std::runtime_error("failed to submit draw command buffer!");
-		}
+		// binary semaphores ignore their value
+		uint64_t waitValues[] = { 0 };
+		uint64_t signalValues[] = { 0, signalValue };
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.waitSemaphoreValueCount = 1;
+		timelineInfo.pWaitSemaphoreValues = waitValues;
+		timelineInfo.signalSemaphoreValueCount = 2;
+		timelineInfo.pSignalSemaphoreValues = signalValues;
+		submitInfo.pNext = &timelineInfo;
 
 		VkPresentInfoKHR presentInfo = {};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
 		presentInfo.waitSemaphoreCount = 1;
-		presentInfo.pWaitSemaphores = signalSemaphores;
+		presentInfo.pWaitSemaphores = &this->m_RenderFinishedSemaphores[this->m_SubmitFrame];
 
 		VkSwapchainKHR swapChains[] = { this->m_SwapChain };
 		presentInfo.swapchainCount = 1;
@@ -123,9 +146,18 @@ namespace Engine {
 
 		presentInfo.pImageIndices = imageIndex;
 
-		auto result = vkQueuePresentKHR(this->m_Device.PresentQueue(), &presentInfo);
+		VkResult result;
+		{
+			std::lock_guard<std::mutex> queueLock(this->m_Device.GetQueueMutex());
+			if (vkQueueSubmit(this->m_Device.GraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+				throw std::runtime_error("failed to submit draw command buffer!");
+			}
+
+			std::lock_guard<std::mutex> swapChainLock(this->m_SwapChainMutex);
+			result = vkQueuePresentKHR(this->m_Device.PresentQueue(), &presentInfo);
+		}
 
-		this->m_CurrentFrame = (this->m_CurrentFrame + 1) % this->MAX_FRAMES_IN_FLIGHT;
+		this->m_SubmitFrame = (this->m_SubmitFrame + 1) % this->MAX_FRAMES_IN_FLIGHT;
 
 		return result;
 	}
@@ -137,7 +169,8 @@ namespace Engine {
 		VkPresentModeKHR presentMode = this->ChooseSwapPresentMode(swapChainSupport.PresentModes);
 		VkExtent2D extent = this->ChooseSwapExtent(swapChainSupport.Capabilities);
 
-		uint32_t imageCount = swapChainSupport.Capabilities.minImageCount + 1;
+		// room for every frame in flight to hold an image that the submit thread hasn't presented yet
+		uint32_t imageCount = swapChainSupport.Capabilities.minImageCount + this->MAX_FRAMES_IN_FLIGHT;
 		if (swapChainSupport.Capabilities.maxImageCount > 0 &&
 			imageCount > swapChainSupport.Capabilities.maxImageCount) {
 			imageCount = swapChainSupport.Capabilities.maxImageCount;
@@ -190,6 +223,7 @@ namespace Engine {
 
 		this->m_SwapChainImageFormat = surfaceFormat.format;
 		this->m_SwapChainExtent = extent;
+		this->m_MaxAcquiredImages = std::max(imageCount - swapChainSupport.Capabilities.minImageCount, 1u);
 	}
 
 	void SwapChain::CreateImageViews() {
@@ -273,6 +307,7 @@ namespace Engine {
 		if (vkCreateRenderPass(this->m_Device.GetDevice(), &renderPassInfo, nullptr, &this->m_RenderPass) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create render pass!");
 		}
+		this->m_Device.GetPipelineRegistry().RegisterRenderPass(this->m_RenderPass, renderPassInfo);
 	}
 
 	void SwapChain::CreateFramebuffers() {
@@ -349,22 +384,20 @@ namespace Engine {
 	void SwapChain::CreateSyncObjects() {
 		this->m_ImageAvailableSemaphores.resize(this->MAX_FRAMES_IN_FLIGHT);
 		this->m_RenderFinishedSemaphores.resize(this->MAX_FRAMES_IN_FLIGHT);
-		this->m_InFlightFences.resize(this->MAX_FRAMES_IN_FLIGHT);
-		this->m_ImagesInFlight.resize(this->ImageCount(), VK_NULL_HANDLE);
+
+		// a fresh swap chain inherits nothing in flight that the frame timeline doesn't already cover
+		uint64_t submittedValue = this->m_Device.GetFrameTimeline().GetSubmittedValue();
+		this->m_FrameTimelineValues.assign(this->MAX_FRAMES_IN_FLIGHT, submittedValue);
+		this->m_ImageTimelineValues.assign(this->ImageCount(), submittedValue);
 
 		VkSemaphoreCreateInfo semaphoreInfo = {};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		VkFenceCreateInfo fenceInfo = {};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
 		for (size_t i = 0; i < this->MAX_FRAMES_IN_FLIGHT; i++) {
 			if (vkCreateSemaphore(this->m_Device.GetDevice(), &semaphoreInfo, nullptr, &this->m_ImageAvailableSemaphores[i]) !=
 				VK_SUCCESS ||
 				vkCreateSemaphore(this->m_Device.GetDevice(), &semaphoreInfo, nullptr, &this->m_RenderFinishedSemaphores[i]) !=
-				VK_SUCCESS ||
-				vkCreateFence(this->m_Device.GetDevice(), &fenceInfo, nullptr, &this->m_InFlightFences[i]) != VK_SUCCESS) {
+				VK_SUCCESS) {
 				throw std::runtime_error("failed to create synchronization objects for a frame!");
 			}
 		}
@@ -8,6 +8,7 @@
 
 // std lib headers
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -30,6 +31,8 @@ namespace Engine {
 		inline VkExtent2D GetSwapChainExtent() { return this->m_SwapChainExtent; }
 		inline uint32_t GetWidth() { return this->m_SwapChainExtent.width; }
 		inline uint32_t GetHeight() { return this->m_SwapChainExtent.height; }
+		// how many images may be acquired but not yet presented without stalling vkAcquireNextImageKHR forever
+		inline uint32_t GetMaxAcquiredImages() { return this->m_MaxAcquiredImages; }
 
 		float ExtentAspectRatio() {
 			return static_cast<float>(this->m_SwapChainExtent.width) / static_cast<float>(this->m_SwapChainExtent.height);
@@ -37,7 +40,7 @@ namespace Engine {
 		VkFormat FindDepthFormat();
 
 		VkResult AcquireNextImage(uint32_t*);
-		VkResult SubmitCommandBuffers(const VkCommandBuffer*, uint32_t*);
+		VkResult SubmitCommandBuffers(const VkCommandBuffer*, uint32_t*, uint64_t);
 
 		inline bool CompareSwapFormats(const SwapChain& other) const {
 			return this->m_SwapChainImageFormat == other.m_SwapChainImageFormat &&
@@ -82,8 +85,18 @@ namespace Engine {
 
 		std::vector<VkSemaphore> m_ImageAvailableSemaphores;
 		std::vector<VkSemaphore> m_RenderFinishedSemaphores;
-		std::vector<VkFence> m_InFlightFences;
-		std::vector<VkFence> m_ImagesInFlight;
-		size_t m_CurrentFrame = 0;
+		// frame timeline values that must be reached before a frame slot / swap chain image can be reused
+		std::vector<uint64_t> m_FrameTimelineValues;
+		std::vector<uint64_t> m_ImageTimelineValues;
+
+		// acquiring and presenting happen on different threads but advance in lockstep
+		size_t m_AcquireFrame = 0;
+		size_t m_SubmitFrame = 0;
+		uint32_t m_MaxAcquiredImages = 1;
+
+		// the swap chain handle must be externally synchronized between acquire and present
+		std::mutex m_SwapChainMutex;
+		// nanoseconds an acquire may hold m_SwapChainMutex before letting a present in and trying again
+		static constexpr uint64_t ACQUIRE_TIMEOUT = 1000000;
 	};
 }
\ No newline at end of file
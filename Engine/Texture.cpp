@@ -0,0 +1,480 @@
+#include "./Texture.hpp"
+#include "./StagingBuffer.hpp"
+#include "./Utils/Hash.hpp"
+#include "./Utils/Ktx2File.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace Engine {
+	// copy regions into block compressed images have to start on a block, 16 covers every format accepted
+	constexpr VkDeviceSize STAGING_LEVEL_ALIGNMENT = 16;
+
+	SamplerCache::SamplerCache(Device& device) : m_Device{ device } {}
+
+	SamplerCache::~SamplerCache() {
+		for (auto& hashAndEntry : this->m_Samplers) {
+			vkDestroySampler(this->m_Device.GetDevice(), hashAndEntry.second.Sampler, nullptr);
+		}
+	}
+
+	VkSampler SamplerCache::GetSampler(const VkSamplerCreateInfo& createInfo) {
+		// field by field, floats through their bytes so -0.0 and 0.0 stay distinct like the driver sees them
+		std::vector<uint64_t> key;
+		AppendKeyBytes(key, createInfo.flags);
+		AppendKeyBytes(key, createInfo.magFilter);
+		AppendKeyBytes(key, createInfo.minFilter);
+		AppendKeyBytes(key, createInfo.mipmapMode);
+		AppendKeyBytes(key, createInfo.addressModeU);
+		AppendKeyBytes(key, createInfo.addressModeV);
+		AppendKeyBytes(key, createInfo.addressModeW);
+		AppendKeyBytes(key, createInfo.mipLodBias);
+		AppendKeyBytes(key, createInfo.anisotropyEnable);
+		AppendKeyBytes(key, createInfo.maxAnisotropy);
+		AppendKeyBytes(key, createInfo.compareEnable);
+		AppendKeyBytes(key, createInfo.compareOp);
+		AppendKeyBytes(key, createInfo.minLod);
+		AppendKeyBytes(key, createInfo.maxLod);
+		AppendKeyBytes(key, createInfo.borderColor);
+		AppendKeyBytes(key, createInfo.unnormalizedCoordinates);
+		const uint64_t hash = HashBytes(key.data(), key.size() * sizeof(uint64_t));
+
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+		auto candidates = this->m_Samplers.equal_range(hash);
+		for (auto found = candidates.first; found != candidates.second; ++found) {
+			if (found->second.Key == key) return found->second.Sampler;
+		}
+
+		VkSamplerCreateInfo samplerInfo = createInfo;
+		samplerInfo.pNext = nullptr;
+
+		VkSampler sampler;
+		if (vkCreateSampler(this->m_Device.GetDevice(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create texture sampler!");
+		}
+
+		this->m_Samplers.emplace(hash, SamplerEntry{ std::move(key), sampler });
+		return sampler;
+	}
+
+	VkSampler SamplerCache::GetDefaultSampler(VkSamplerAddressMode addressMode) {
+		VkSamplerCreateInfo samplerInfo{};
+		this->DefaultSamplerCreateInfo(samplerInfo, addressMode);
+		return this->GetSampler(samplerInfo);
+	}
+
+	void SamplerCache::DefaultSamplerCreateInfo(VkSamplerCreateInfo& samplerInfo, VkSamplerAddressMode addressMode) const {
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerInfo.addressModeU = addressMode;
+		samplerInfo.addressModeV = addressMode;
+		samplerInfo.addressModeW = addressMode;
+		samplerInfo.mipLodBias = 0.0f;
+		samplerInfo.anisotropyEnable = VK_TRUE;
+		samplerInfo.maxAnisotropy = this->m_Device.properties.limits.maxSamplerAnisotropy;
+		samplerInfo.compareEnable = VK_FALSE;
+		samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+		samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+		samplerInfo.unnormalizedCoordinates = VK_FALSE;
+	}
+
+
+	Texture::Texture(Device& device, const std::string& filePath) : m_Device{ device } {
+		Ktx2File file{ filePath };
+
+		this->m_Format = static_cast<VkFormat>(file.GetFormat());
+		this->m_Width = file.GetWidth();
+		this->m_Height = file.GetHeight();
+
+		std::vector<LevelData> levels(file.GetStoredLevelCount());
+		for (uint32_t i = 0; i < levels.size(); i++) {
+			levels[i] = { file.GetLevelData(i), file.GetLevelSize(i) };
+		}
+
+		// the mapping only has to outlive the copy into the staging buffer
+		this->Create(levels.data(), static_cast<uint32_t>(levels.size()), file.WantsGeneratedMips());
+	}
+
+	Texture::Texture(Device& device, const void* pixels, uint32_t width, uint32_t height, VkFormat format, bool generateMips)
+		: m_Device{ device }, m_Format{ format }, m_Width{ width }, m_Height{ height } {
+		const FormatBlock block = GetFormatBlock(format);
+		LevelData level{ pixels, static_cast<size_t>(block.Bytes) *
+			((width + block.Width - 1) / block.Width) * ((height + block.Height - 1) / block.Height) };
+
+		this->Create(&level, 1, generateMips);
+	}
+
+	Texture::~Texture() {
+		if (this->m_Residency != ResidencyManager::INVALID_HANDLE) {
+			this->m_Device.GetResidencyManager().Unregister(this->m_Residency);
+		}
+		// the table holds the slot back until frames in flight are done with it
+		if (this->m_BindlessTable != nullptr) {
+			this->m_BindlessTable->RemoveTexture(this->m_BindlessIndex);
+		}
+
+		// may still be sampled by frames in flight, the allocator defers the image the same way
+		this->DestroyImageView();
+		if (this->m_ImageAllocation != nullptr) {
+			this->m_Device.GetGpuAllocator().Destroy(this->m_ImageAllocation);
+		}
+	}
+
+	void Texture::Create(const LevelData* levels, uint32_t levelCount, bool generateMips) {
+		assert(this->m_Width > 0 && this->m_Height > 0 && "Texture must not be empty");
+
+		const FormatBlock block = GetFormatBlock(this->m_Format);
+		const bool compressed = block.Width > 1 || block.Height > 1;
+		if (compressed && !this->m_Device.SupportsTextureCompressionBC()) {
+			throw std::runtime_error("failed to create texture, block compressed formats are not supported!");
+		}
+
+		if (levelCount > GetFullMipCount(this->m_Width, this->m_Height)) {
+			throw std::runtime_error("failed to create texture, more mip levels than the extent allows!");
+		}
+
+		const VkFormatFeatureFlags features = this->m_Device.GetOptimalTilingFeatures(this->m_Format);
+		if ((features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0) {
+			throw std::runtime_error("failed to create texture, format can't be sampled!");
+		}
+
+		// blits can't write block compressed images, those only ever get the levels stored in the file
+		constexpr VkFormatFeatureFlags blitFeatures =
+			VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		const bool generate = generateMips && levelCount == 1 && !compressed &&
+			(features & blitFeatures) == blitFeatures && GetFullMipCount(this->m_Width, this->m_Height) > 1;
+
+		this->m_MipLevels = generate ? GetFullMipCount(this->m_Width, this->m_Height) : levelCount;
+
+		// every stored level into one staging buffer, checked against the size its extent needs
+		std::vector<VkBufferImageCopy> regions(levelCount);
+		std::vector<size_t> copySizes(levelCount);
+		VkDeviceSize stagingSize = 0;
+		for (uint32_t level = 0; level < levelCount; level++) {
+			const uint32_t width = std::max(this->m_Width >> level, 1u);
+			const uint32_t height = std::max(this->m_Height >> level, 1u);
+			const size_t expectedSize = static_cast<size_t>(block.Bytes) *
+				((width + block.Width - 1) / block.Width) * ((height + block.Height - 1) / block.Height);
+			if (levels[level].Size < expectedSize) {
+				throw std::runtime_error("failed to create texture, mip level data is truncated!");
+			}
+
+			stagingSize = (stagingSize + STAGING_LEVEL_ALIGNMENT - 1) & ~(STAGING_LEVEL_ALIGNMENT - 1);
+
+			VkBufferImageCopy& region = regions[level];
+			region = {};
+			region.bufferOffset = stagingSize;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageExtent = { width, height, 1 };
+
+			copySizes[level] = expectedSize;
+			stagingSize += expectedSize;
+		}
+
+		StagingBuffer staging{ this->m_Device, stagingSize };
+		for (uint32_t level = 0; level < levelCount; level++) {
+			staging.Write(levels[level].Data, copySizes[level], regions[level].bufferOffset);
+		}
+
+		// transfer source for the mip chain blits and for dropping mips later on
+		this->CreateImage(VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+
+		VkCommandBuffer commandBuffer = this->m_Device.BeginSingleTimeCommands();
+
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = this->m_Image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, this->m_MipLevels, 0, 1 };
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		vkCmdCopyBufferToImage(commandBuffer, staging.GetBuffer(), this->m_Image,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levelCount, regions.data());
+
+		if (generate) {
+			this->RecordMipChain(commandBuffer, this->m_MipLevels);
+		}
+		else {
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+
+		// no wait, the staging buffer is released with the frame that follows the upload
+		this->m_UploadValue = this->m_Device.EndSingleTimeCommandsDeferred(commandBuffer);
+
+		this->CreateImageView();
+		this->m_Sampler = this->m_Device.GetSamplerCache().GetDefaultSampler();
+
+		this->m_Residency = this->m_Device.GetResidencyManager().Register(this->m_MemorySize, ResidencyManager::Priority::Normal, [this]() {
+			this->DropTopMip();
+			return this->m_MemorySize;
+		});
+	}
+
+	bool Texture::DropTopMip() {
+		if (this->m_MipLevels <= 1) return false;
+
+		VkImage oldImage = this->m_Image;
+		GpuAllocator::Allocation* oldImageAllocation = this->m_ImageAllocation;
+
+		this->m_Width = std::max(this->m_Width >> 1, 1u);
+		this->m_Height = std::max(this->m_Height >> 1, 1u);
+		this->m_MipLevels--;
+		this->CreateImage(VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+
+		VkCommandBuffer commandBuffer = this->m_Device.BeginSingleTimeCommands();
+
+		// the old image's kept levels go to transfer source and back, frames in flight may still sample them
+		std::array<VkImageMemoryBarrier, 2> barriers{};
+		for (auto& barrier : barriers) {
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		}
+		barriers[0].image = oldImage;
+		barriers[0].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 1, this->m_MipLevels, 0, 1 };
+		barriers[0].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barriers[0].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barriers[0].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barriers[1].image = this->m_Image;
+		barriers[1].subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, this->m_MipLevels, 0, 1 };
+		barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barriers[1].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barriers[1].srcAccessMask = 0;
+		barriers[1].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+		std::vector<VkImageCopy> regions(this->m_MipLevels);
+		for (uint32_t level = 0; level < this->m_MipLevels; level++) {
+			VkImageCopy& region = regions[level];
+			region = {};
+			region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level + 1, 0, 1 };
+			region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+			region.extent = { std::max(this->m_Width >> level, 1u), std::max(this->m_Height >> level, 1u), 1 };
+		}
+		vkCmdCopyImage(commandBuffer,
+			oldImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			this->m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			static_cast<uint32_t>(regions.size()), regions.data());
+
+		barriers[0].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[0].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barriers[0].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barriers[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barriers[1].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barriers[1].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barriers[1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barriers[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+		this->m_UploadValue = this->m_Device.EndSingleTimeCommandsDeferred(commandBuffer);
+
+		this->DestroyImageView();
+		this->CreateImageView();
+		this->m_Device.GetGpuAllocator().Destroy(oldImageAllocation);
+
+		this->m_Version++;
+		this->MoveBindlessSlot();
+		return true;
+	}
+
+	uint32_t Texture::GetBindlessIndex(BindlessTable& table) {
+		assert((this->m_BindlessTable == nullptr || this->m_BindlessTable == &table) && "Texture is already in another bindless table");
+		if (this->m_BindlessTable == nullptr) {
+			this->m_BindlessIndex = table.AddTexture(*this);
+			this->m_BindlessTable = &table;
+		}
+		return this->m_BindlessIndex;
+	}
+
+	void Texture::MoveBindlessSlot() {
+		if (this->m_BindlessTable == nullptr) return;
+		this->m_BindlessIndex = this->m_BindlessTable->MoveTexture(this->m_BindlessIndex, *this);
+	}
+
+	void Texture::CreateImage(VkImageUsageFlags usage) {
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent = { this->m_Width, this->m_Height, 1 };
+		imageInfo.mipLevels = this->m_MipLevels;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = this->m_Format;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = usage;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		this->m_ImageAllocation = this->m_Device.GetGpuAllocator().CreateImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		this->m_Image = this->m_ImageAllocation->Image;
+		this->m_MemorySize = this->m_ImageAllocation->Size;
+
+		// the old view and bindless slot stay alive for frames in flight, frames recorded from now on use a new slot
+		this->m_ImageAllocation->OnMoved = [this]() {
+			this->m_Image = this->m_ImageAllocation->Image;
+			this->DestroyImageView();
+			this->CreateImageView();
+			this->m_Version++;
+			this->MoveBindlessSlot();
+		};
+	}
+
+	void Texture::CreateImageView() {
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = this->m_Image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = this->m_Format;
+		viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, this->m_MipLevels, 0, 1 };
+
+		if (vkCreateImageView(this->m_Device.GetDevice(), &viewInfo, nullptr, &this->m_ImageView) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create texture image view!");
+		}
+	}
+
+	void Texture::DestroyImageView() {
+		if (this->m_ImageView == VK_NULL_HANDLE) return;
+
+		VkDevice device = this->m_Device.GetDevice();
+		VkImageView imageView = this->m_ImageView;
+		this->m_Device.GetFrameTimeline().DeferDestroy([device, imageView]() {
+			vkDestroyImageView(device, imageView, nullptr);
+		});
+		this->m_ImageView = VK_NULL_HANDLE;
+	}
+
+	void Texture::RecordMipChain(VkCommandBuffer commandBuffer, uint32_t mipLevels) {
+		// each level is read from the one above it, which is moved to shader read as soon as it has been blitted
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = this->m_Image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+		int32_t mipWidth = static_cast<int32_t>(this->m_Width);
+		int32_t mipHeight = static_cast<int32_t>(this->m_Height);
+
+		for (uint32_t level = 1; level < mipLevels; level++) {
+			barrier.subresourceRange.baseMipLevel = level - 1;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			const int32_t nextWidth = std::max(mipWidth / 2, 1);
+			const int32_t nextHeight = std::max(mipHeight / 2, 1);
+
+			VkImageBlit blit{};
+			blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+			blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 };
+			blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+			blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+			vkCmdBlitImage(commandBuffer,
+				this->m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				this->m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				1, &blit, VK_FILTER_LINEAR);
+
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			mipWidth = nextWidth;
+			mipHeight = nextHeight;
+		}
+
+		// the last level is only ever written
+		barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+	Texture::FormatBlock Texture::GetFormatBlock(VkFormat format) {
+		switch (format) {
+		case VK_FORMAT_R8_UNORM:
+			return { 1, 1, 1 };
+		case VK_FORMAT_R8G8_UNORM:
+			return { 1, 1, 2 };
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			return { 1, 1, 4 };
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+			return { 1, 1, 8 };
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return { 1, 1, 16 };
+
+		// 4x4 blocks, 8 bytes for BC1 and BC4, 16 for the rest
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC4_SNORM_BLOCK:
+			return { 4, 4, 8 };
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC5_SNORM_BLOCK:
+		case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+		case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return { 4, 4, 16 };
+
+		default:
+			throw std::runtime_error("failed to create texture, unsupported format!");
+		}
+	}
+
+	uint32_t Texture::GetFullMipCount(uint32_t width, uint32_t height) {
+		uint32_t levels = 1;
+		for (uint32_t size = std::max(width, height); size > 1; size >>= 1) levels++;
+		return levels;
+	}
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "./Device.hpp"
+#include "./Descriptors.hpp"
+#include "./GpuAllocator.hpp"
+#include "./ResidencyManager.hpp"
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine {
+
+	// Deduplicates samplers by their create info, devices only guarantee a few thousand of them.
+	// Samplers live as long as the cache, callers never destroy them.
+	class SamplerCache : public NonMoveable, public NonCopyable {
+	public:
+		SamplerCache(Device&);
+		~SamplerCache();
+
+		// pNext is ignored, only the plain sampler state is part of the key
+		VkSampler GetSampler(const VkSamplerCreateInfo&);
+		// trilinear, anisotropic and unclamped LOD so one sampler serves every mip count
+		VkSampler GetDefaultSampler(VkSamplerAddressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT);
+
+		void DefaultSamplerCreateInfo(VkSamplerCreateInfo&, VkSamplerAddressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT) const;
+
+		inline size_t GetSamplerCount() const { return this->m_Samplers.size(); }
+
+	private:
+		// the full key is compared on a hit, so a hash collision can't hand out another sampler
+		struct SamplerEntry {
+			// create info fields without sType and pNext
+			std::vector<uint64_t> Key;
+			VkSampler Sampler;
+		};
+
+		Device& m_Device;
+
+		std::mutex m_Mutex;
+		std::unordered_multimap<uint64_t, SamplerEntry> m_Samplers;
+	};
+
+	// Sampled 2D image in device local memory. Block compressed KTX2 data is copied as is, so the image
+	// takes the compressed size on the GPU too, uncompressed sources get their mip chain blitted on the GPU.
+	// Uploads go through a StagingBuffer and don't block, the texture is usable in any later submission.
+	class Texture : public NonMoveable, public NonCopyable {
+	public:
+		// KTX2 container, BC1 - BC7 or any uncompressed format the device can sample
+		Texture(Device&, const std::string&);
+		// tightly packed pixels of the given format, mips are generated if requested
+		Texture(Device&, const void*, uint32_t, uint32_t, VkFormat = VK_FORMAT_R8G8B8A8_SRGB, bool = true);
+		~Texture();
+
+		inline VkImage GetImage() const { return this->m_Image; }
+		inline VkImageView GetImageView() const { return this->m_ImageView; }
+		inline VkSampler GetSampler() const { return this->m_Sampler; }
+		inline void SetSampler(VkSampler sampler) {
+			this->m_Sampler = sampler;
+			this->m_Version++;
+			this->MoveBindlessSlot();
+		}
+
+		inline VkFormat GetFormat() const { return this->m_Format; }
+		inline uint32_t GetWidth() const { return this->m_Width; }
+		inline uint32_t GetHeight() const { return this->m_Height; }
+		inline uint32_t GetMipLevels() const { return this->m_MipLevels; }
+		// device memory backing the image, mip chain included
+		inline VkDeviceSize GetMemorySize() const { return this->m_MemorySize; }
+		// frame timeline value after which the upload has landed
+		inline uint64_t GetUploadValue() const { return this->m_UploadValue; }
+
+		// marks the texture as sampled this frame for the residency manager
+		inline void Touch() { this->m_Device.GetResidencyManager().Touch(this->m_Residency); }
+		inline void SetResidencyPriority(ResidencyManager::Priority priority) { this->m_Device.GetResidencyManager().SetPriority(this->m_Residency, priority); }
+		// copies the smaller mips into a new image at half the extent on the GPU, false once a single mip is left
+		bool DropTopMip();
+		// changes whenever the image, view or sampler are replaced (mips dropped, the image moved or a new sampler),
+		// descriptors written from an older version have to be rewritten and the bindless index queried again
+		// before the next frame is recorded
+		inline uint32_t GetVersion() const { return this->m_Version; }
+		// the texture's slot in the table, added on the first call. The table has to outlive the texture and is
+		// the same on every call. The slot changes with the version, frames already recorded keep the old one
+		uint32_t GetBindlessIndex(BindlessTable&);
+
+		inline VkDescriptorImageInfo GetDescriptorInfo() const {
+			return { this->m_Sampler, this->m_ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+		}
+
+		// texel block size of the formats textures accept, throws for anything else
+		struct FormatBlock {
+			uint32_t Width;
+			uint32_t Height;
+			uint32_t Bytes;
+		};
+		static FormatBlock GetFormatBlock(VkFormat);
+		static uint32_t GetFullMipCount(uint32_t, uint32_t);
+
+	private:
+		struct LevelData {
+			const void* Data;
+			size_t Size;
+		};
+
+		void Create(const LevelData*, uint32_t, bool);
+		void CreateImage(VkImageUsageFlags);
+		void CreateImageView();
+		void DestroyImageView();
+		// moves to a new bindless slot after the view or sampler changed, the old one is still read by frames in flight
+		void MoveBindlessSlot();
+		void RecordMipChain(VkCommandBuffer, uint32_t);
+
+		Device& m_Device;
+
+		VkImage m_Image = VK_NULL_HANDLE;
+		// sub-allocated, image and view are replaced when the allocator's defragmentation moves it
+		GpuAllocator::Allocation* m_ImageAllocation = nullptr;
+		VkImageView m_ImageView = VK_NULL_HANDLE;
+		VkSampler m_Sampler = VK_NULL_HANDLE;
+
+		VkFormat m_Format;
+		uint32_t m_Width;
+		uint32_t m_Height;
+		uint32_t m_MipLevels = 1;
+		VkDeviceSize m_MemorySize = 0;
+		uint64_t m_UploadValue = 0;
+		uint32_t m_Version = 0;
+		ResidencyManager::Handle m_Residency = ResidencyManager::INVALID_HANDLE;
+		BindlessTable* m_BindlessTable = nullptr;
+		uint32_t m_BindlessIndex = BindlessTable::INVALID_INDEX;
+	};
+}
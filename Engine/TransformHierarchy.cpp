@@ -0,0 +1,236 @@
+#include "./TransformHierarchy.hpp"
+#include "./Utils/ParallelFor.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace Engine {
+	TransformHierarchy::TransformHierarchy() {
+		this->m_LevelStarts.push_back(0);
+	}
+
+	TransformHierarchy::~TransformHierarchy() {}
+
+	TransformHierarchy::NodeId TransformHierarchy::Create(NodeId parent, const Transform2DComponent& local) {
+		assert((parent == INVALID_NODE || this->m_Alive[parent]) && "Transform hierarchy parent doesn't exist");
+
+		NodeId node;
+		if (!this->m_FreeNodes.empty()) {
+			node = this->m_FreeNodes.back();
+			this->m_FreeNodes.pop_back();
+		} else {
+			node = static_cast<NodeId>(this->m_ParentOfNode.size());
+			this->m_ParentOfNode.push_back(INVALID_NODE);
+			this->m_IndexOfNode.push_back(INVALID_INDEX);
+			this->m_Alive.push_back(false);
+		}
+
+		// appended after everything, parents still come first, the levels are fixed up by the next sort
+		const uint32_t index = static_cast<uint32_t>(this->m_Node.size());
+		this->m_ParentOfNode[node] = parent;
+		this->m_IndexOfNode[node] = index;
+		this->m_Alive[node] = true;
+
+		this->m_Node.push_back(node);
+		this->m_Parent.push_back(parent == INVALID_NODE ? INVALID_INDEX : this->m_IndexOfNode[parent]);
+		this->m_Local.push_back(local);
+		this->m_WorldMatrix.emplace_back(1.0f);
+		this->m_WorldOffset.emplace_back(0.0f);
+		this->m_Dirty.push_back(0);
+
+		this->m_NeedsSort = true;
+		this->MarkDirty(index);
+		return node;
+	}
+
+	void TransformHierarchy::Destroy(NodeId node) {
+		assert(this->m_Alive[node] && "Transform hierarchy node destroyed twice");
+		this->m_Alive[node] = false;
+		this->m_NeedsSort = true;
+	}
+
+	void TransformHierarchy::SetParent(NodeId node, NodeId parent) {
+		for (NodeId ancestor = parent; ancestor != INVALID_NODE; ancestor = this->m_ParentOfNode[ancestor]) {
+			assert(ancestor != node && "Transform hierarchy parent would create a cycle");
+		}
+
+		const uint32_t index = this->GetIndex(node);
+		this->m_ParentOfNode[node] = parent;
+		this->m_Parent[index] = parent == INVALID_NODE ? INVALID_INDEX : this->GetIndex(parent);
+		this->m_NeedsSort = true;
+		this->MarkDirty(index);
+	}
+
+	void TransformHierarchy::SetLocal(NodeId node, const Transform2DComponent& local) {
+		const uint32_t index = this->GetIndex(node);
+		Transform2DComponent& current = this->m_Local[index];
+		if (current.Translation == local.Translation && current.Scale == local.Scale && current.Rotation == local.Rotation) return;
+
+		current = local;
+		this->MarkDirty(index);
+	}
+
+	void TransformHierarchy::Update() {
+		this->m_Stats.Sorted = this->m_NeedsSort;
+		this->m_Stats.UpdatedNodes = 0;
+		if (this->m_NeedsSort) this->Sort();
+		if (!this->m_AnyDirty) return;
+
+		const size_t levelCount = this->m_LevelStarts.size() - 1;
+		const auto& starts = this->m_LevelStarts;
+		std::atomic<uint32_t> updated{ 0 };
+
+		size_t level = this->m_FirstDirtyLevel;
+		while (level < levelCount) {
+			const size_t begin = starts[level];
+			if (starts[level + 1] - begin >= LEVEL_GRAIN) {
+				// siblings only read their parents, which the previous level finished
+				ParallelFor(starts[level + 1] - begin, LEVEL_GRAIN, [&](size_t chunkBegin, size_t chunkEnd) {
+					updated += this->Propagate(begin + chunkBegin, begin + chunkEnd);
+				});
+				level++;
+				continue;
+			}
+
+			// every parent comes before its children, so a run of narrow levels can be walked in one go
+			size_t next = level + 1;
+			while (next < levelCount && starts[next + 1] - starts[next] < LEVEL_GRAIN) next++;
+			updated += this->Propagate(begin, starts[next]);
+			level = next;
+		}
+
+		std::fill(this->m_Dirty.begin() + starts[this->m_FirstDirtyLevel], this->m_Dirty.end(), uint8_t{ 0 });
+		this->m_FirstDirtyLevel = static_cast<uint32_t>(levelCount);
+		this->m_AnyDirty = false;
+		this->m_Version++;
+		this->m_Stats.UpdatedNodes = updated;
+	}
+
+	void TransformHierarchy::MarkDirty(uint32_t index) {
+		this->m_Dirty[index] = 1;
+		this->m_AnyDirty = true;
+
+		// the sort finds the shallowest dirty level itself
+		if (this->m_NeedsSort) return;
+		const auto level = std::upper_bound(this->m_LevelStarts.begin(), this->m_LevelStarts.end(), index) - this->m_LevelStarts.begin() - 1;
+		this->m_FirstDirtyLevel = std::min(this->m_FirstDirtyLevel, static_cast<uint32_t>(level));
+	}
+
+	uint32_t TransformHierarchy::Propagate(size_t begin, size_t end) {
+		uint32_t updated = 0;
+
+		for (size_t i = begin; i < end; i++) {
+			const uint32_t parent = this->m_Parent[i];
+			if (parent != INVALID_INDEX && this->m_Dirty[parent]) this->m_Dirty[i] = 1;
+			if (!this->m_Dirty[i]) continue;
+
+			const Transform2DComponent& local = this->m_Local[i];
+			const glm::mat2 matrix = local.GetTransformMatrix();
+			if (parent == INVALID_INDEX) {
+				this->m_WorldMatrix[i] = matrix;
+				this->m_WorldOffset[i] = local.Translation;
+			} else {
+				this->m_WorldMatrix[i] = this->m_WorldMatrix[parent] * matrix;
+				this->m_WorldOffset[i] = this->m_WorldMatrix[parent] * local.Translation + this->m_WorldOffset[parent];
+			}
+			updated++;
+		}
+
+		return updated;
+	}
+
+	void TransformHierarchy::Sort() {
+		const size_t nodeCount = this->m_ParentOfNode.size();
+
+		// children of every node by id, counted then filled so siblings stay in id order
+		std::vector<uint32_t> childStarts(nodeCount + 1, 0);
+		std::vector<NodeId> roots;
+		for (NodeId node = 0; node < nodeCount; node++) {
+			if (!this->m_Alive[node]) continue;
+			const NodeId parent = this->m_ParentOfNode[node];
+			if (parent == INVALID_NODE) roots.push_back(node);
+			else childStarts[parent + 1]++;
+		}
+		for (size_t i = 0; i < nodeCount; i++) childStarts[i + 1] += childStarts[i];
+
+		std::vector<NodeId> children(childStarts[nodeCount]);
+		std::vector<uint32_t> childFill(childStarts.begin(), childStarts.end() - 1);
+		for (NodeId node = 0; node < nodeCount; node++) {
+			if (!this->m_Alive[node] || this->m_ParentOfNode[node] == INVALID_NODE) continue;
+			children[childFill[this->m_ParentOfNode[node]]++] = node;
+		}
+
+		// breadth first from the roots, descendants of destroyed nodes are never reached
+		std::vector<NodeId> order = std::move(roots);
+		order.reserve(nodeCount);
+		for (size_t i = 0; i < order.size(); i++) {
+			const NodeId node = order[i];
+			for (uint32_t child = childStarts[node]; child < childStarts[node + 1]; child++) {
+				if (this->m_Alive[children[child]]) order.push_back(children[child]);
+			}
+		}
+
+		std::vector<uint32_t> newIndexOfNode(nodeCount, INVALID_INDEX);
+		for (size_t i = 0; i < order.size(); i++) newIndexOfNode[order[i]] = static_cast<uint32_t>(i);
+
+		std::vector<uint32_t> parents(order.size());
+		std::vector<Transform2DComponent> locals(order.size());
+		std::vector<glm::mat2> worldMatrices(order.size());
+		std::vector<glm::vec2> worldOffsets(order.size());
+		std::vector<uint8_t> dirty(order.size());
+		std::vector<uint32_t> levelStarts;
+
+		for (size_t i = 0; i < order.size(); i++) {
+			const NodeId node = order[i];
+			const uint32_t oldIndex = this->m_IndexOfNode[node];
+			const NodeId parent = this->m_ParentOfNode[node];
+
+			parents[i] = parent == INVALID_NODE ? INVALID_INDEX : newIndexOfNode[parent];
+			locals[i] = this->m_Local[oldIndex];
+			worldMatrices[i] = this->m_WorldMatrix[oldIndex];
+			worldOffsets[i] = this->m_WorldOffset[oldIndex];
+			dirty[i] = this->m_Dirty[oldIndex];
+
+			// a node starts a new level when its parent sits at or past the start of the current one
+			if (levelStarts.empty() || (parents[i] != INVALID_INDEX && parents[i] >= levelStarts.back())) {
+				levelStarts.push_back(static_cast<uint32_t>(i));
+			}
+		}
+		levelStarts.push_back(static_cast<uint32_t>(order.size()));
+
+		// whatever wasn't reached was destroyed or hung below something that was
+		for (NodeId node = 0; node < nodeCount; node++) {
+			if (newIndexOfNode[node] != INVALID_INDEX || this->m_IndexOfNode[node] == INVALID_INDEX) continue;
+			this->m_Alive[node] = false;
+			this->m_ParentOfNode[node] = INVALID_NODE;
+			this->m_FreeNodes.push_back(node);
+		}
+
+		this->m_IndexOfNode = std::move(newIndexOfNode);
+		this->m_Node = std::move(order);
+		this->m_Parent = std::move(parents);
+		this->m_Local = std::move(locals);
+		this->m_WorldMatrix = std::move(worldMatrices);
+		this->m_WorldOffset = std::move(worldOffsets);
+		this->m_Dirty = std::move(dirty);
+		this->m_LevelStarts = std::move(levelStarts);
+		this->m_NeedsSort = false;
+
+		const size_t levelCount = this->m_LevelStarts.size() - 1;
+		this->m_FirstDirtyLevel = static_cast<uint32_t>(levelCount);
+		for (size_t level = 0; level < levelCount && this->m_AnyDirty; level++) {
+			const auto begin = this->m_Dirty.begin() + this->m_LevelStarts[level];
+			const auto end = this->m_Dirty.begin() + this->m_LevelStarts[level + 1];
+			if (std::find(begin, end, uint8_t{ 1 }) != end) {
+				this->m_FirstDirtyLevel = static_cast<uint32_t>(level);
+				break;
+			}
+		}
+		this->m_AnyDirty = this->m_FirstDirtyLevel < levelCount;
+
+		this->m_Stats.Nodes = static_cast<uint32_t>(this->m_Node.size());
+		this->m_Stats.Levels = static_cast<uint32_t>(levelCount);
+	}
+}
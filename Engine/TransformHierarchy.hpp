@@ -0,0 +1,116 @@
+#pragma once
+
+#include "./Utils/NonMoveable.hpp"
+#include "./Utils/NonCopyable.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std lib headers
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Engine {
+
+	struct Transform2DComponent {
+		glm::vec2 Translation{}; // position offset
+		glm::vec2 Scale{ 1.0f, 1.0f }; // scale
+		float Rotation; // rotation in radians
+
+		glm::mat2 GetTransformMatrix() const {
+			const float sinR = glm::sin(Rotation);
+			const float cosR = glm::cos(Rotation);
+
+			glm::mat2 rotationMatrix{ { cosR, sinR }, { -sinR, cosR } };
+			glm::mat2 scaleMatrix{ { Scale.x, .0f }, { .0f, Scale.y } };
+
+			return rotationMatrix * scaleMatrix ;
+		}
+	};
+
+	// Parent / child transforms kept as structure of arrays sorted breadth first, so every node comes after its
+	// parent and each depth is one contiguous range. Update walks the levels in order and recomputes only nodes
+	// whose own local transform or an ancestor's changed; levels wide enough are split across the worker pool,
+	// runs of narrow ones (deep chains) are walked on the calling thread. Structural changes re-sort lazily.
+	class TransformHierarchy : public NonMoveable, public NonCopyable {
+	public:
+		using NodeId = uint32_t;
+		static constexpr NodeId INVALID_NODE = std::numeric_limits<NodeId>::max();
+		// nodes per parallel chunk, narrower levels are merged with their neighbors and walked serially
+		static constexpr size_t LEVEL_GRAIN = 4096;
+
+		struct Stats {
+			uint32_t Nodes = 0;
+			uint32_t Levels = 0;
+			// of the last Update
+			uint32_t UpdatedNodes = 0;
+			bool Sorted = false;
+		};
+
+		TransformHierarchy();
+		~TransformHierarchy();
+
+		NodeId Create(NodeId = INVALID_NODE, const Transform2DComponent& = Transform2DComponent{});
+		// the node's whole subtree goes with it at the next Update
+		void Destroy(NodeId);
+		// keeps the local transform, so the node moves with its new parent
+		void SetParent(NodeId, NodeId);
+		// only marks the node dirty when the transform actually differs
+		void SetLocal(NodeId, const Transform2DComponent&);
+
+		inline NodeId GetParent(NodeId node) const { return this->m_ParentOfNode[node]; }
+		inline const Transform2DComponent& GetLocal(NodeId node) const { return this->m_Local[this->GetIndex(node)]; }
+		// valid after Update, world = matrix * local position + offset
+		inline const glm::mat2& GetWorldMatrix(NodeId node) const { return this->m_WorldMatrix[this->GetIndex(node)]; }
+		inline const glm::vec2& GetWorldOffset(NodeId node) const { return this->m_WorldOffset[this->GetIndex(node)]; }
+
+		// re-sorts after structural changes and propagates world transforms through the dirty subtrees
+		void Update();
+
+		// changes whenever an Update recomputed any world transform
+		inline uint64_t GetVersion() const { return this->m_Version; }
+		inline size_t Size() const { return this->m_Parent.size(); }
+		inline const Stats& GetStats() const { return this->m_Stats; }
+
+	private:
+		// roots' parent and the index of ids that aren't in use
+		static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+		// sorted index of a node, which must not have been freed by a sort since it was destroyed
+		inline uint32_t GetIndex(NodeId node) const {
+			assert(node < this->m_IndexOfNode.size() && this->m_IndexOfNode[node] != INVALID_INDEX && "Transform hierarchy node was freed");
+			return this->m_IndexOfNode[node];
+		}
+		void Sort();
+		void MarkDirty(uint32_t);
+		// nodes [begin, end) of levels whose parents are all up to date already, returns how many were recomputed
+		uint32_t Propagate(size_t, size_t);
+
+		// by node id, stable across re-sorts
+		std::vector<NodeId> m_ParentOfNode;
+		std::vector<uint32_t> m_IndexOfNode;
+		std::vector<bool> m_Alive;
+		std::vector<NodeId> m_FreeNodes;
+
+		// by sorted index
+		std::vector<NodeId> m_Node;
+		std::vector<uint32_t> m_Parent;
+		std::vector<Transform2DComponent> m_Local;
+		std::vector<glm::mat2> m_WorldMatrix;
+		std::vector<glm::vec2> m_WorldOffset;
+		std::vector<uint8_t> m_Dirty;
+		// first index of every depth plus one past the last node
+		std::vector<uint32_t> m_LevelStarts;
+
+		// the shallowest level with a dirty node, levels above it are skipped
+		uint32_t m_FirstDirtyLevel = 0;
+		bool m_AnyDirty = false;
+		bool m_NeedsSort = false;
+		uint64_t m_Version = 0;
+
+		Stats m_Stats;
+	};
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "./InlineFunction.hpp"
+#include "./NonMoveable.hpp"
+#include "./NonCopyable.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+// Callbacks waiting for a counter (FrameTimeline's semaphore value) to reach the value they were queued for. Kept
+// sorted by value, callbacks are almost always queued for the newest one. Both lists keep their capacity, so once
+// warmed up queueing and collecting don't touch the heap. Queueing is safe from any thread, collecting isn't.
+class CallbackQueue : public NonMoveable, public NonCopyable {
+public:
+	// room for eight handles or pointers, enough for every deferred destruction, and no allocation per callback
+	using Callback = InlineFunction<64>;
+
+	void Queue(uint64_t value, Callback callback) {
+		std::lock_guard<std::mutex> lock(this->m_Mutex);
+		auto position = this->m_Pending.end();
+		while (position != this->m_Pending.begin() && std::prev(position)->Value > value) {
+			--position;
+		}
+		this->m_Pending.insert(position, { value, std::move(callback) });
+	}
+
+	// runs every callback queued for the given value or an earlier one
+	void Collect(uint64_t completed) {
+		{
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			auto end = std::find_if(this->m_Pending.begin(), this->m_Pending.end(),
+				[completed](const Pending& pending) { return pending.Value > completed; });
+			std::move(this->m_Pending.begin(), end, std::back_inserter(this->m_Ready));
+			this->m_Pending.erase(this->m_Pending.begin(), end);
+		}
+
+		// callbacks run unlocked, they are free to queue further callbacks
+		for (auto& ready : this->m_Ready) {
+			ready.Function();
+		}
+		this->m_Ready.clear();
+	}
+
+private:
+	struct Pending {
+		uint64_t Value;
+		Callback Function;
+	};
+
+	std::mutex m_Mutex;
+	std::vector<Pending> m_Pending;
+	// taken out of the pending list by Collect and run unlocked
+	std::vector<Pending> m_Ready;
+};
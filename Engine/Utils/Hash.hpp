@@ -0,0 +1,62 @@
+#pragma once
+
+// std lib headers
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Fast non-cryptographic 64 bit hash, consumes 8 bytes per step so it stays cheap on large blobs.
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0x9e3779b97f4a7c15ull) {
+	constexpr uint64_t multiplier = 0xff51afd7ed558ccdull;
+	auto mix = [](uint64_t value) {
+		value ^= value >> 33;
+		value *= 0xc4ceb9fe1a85ec53ull;
+		value ^= value >> 33;
+		return value;
+	};
+
+	const auto* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = seed ^ (size * multiplier);
+
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		uint64_t word;
+		std::memcpy(&word, bytes + i, sizeof(word));
+		hash = (hash ^ mix(word * multiplier)) * multiplier;
+	}
+
+	uint64_t tail = 0;
+	for (size_t shift = 0; i < size; i++, shift += 8) {
+		tail |= static_cast<uint64_t>(bytes[i]) << shift;
+	}
+	hash = (hash ^ mix(tail * multiplier)) * multiplier;
+
+	return mix(hash);
+}
+
+inline void HashCombine(uint64_t& seed, uint64_t value) {
+	seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+// Hashes the object representation, only meant for plain structs without padding or pointers to follow.
+template<typename T>
+inline void HashCombineBytes(uint64_t& seed, const T& value) {
+	static_assert(std::is_trivially_copyable<T>::value, "HashCombineBytes needs a trivially copyable type");
+	HashCombine(seed, HashBytes(&value, sizeof(T)));
+}
+
+// Full keys for caches that compare on a hit rather than trust a 64 bit hash: whole words appended field by field,
+// hashed with HashBytes for the lookup. Bytes are zero padded to the next word so padding never differs
+template<typename Words>
+inline void AppendKeyBytes(Words& words, const void* data, size_t size) {
+	const size_t offset = words.size();
+	words.resize(offset + (size + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+	if (size > 0) std::memcpy(words.data() + offset, data, size);
+}
+
+template<typename Words, typename T>
+inline void AppendKeyBytes(Words& words, const T& value) {
+	static_assert(std::is_trivially_copyable<T>::value, "AppendKeyBytes needs a trivially copyable type");
+	AppendKeyBytes(words, &value, sizeof(T));
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// std lib headers
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move only void() callable stored in place, for callbacks queued every frame where std::function would allocate.
+// A capture bigger than the capacity fails to compile instead of spilling to the heap.
+template<size_t Capacity>
+class InlineFunction {
+public:
+	InlineFunction() = default;
+
+	template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, InlineFunction>::value>>
+	InlineFunction(F&& function) {
+		using Stored = std::decay_t<F>;
+		static_assert(sizeof(Stored) <= Capacity, "InlineFunction capture is bigger than its capacity");
+		static_assert(alignof(Stored) <= alignof(std::max_align_t), "InlineFunction capture is over aligned");
+
+		new (&this->m_Storage) Stored(std::forward<F>(function));
+		this->m_Invoke = [](void* storage) { (*static_cast<Stored*>(storage))(); };
+		// moves into the destination when there is one, then destroys the source
+		this->m_Relocate = [](void* destination, void* source) {
+			if (destination != nullptr) new (destination) Stored(std::move(*static_cast<Stored*>(source)));
+			static_cast<Stored*>(source)->~Stored();
+		};
+	}
+
+	InlineFunction(InlineFunction&& other) noexcept { this->MoveFrom(other); }
+	InlineFunction& operator=(InlineFunction&& other) noexcept {
+		if (this != &other) {
+			this->Reset();
+			this->MoveFrom(other);
+		}
+		return *this;
+	}
+	InlineFunction(const InlineFunction&) = delete;
+	InlineFunction& operator=(const InlineFunction&) = delete;
+
+	~InlineFunction() { this->Reset(); }
+
+	inline void operator()() { this->m_Invoke(&this->m_Storage); }
+	inline explicit operator bool() const { return this->m_Invoke != nullptr; }
+
+	void Reset() {
+		if (this->m_Relocate != nullptr) this->m_Relocate(nullptr, &this->m_Storage);
+		this->m_Invoke = nullptr;
+		this->m_Relocate = nullptr;
+	}
+
+private:
+	void MoveFrom(InlineFunction& other) {
+		if (other.m_Relocate == nullptr) return;
+		other.m_Relocate(&this->m_Storage, &other.m_Storage);
+		this->m_Invoke = other.m_Invoke;
+		this->m_Relocate = other.m_Relocate;
+		other.m_Invoke = nullptr;
+		other.m_Relocate = nullptr;
+	}
+
+	alignas(std::max_align_t) unsigned char m_Storage[Capacity];
+	void (*m_Invoke)(void*) = nullptr;
+	void (*m_Relocate)(void*, void*) = nullptr;
+};
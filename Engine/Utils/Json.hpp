@@ -0,0 +1,261 @@
+#pragma once
+
+// std lib headers
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal JSON document, enough for asset metadata such as glTF. Lookups of missing keys or indices
+// yield a null value instead of throwing, so optional fields read as defaults.
+class JsonValue {
+public:
+	enum class Type { Null, Bool, Number, String, Array, Object };
+
+	JsonValue() = default;
+
+	static JsonValue Parse(const char* data, size_t size) {
+		Parser parser{ data, data + size };
+		parser.SkipWhitespace();
+		JsonValue value = parser.ParseValue(0);
+		parser.SkipWhitespace();
+		if (parser.Current != parser.End) {
+			throw std::runtime_error("Unexpected data after JSON document");
+		}
+		return value;
+	}
+
+	inline Type GetType() const { return this->m_Type; }
+	inline bool IsNull() const { return this->m_Type == Type::Null; }
+	inline bool IsNumber() const { return this->m_Type == Type::Number; }
+	inline bool IsString() const { return this->m_Type == Type::String; }
+	inline bool IsArray() const { return this->m_Type == Type::Array; }
+	inline bool IsObject() const { return this->m_Type == Type::Object; }
+
+	inline bool GetBool(bool fallback = false) const { return this->m_Type == Type::Bool ? this->m_Bool : fallback; }
+	inline double GetNumber(double fallback = 0.0) const { return this->m_Type == Type::Number ? this->m_Number : fallback; }
+	inline const std::string& GetString() const { return this->m_String; }
+
+	// element count of arrays and objects, 0 for everything else
+	inline size_t Size() const { return this->m_Type == Type::Array ? this->m_Array.size() : this->m_Object.size(); }
+
+	const JsonValue& operator[](size_t index) const {
+		return this->m_Type == Type::Array && index < this->m_Array.size() ? this->m_Array[index] : Null();
+	}
+
+	const JsonValue& operator[](const std::string& key) const {
+		for (const auto& member : this->m_Object) {
+			if (member.first == key) return member.second;
+		}
+		return Null();
+	}
+
+	inline bool Has(const std::string& key) const { return !(*this)[key].IsNull(); }
+
+	inline const std::vector<JsonValue>& GetArray() const { return this->m_Array; }
+	inline const std::vector<std::pair<std::string, JsonValue>>& GetObject() const { return this->m_Object; }
+
+private:
+	// deeper documents are rejected instead of overflowing the stack
+	static constexpr int MAX_DEPTH = 256;
+
+	static const JsonValue& Null() {
+		static const JsonValue null;
+		return null;
+	}
+
+	struct Parser {
+		const char* Current;
+		const char* End;
+
+		[[noreturn]] void Fail(const char* message) const {
+			throw std::runtime_error(std::string("Invalid JSON: ") + message);
+		}
+
+		void SkipWhitespace() {
+			while (this->Current != this->End && (*this->Current == ' ' || *this->Current == '\t' || *this->Current == '\n' || *this->Current == '\r')) {
+				this->Current++;
+			}
+		}
+
+		bool Consume(const char* literal) {
+			const char* cursor = this->Current;
+			for (; *literal != '\0'; literal++, cursor++) {
+				if (cursor == this->End || *cursor != *literal) return false;
+			}
+			this->Current = cursor;
+			return true;
+		}
+
+		JsonValue ParseValue(int depth) {
+			if (depth > MAX_DEPTH) this->Fail("nested too deeply");
+			if (this->Current == this->End) this->Fail("unexpected end");
+
+			JsonValue value;
+			switch (*this->Current) {
+			case '{': value.m_Type = Type::Object; this->ParseObject(value, depth); break;
+			case '[': value.m_Type = Type::Array; this->ParseArray(value, depth); break;
+			case '"': value.m_Type = Type::String; value.m_String = this->ParseString(); break;
+			case 't':
+			case 'f':
+				value.m_Type = Type::Bool;
+				if (this->Consume("true")) value.m_Bool = true;
+				else if (this->Consume("false")) value.m_Bool = false;
+				else this->Fail("bad literal");
+				break;
+			case 'n':
+				if (!this->Consume("null")) this->Fail("bad literal");
+				break;
+			default:
+				value.m_Type = Type::Number;
+				value.m_Number = this->ParseNumber();
+				break;
+			}
+			return value;
+		}
+
+		void ParseObject(JsonValue& value, int depth) {
+			this->Current++;
+			this->SkipWhitespace();
+			if (this->Current != this->End && *this->Current == '}') {
+				this->Current++;
+				return;
+			}
+
+			while (true) {
+				this->SkipWhitespace();
+				if (this->Current == this->End || *this->Current != '"') this->Fail("expected key");
+				std::string key = this->ParseString();
+
+				this->SkipWhitespace();
+				if (this->Current == this->End || *this->Current != ':') this->Fail("expected ':'");
+				this->Current++;
+				this->SkipWhitespace();
+				value.m_Object.emplace_back(std::move(key), this->ParseValue(depth + 1));
+
+				this->SkipWhitespace();
+				if (this->Current == this->End) this->Fail("unterminated object");
+				if (*this->Current == '}') { this->Current++; return; }
+				if (*this->Current != ',') this->Fail("expected ',' or '}'");
+				this->Current++;
+			}
+		}
+
+		void ParseArray(JsonValue& value, int depth) {
+			this->Current++;
+			this->SkipWhitespace();
+			if (this->Current != this->End && *this->Current == ']') {
+				this->Current++;
+				return;
+			}
+
+			while (true) {
+				this->SkipWhitespace();
+				value.m_Array.push_back(this->ParseValue(depth + 1));
+
+				this->SkipWhitespace();
+				if (this->Current == this->End) this->Fail("unterminated array");
+				if (*this->Current == ']') { this->Current++; return; }
+				if (*this->Current != ',') this->Fail("expected ',' or ']'");
+				this->Current++;
+			}
+		}
+
+		double ParseNumber() {
+			const char* start = this->Current;
+			while (this->Current != this->End) {
+				const char c = *this->Current;
+				if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') this->Current++;
+				else break;
+			}
+			if (start == this->Current) this->Fail("unexpected character");
+
+			// strtod needs a terminated string, numbers are short
+			const std::string text(start, this->Current);
+			char* parsedEnd = nullptr;
+			const double number = std::strtod(text.c_str(), &parsedEnd);
+			if (parsedEnd != text.c_str() + text.size()) this->Fail("bad number");
+			return number;
+		}
+
+		uint32_t ParseHex4() {
+			if (this->End - this->Current < 4) this->Fail("bad escape");
+			uint32_t code = 0;
+			for (int i = 0; i < 4; i++) {
+				const char c = *this->Current++;
+				code <<= 4;
+				if (c >= '0' && c <= '9') code |= c - '0';
+				else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+				else this->Fail("bad escape");
+			}
+			return code;
+		}
+
+		static void AppendUtf8(std::string& text, uint32_t code) {
+			if (code < 0x80) {
+				text += static_cast<char>(code);
+			} else if (code < 0x800) {
+				text += static_cast<char>(0xc0 | (code >> 6));
+				text += static_cast<char>(0x80 | (code & 0x3f));
+			} else if (code < 0x10000) {
+				text += static_cast<char>(0xe0 | (code >> 12));
+				text += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+				text += static_cast<char>(0x80 | (code & 0x3f));
+			} else {
+				text += static_cast<char>(0xf0 | (code >> 18));
+				text += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+				text += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+				text += static_cast<char>(0x80 | (code & 0x3f));
+			}
+		}
+
+		std::string ParseString() {
+			this->Current++;
+			std::string text;
+			while (true) {
+				if (this->Current == this->End) this->Fail("unterminated string");
+				const char c = *this->Current++;
+				if (c == '"') return text;
+				if (c != '\\') {
+					text += c;
+					continue;
+				}
+
+				if (this->Current == this->End) this->Fail("unterminated string");
+				switch (*this->Current++) {
+				case '"': text += '"'; break;
+				case '\\': text += '\\'; break;
+				case '/': text += '/'; break;
+				case 'b': text += '\b'; break;
+				case 'f': text += '\f'; break;
+				case 'n': text += '\n'; break;
+				case 'r': text += '\r'; break;
+				case 't': text += '\t'; break;
+				case 'u': {
+					uint32_t code = this->ParseHex4();
+					// surrogate pairs encode code points past the basic plane
+					if (code >= 0xd800 && code < 0xdc00 && this->Consume("\\u")) {
+						const uint32_t low = this->ParseHex4();
+						if (low < 0xdc00 || low >= 0xe000) this->Fail("bad surrogate pair");
+						code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+					}
+					AppendUtf8(text, code);
+					break;
+				}
+				default: this->Fail("bad escape");
+				}
+			}
+		}
+	};
+
+	Type m_Type = Type::Null;
+	bool m_Bool = false;
+	double m_Number = 0.0;
+	std::string m_String;
+	std::vector<JsonValue> m_Array;
+	std::vector<std::pair<std::string, JsonValue>> m_Object;
+};
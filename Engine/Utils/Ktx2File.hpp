@@ -0,0 +1,103 @@
+#pragma once
+
+#include "./MappedFile.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Fixed part of a KTX2 file (https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html), little endian:
+//   identifier, Ktx2Header, Ktx2Index, Ktx2LevelIndex[max(LevelCount, 1)], data format descriptor, key / values, level data
+// Level 0 is the full resolution image. A level count of 0 asks the loader to generate the mip chain itself.
+constexpr unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+constexpr uint32_t KTX2_SUPERCOMPRESSION_NONE = 0;
+
+struct Ktx2Header {
+	// a VkFormat, VK_FORMAT_UNDEFINED (0) for Basis Universal payloads
+	uint32_t VkFormat;
+	uint32_t TypeSize;
+	uint32_t PixelWidth;
+	uint32_t PixelHeight;
+	uint32_t PixelDepth;
+	uint32_t LayerCount;
+	uint32_t FaceCount;
+	uint32_t LevelCount;
+	uint32_t SupercompressionScheme;
+};
+static_assert(sizeof(Ktx2Header) == 36, "Ktx2Header layout is part of the file format");
+
+struct Ktx2Index {
+	uint32_t DfdByteOffset;
+	uint32_t DfdByteLength;
+	uint32_t KvdByteOffset;
+	uint32_t KvdByteLength;
+	uint64_t SgdByteOffset;
+	uint64_t SgdByteLength;
+};
+static_assert(sizeof(Ktx2Index) == 32, "Ktx2Index layout is part of the file format");
+
+struct Ktx2LevelIndex {
+	uint64_t ByteOffset;
+	uint64_t ByteLength;
+	uint64_t UncompressedByteLength;
+};
+static_assert(sizeof(Ktx2LevelIndex) == 24, "Ktx2LevelIndex layout is part of the file format");
+
+// Read-only view of a KTX2 file. Only what the GPU can consume as is gets accepted: no supercompression,
+// so block compressed payloads go straight into the staging buffer without a CPU decode.
+class Ktx2File {
+public:
+	explicit Ktx2File(const std::string& filePath) : m_File{ filePath } {
+		const auto* bytes = static_cast<const unsigned char*>(this->m_File.GetData());
+		const size_t size = this->m_File.GetSize();
+
+		constexpr size_t levelsOffset = sizeof(KTX2_IDENTIFIER) + sizeof(Ktx2Header) + sizeof(Ktx2Index);
+		if (size < levelsOffset || std::memcmp(bytes, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+			throw std::runtime_error("Not a KTX2 file: " + filePath);
+		}
+
+		std::memcpy(&this->m_Header, bytes + sizeof(KTX2_IDENTIFIER), sizeof(Ktx2Header));
+		if (this->m_Header.SupercompressionScheme != KTX2_SUPERCOMPRESSION_NONE || this->m_Header.VkFormat == 0) {
+			throw std::runtime_error("Supercompressed KTX2 files are not supported: " + filePath);
+		}
+		if (this->m_Header.PixelWidth == 0 || this->m_Header.PixelDepth > 1 ||
+			this->m_Header.LayerCount > 1 || this->m_Header.FaceCount != 1) {
+			throw std::runtime_error("Only single 2D KTX2 images are supported: " + filePath);
+		}
+
+		const uint32_t storedLevels = this->GetStoredLevelCount();
+		if (storedLevels > 32 || levelsOffset + static_cast<uint64_t>(storedLevels) * sizeof(Ktx2LevelIndex) > size) {
+			throw std::runtime_error("Invalid KTX2 level index in: " + filePath);
+		}
+
+		this->m_Levels = reinterpret_cast<const Ktx2LevelIndex*>(bytes + levelsOffset);
+		for (uint32_t i = 0; i < storedLevels; i++) {
+			const auto& level = this->m_Levels[i];
+			if (level.ByteLength == 0 || level.ByteOffset > size || level.ByteLength > size - level.ByteOffset) {
+				throw std::runtime_error("Corrupt KTX2 level in: " + filePath);
+			}
+		}
+	}
+
+	inline const Ktx2Header& GetHeader() const { return this->m_Header; }
+	inline uint32_t GetWidth() const { return this->m_Header.PixelWidth; }
+	// 1D images store a height of 0
+	inline uint32_t GetHeight() const { return this->m_Header.PixelHeight > 0 ? this->m_Header.PixelHeight : 1; }
+	inline uint32_t GetFormat() const { return this->m_Header.VkFormat; }
+
+	// true if the file only holds the base level and wants the rest generated
+	inline bool WantsGeneratedMips() const { return this->m_Header.LevelCount == 0; }
+	inline uint32_t GetStoredLevelCount() const { return this->m_Header.LevelCount > 0 ? this->m_Header.LevelCount : 1; }
+
+	inline const void* GetLevelData(uint32_t level) const {
+		return static_cast<const unsigned char*>(this->m_File.GetData()) + this->m_Levels[level].ByteOffset;
+	}
+	inline size_t GetLevelSize(uint32_t level) const { return static_cast<size_t>(this->m_Levels[level].ByteLength); }
+
+private:
+	MappedFile m_File;
+	Ktx2Header m_Header{};
+	const Ktx2LevelIndex* m_Levels = nullptr;
+};
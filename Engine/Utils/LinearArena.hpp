@@ -0,0 +1,124 @@
+#pragma once
+
+#include "./NonMoveable.hpp"
+#include "./NonCopyable.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Bump allocator for short lived data, everything is released at once by Reset.
+// Requests that don't fit spill into separate heap blocks, and the next Reset grows the arena to the
+// observed peak, so after a warm-up frame or two a steady workload never touches the heap.
+class LinearArena : public NonMoveable, public NonCopyable {
+public:
+	static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+	explicit LinearArena(size_t capacity = DEFAULT_CAPACITY) : m_Capacity{ capacity } {
+		this->m_Buffer = static_cast<std::byte*>(std::malloc(capacity));
+		if (this->m_Buffer == nullptr) throw std::bad_alloc();
+		// reserved up front so recording a spill never reallocates in the middle of a frame
+		this->m_OverflowBlocks.reserve(16);
+	}
+
+	~LinearArena() {
+		this->ReleaseOverflowBlocks();
+		std::free(this->m_Buffer);
+	}
+
+	void* Allocate(size_t size, size_t alignment) {
+		const uintptr_t base = reinterpret_cast<uintptr_t>(this->m_Buffer);
+		const uintptr_t aligned = (base + this->m_Offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+		const size_t end = static_cast<size_t>(aligned - base) + size;
+
+		this->m_Requested += size + alignment - 1;
+
+		if (end <= this->m_Capacity) {
+			this->m_Offset = end;
+			return reinterpret_cast<void*>(aligned);
+		}
+
+		this->m_OverflowCount++;
+		void* block = ::operator new(size, std::align_val_t{ std::max(alignment, alignof(std::max_align_t)) });
+		this->m_OverflowBlocks.push_back({ block, std::max(alignment, alignof(std::max_align_t)) });
+		return block;
+	}
+
+	void Reset() {
+		if (!this->m_OverflowBlocks.empty()) {
+			this->ReleaseOverflowBlocks();
+
+			// grow once to what the last frame needed in total, with headroom for small fluctuations
+			size_t capacity = std::max(this->m_Capacity * 2, this->m_Requested + this->m_Requested / 2);
+			auto* buffer = static_cast<std::byte*>(std::malloc(capacity));
+			if (buffer == nullptr) throw std::bad_alloc();
+			std::free(this->m_Buffer);
+			this->m_Buffer = buffer;
+			this->m_Capacity = capacity;
+		}
+
+		this->m_Offset = 0;
+		this->m_Requested = 0;
+	}
+
+	inline size_t GetUsed() const { return this->m_Offset; }
+	inline size_t GetCapacity() const { return this->m_Capacity; }
+	// number of allocations that had to fall back to the heap since creation
+	inline size_t GetOverflowCount() const { return this->m_OverflowCount; }
+
+private:
+	struct OverflowBlock {
+		void* Pointer;
+		size_t Alignment;
+	};
+
+	void ReleaseOverflowBlocks() {
+		for (auto& block : this->m_OverflowBlocks) {
+			::operator delete(block.Pointer, std::align_val_t{ block.Alignment });
+		}
+		this->m_OverflowBlocks.clear();
+	}
+
+	std::byte* m_Buffer = nullptr;
+	size_t m_Capacity = 0;
+	size_t m_Offset = 0;
+	// upper bound of what the current frame would have needed without spilling
+	size_t m_Requested = 0;
+
+	size_t m_OverflowCount = 0;
+	std::vector<OverflowBlock> m_OverflowBlocks;
+};
+
+// STL allocator adapter, deallocation is a no-op since the arena is reset wholesale.
+template<typename T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+
+	ArenaAllocator(LinearArena& arena) noexcept : m_Arena{ &arena } {}
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) noexcept : m_Arena{ other.GetArena() } {}
+
+	T* allocate(size_t count) {
+		return static_cast<T*>(this->m_Arena->Allocate(count * sizeof(T), alignof(T)));
+	}
+	void deallocate(T*, size_t) noexcept {}
+
+	inline LinearArena* GetArena() const noexcept { return this->m_Arena; }
+
+	template<typename U>
+	bool operator==(const ArenaAllocator<U>& other) const noexcept { return this->m_Arena == other.GetArena(); }
+	template<typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const noexcept { return this->m_Arena != other.GetArena(); }
+
+private:
+	LinearArena* m_Arena;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "./NonCopyable.hpp"
+
+// std lib headers
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file. The mapping is page aligned, so its contents can be
+// handed to APIs with alignment requirements (SPIR-V code, packed binary formats) without copying.
+class MappedFile : public NonCopyable {
+public:
+	MappedFile() = default;
+
+	explicit MappedFile(const std::string& filePath) {
+		int file = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+		if (file < 0) {
+			throw std::runtime_error("Failed to open file: " + filePath);
+		}
+
+		struct stat info;
+		if (::fstat(file, &info) != 0) {
+			::close(file);
+			throw std::runtime_error("Failed to stat file: " + filePath);
+		}
+		this->m_Size = static_cast<size_t>(info.st_size);
+
+		if (this->m_Size > 0) {
+			void* data = ::mmap(nullptr, this->m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (data == MAP_FAILED) {
+				::close(file);
+				throw std::runtime_error("Failed to map file: " + filePath);
+			}
+			this->m_Data = data;
+		}
+
+		// the mapping keeps its own reference to the file
+		::close(file);
+	}
+
+	~MappedFile() { this->Unmap(); }
+
+	MappedFile(MappedFile&& other) noexcept
+		: m_Data{ std::exchange(other.m_Data, nullptr) }, m_Size{ std::exchange(other.m_Size, 0) } {}
+
+	MappedFile& operator=(MappedFile&& other) noexcept {
+		if (this != &other) {
+			this->Unmap();
+			this->m_Data = std::exchange(other.m_Data, nullptr);
+			this->m_Size = std::exchange(other.m_Size, 0);
+		}
+		return *this;
+	}
+
+	inline const void* GetData() const { return this->m_Data; }
+	inline size_t GetSize() const { return this->m_Size; }
+	inline bool IsMapped() const { return this->m_Data != nullptr; }
+
+private:
+	void Unmap() {
+		if (this->m_Data != nullptr) {
+			::munmap(this->m_Data, this->m_Size);
+			this->m_Data = nullptr;
+			this->m_Size = 0;
+		}
+	}
+
+	void* m_Data = nullptr;
+	size_t m_Size = 0;
+};
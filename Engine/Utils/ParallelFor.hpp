@@ -0,0 +1,155 @@
+#pragma once
+
+#include "./NonMoveable.hpp"
+#include "./NonCopyable.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads shared by every ParallelFor call, started on first use. The calling thread
+// always works on its own job as well, so nested and concurrent calls make progress even with every worker busy.
+// One thread per core unless the WORKER_THREADS environment variable asks for another count, which is how the
+// parallel paths get exercised on a single core.
+class WorkerPool : public NonMoveable, public NonCopyable {
+public:
+	static WorkerPool& Get() {
+		static WorkerPool pool;
+		return pool;
+	}
+
+	// workers plus the calling thread
+	inline size_t GetThreadCount() const { return this->m_Workers.size() + 1; }
+
+	// calls function(begin, end) for consecutive chunks of at most grainSize covering [0, count), returns once all
+	// of them finished; the first exception thrown by a chunk is rethrown here and stops further chunks
+	void Run(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& function) {
+		if (count == 0) return;
+		grainSize = std::max<size_t>(grainSize, 1);
+		if (count <= grainSize || this->m_Workers.empty()) {
+			function(0, count);
+			return;
+		}
+
+		Job job{ function, count, grainSize };
+		{
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			this->m_Jobs.push_back(&job);
+		}
+		this->m_WorkAvailable.notify_all();
+
+		this->Execute(job);
+
+		// the job lives on this stack frame, so it can only go once no worker still holds it
+		std::unique_lock<std::mutex> lock(this->m_Mutex);
+		this->Retire(job);
+		this->m_JobFinished.wait(lock, [&job]() { return job.ActiveWorkers == 0; });
+		if (job.Error) {
+			std::rethrow_exception(job.Error);
+		}
+	}
+
+private:
+	struct Job {
+		Job(const std::function<void(size_t, size_t)>& function, size_t count, size_t grainSize)
+			: Function{ function }, Count{ count }, GrainSize{ grainSize } {}
+
+		const std::function<void(size_t, size_t)>& Function;
+		const size_t Count;
+		const size_t GrainSize;
+		std::atomic<size_t> Next{ 0 };
+		std::atomic<bool> Failed{ false };
+
+		// guarded by m_Mutex
+		size_t ActiveWorkers = 0;
+		std::exception_ptr Error;
+	};
+
+	WorkerPool() {
+		size_t threadCount = std::thread::hardware_concurrency();
+		if (const char* requested = std::getenv("WORKER_THREADS")) {
+			threadCount = std::strtoul(requested, nullptr, 10);
+		}
+		threadCount = std::max<size_t>(threadCount, 1);
+		for (size_t i = 1; i < threadCount; i++) {
+			this->m_Workers.emplace_back([this]() { this->WorkerLoop(); });
+		}
+	}
+
+	~WorkerPool() {
+		{
+			std::lock_guard<std::mutex> lock(this->m_Mutex);
+			this->m_Stop = true;
+		}
+		this->m_WorkAvailable.notify_all();
+		for (auto& worker : this->m_Workers) {
+			worker.join();
+		}
+	}
+
+	void Execute(Job& job) {
+		while (!job.Failed.load(std::memory_order_relaxed)) {
+			const size_t begin = job.Next.fetch_add(job.GrainSize, std::memory_order_relaxed);
+			if (begin >= job.Count) break;
+
+			try {
+				job.Function(begin, std::min(begin + job.GrainSize, job.Count));
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(this->m_Mutex);
+				if (!job.Error) job.Error = std::current_exception();
+				job.Failed.store(true, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// takes a job without chunks left off the queue, called with m_Mutex held
+	void Retire(Job& job) {
+		auto it = std::find(this->m_Jobs.begin(), this->m_Jobs.end(), &job);
+		if (it != this->m_Jobs.end()) {
+			this->m_Jobs.erase(it);
+		}
+	}
+
+	void WorkerLoop() {
+		std::unique_lock<std::mutex> lock(this->m_Mutex);
+		while (true) {
+			this->m_WorkAvailable.wait(lock, [this]() { return this->m_Stop || !this->m_Jobs.empty(); });
+			if (this->m_Stop) return;
+
+			Job& job = *this->m_Jobs.front();
+			job.ActiveWorkers++;
+			lock.unlock();
+
+			this->Execute(job);
+
+			lock.lock();
+			this->Retire(job);
+			if (--job.ActiveWorkers == 0) {
+				this->m_JobFinished.notify_all();
+			}
+		}
+	}
+
+	std::vector<std::thread> m_Workers;
+	std::deque<Job*> m_Jobs;
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkAvailable;
+	std::condition_variable m_JobFinished;
+	bool m_Stop = false;
+};
+
+// Runs function(begin, end) over [0, count) in chunks of at most grainSize spread across the worker pool.
+// Chunks run concurrently and in no particular order, pick the grain so a chunk is worth a few microseconds.
+template<typename Function>
+inline void ParallelFor(size_t count, size_t grainSize, Function&& function) {
+	WorkerPool::Get().Run(count, grainSize, std::function<void(size_t, size_t)>(std::ref(function)));
+}
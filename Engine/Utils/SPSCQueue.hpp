@@ -0,0 +1,45 @@
+#pragma once
+
+#include "./NonMoveable.hpp"
+#include "./NonCopyable.hpp"
+
+// std lib headers
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+template<typename T, size_t Capacity>
+class SPSCQueue : public NonMoveable, public NonCopyable {
+public:
+	static_assert(Capacity > 0, "SPSCQueue needs room for at least one element");
+
+	bool TryPush(const T& value) {
+		const size_t tail = this->m_Tail.load(std::memory_order_relaxed);
+		if (tail - this->m_Head.load(std::memory_order_acquire) == Capacity) return false;
+
+		this->m_Slots[tail % Capacity] = value;
+		this->m_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TryPop(T& value) {
+		const size_t head = this->m_Head.load(std::memory_order_relaxed);
+		if (head == this->m_Tail.load(std::memory_order_acquire)) return false;
+
+		value = this->m_Slots[head % Capacity];
+		this->m_Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool IsEmpty() const {
+		return this->m_Head.load(std::memory_order_acquire) == this->m_Tail.load(std::memory_order_acquire);
+	}
+
+private:
+	std::array<T, Capacity> m_Slots{};
+
+	// monotonically increasing, kept on separate cache lines so producer and consumer don't false share
+	alignas(64) std::atomic<size_t> m_Head{ 0 };
+	alignas(64) std::atomic<size_t> m_Tail{ 0 };
+};
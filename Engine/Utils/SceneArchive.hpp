@@ -0,0 +1,227 @@
+#pragma once
+
+#include "./MappedFile.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// On-disk layout of a binary scene, all little endian, offsets from the start of the file:
+//   SceneArchiveHeader
+//   SceneMeshEntry[MeshCount]
+//   SceneObjectEntry[ObjectCount]
+//   blobs                            vertex and index data, each aligned to SCENE_ARCHIVE_BLOB_ALIGNMENT
+// Blobs are stored exactly as the GPU reads them, a loader hands the mapped bytes to the upload as is.
+// Opening only touches the header and the two tables, never the blobs.
+constexpr uint32_t SCENE_ARCHIVE_MAGIC = 0x454e4353; // "SCNE"
+constexpr uint32_t SCENE_ARCHIVE_VERSION = 1;
+constexpr uint64_t SCENE_ARCHIVE_BLOB_ALIGNMENT = 16;
+
+// vertex layouts a mesh can be stored in
+enum SceneVertexFormat : uint32_t {
+	// vec2 position, vec3 color, matches Model::Vertex
+	SCENE_VERTEX_FORMAT_POSITION2_COLOR3 = 1,
+};
+
+struct SceneArchiveHeader {
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t MeshCount;
+	uint32_t ObjectCount;
+	uint64_t MeshesOffset;
+	uint64_t ObjectsOffset;
+	uint64_t FileSize;
+	uint64_t Reserved;
+};
+static_assert(sizeof(SceneArchiveHeader) == 48, "SceneArchiveHeader layout is part of the file format");
+
+struct SceneMeshEntry {
+	uint64_t VertexOffset;
+	uint64_t IndexOffset;
+	uint32_t VertexCount;
+	// 0 for meshes drawn without an index buffer
+	uint32_t IndexCount;
+	uint32_t VertexFormat;
+	uint32_t VertexStride;
+	// 2 or 4 bytes per index
+	uint32_t IndexSize;
+	uint32_t Reserved;
+};
+static_assert(sizeof(SceneMeshEntry) == 40, "SceneMeshEntry layout is part of the file format");
+
+struct SceneObjectEntry {
+	float Translation[2];
+	float Scale[2];
+	float Rotation;
+	float Color[3];
+	uint32_t MeshIndex;
+	uint32_t Reserved;
+};
+static_assert(sizeof(SceneObjectEntry) == 40, "SceneObjectEntry layout is part of the file format");
+
+// Read-only view of a scene file, the whole file is a single mapping and nothing is copied on open.
+class SceneArchive {
+public:
+	SceneArchive() = default;
+
+	explicit SceneArchive(const std::string& filePath) : m_File{ filePath } {
+		const auto* bytes = static_cast<const unsigned char*>(this->m_File.GetData());
+		const uint64_t size = this->m_File.GetSize();
+
+		if (size < sizeof(SceneArchiveHeader)) {
+			throw std::runtime_error("Scene archive is truncated: " + filePath);
+		}
+		this->m_Header = reinterpret_cast<const SceneArchiveHeader*>(bytes);
+
+		const auto& header = *this->m_Header;
+		const bool valid =
+			header.Magic == SCENE_ARCHIVE_MAGIC &&
+			header.Version == SCENE_ARCHIVE_VERSION &&
+			header.FileSize == size &&
+			header.MeshesOffset % alignof(SceneMeshEntry) == 0 &&
+			header.ObjectsOffset % alignof(SceneObjectEntry) == 0 &&
+			header.MeshesOffset <= size && header.MeshCount <= (size - header.MeshesOffset) / sizeof(SceneMeshEntry) &&
+			header.ObjectsOffset <= size && header.ObjectCount <= (size - header.ObjectsOffset) / sizeof(SceneObjectEntry);
+		if (!valid) {
+			throw std::runtime_error("Invalid scene archive: " + filePath);
+		}
+
+		this->m_Meshes = reinterpret_cast<const SceneMeshEntry*>(bytes + header.MeshesOffset);
+		this->m_Objects = reinterpret_cast<const SceneObjectEntry*>(bytes + header.ObjectsOffset);
+
+		// bounds only, the blobs themselves stay untouched until a mesh is uploaded
+		for (uint32_t i = 0; i < header.MeshCount; i++) {
+			const auto& mesh = this->m_Meshes[i];
+			const bool meshValid =
+				mesh.VertexStride != 0 &&
+				mesh.VertexOffset % SCENE_ARCHIVE_BLOB_ALIGNMENT == 0 && mesh.IndexOffset % SCENE_ARCHIVE_BLOB_ALIGNMENT == 0 &&
+				mesh.VertexOffset <= size && mesh.VertexCount <= (size - mesh.VertexOffset) / mesh.VertexStride &&
+				(mesh.IndexCount == 0 || ((mesh.IndexSize == 2 || mesh.IndexSize == 4) &&
+					mesh.IndexOffset <= size && mesh.IndexCount <= (size - mesh.IndexOffset) / mesh.IndexSize));
+			if (!meshValid) {
+				throw std::runtime_error("Corrupt scene archive mesh in: " + filePath);
+			}
+		}
+	}
+
+	inline bool IsOpen() const { return this->m_Header != nullptr; }
+	inline uint32_t GetMeshCount() const { return this->IsOpen() ? this->m_Header->MeshCount : 0; }
+	inline uint32_t GetObjectCount() const { return this->IsOpen() ? this->m_Header->ObjectCount : 0; }
+
+	inline const SceneMeshEntry& GetMesh(uint32_t index) const { return this->m_Meshes[index]; }
+	inline const SceneObjectEntry& GetObject(uint32_t index) const { return this->m_Objects[index]; }
+
+	inline const void* GetVertexData(const SceneMeshEntry& mesh) const {
+		return static_cast<const unsigned char*>(this->m_File.GetData()) + mesh.VertexOffset;
+	}
+	inline const void* GetIndexData(const SceneMeshEntry& mesh) const {
+		return static_cast<const unsigned char*>(this->m_File.GetData()) + mesh.IndexOffset;
+	}
+
+private:
+	MappedFile m_File;
+	const SceneArchiveHeader* m_Header = nullptr;
+	const SceneMeshEntry* m_Meshes = nullptr;
+	const SceneObjectEntry* m_Objects = nullptr;
+};
+
+// Collects meshes and objects and writes them out in the layout SceneArchive maps.
+class SceneArchiveWriter {
+public:
+	// returns the mesh index objects refer to, the data is copied
+	uint32_t AddMesh(const void* vertices, uint32_t vertexCount, uint32_t vertexStride, uint32_t vertexFormat,
+		const void* indices = nullptr, uint32_t indexCount = 0, uint32_t indexSize = 4) {
+		PendingMesh mesh{};
+		mesh.Entry.VertexCount = vertexCount;
+		mesh.Entry.VertexStride = vertexStride;
+		mesh.Entry.VertexFormat = vertexFormat;
+		mesh.Entry.IndexCount = indexCount;
+		mesh.Entry.IndexSize = indexSize;
+
+		const auto* vertexBytes = static_cast<const unsigned char*>(vertices);
+		mesh.Vertices.assign(vertexBytes, vertexBytes + static_cast<size_t>(vertexCount) * vertexStride);
+		if (indexCount > 0) {
+			const auto* indexBytes = static_cast<const unsigned char*>(indices);
+			mesh.Indices.assign(indexBytes, indexBytes + static_cast<size_t>(indexCount) * indexSize);
+		}
+
+		this->m_Meshes.push_back(std::move(mesh));
+		return static_cast<uint32_t>(this->m_Meshes.size() - 1);
+	}
+
+	void AddObject(const SceneObjectEntry& object) {
+		if (object.MeshIndex >= this->m_Meshes.size()) {
+			throw std::runtime_error("Scene object refers to a mesh that wasn't added");
+		}
+		this->m_Objects.push_back(object);
+	}
+
+	void Write(const std::string& filePath) {
+		auto align = [](uint64_t offset) { return (offset + SCENE_ARCHIVE_BLOB_ALIGNMENT - 1) & ~(SCENE_ARCHIVE_BLOB_ALIGNMENT - 1); };
+
+		SceneArchiveHeader header{};
+		header.Magic = SCENE_ARCHIVE_MAGIC;
+		header.Version = SCENE_ARCHIVE_VERSION;
+		header.MeshCount = static_cast<uint32_t>(this->m_Meshes.size());
+		header.ObjectCount = static_cast<uint32_t>(this->m_Objects.size());
+		header.MeshesOffset = sizeof(SceneArchiveHeader);
+		header.ObjectsOffset = header.MeshesOffset + sizeof(SceneMeshEntry) * this->m_Meshes.size();
+
+		uint64_t offset = header.ObjectsOffset + sizeof(SceneObjectEntry) * this->m_Objects.size();
+		for (auto& mesh : this->m_Meshes) {
+			offset = align(offset);
+			mesh.Entry.VertexOffset = offset;
+			offset += mesh.Vertices.size();
+
+			offset = align(offset);
+			mesh.Entry.IndexOffset = offset;
+			offset += mesh.Indices.size();
+		}
+		header.FileSize = offset;
+
+		std::FILE* file = std::fopen(filePath.c_str(), "wb");
+		if (file == nullptr) {
+			throw std::runtime_error("Failed to create scene archive: " + filePath);
+		}
+
+		uint64_t written = 0;
+		auto write = [&](const void* data, size_t size) {
+			if (size > 0 && std::fwrite(data, 1, size, file) != size) {
+				std::fclose(file);
+				throw std::runtime_error("Failed to write scene archive: " + filePath);
+			}
+			written += size;
+		};
+		auto pad = [&](uint64_t target) {
+			static const unsigned char zeros[SCENE_ARCHIVE_BLOB_ALIGNMENT] = {};
+			write(zeros, static_cast<size_t>(target - written));
+		};
+
+		write(&header, sizeof(header));
+		for (const auto& mesh : this->m_Meshes) write(&mesh.Entry, sizeof(SceneMeshEntry));
+		write(this->m_Objects.data(), sizeof(SceneObjectEntry) * this->m_Objects.size());
+		for (const auto& mesh : this->m_Meshes) {
+			pad(mesh.Entry.VertexOffset);
+			write(mesh.Vertices.data(), mesh.Vertices.size());
+			pad(mesh.Entry.IndexOffset);
+			write(mesh.Indices.data(), mesh.Indices.size());
+		}
+
+		if (std::fclose(file) != 0) {
+			throw std::runtime_error("Failed to write scene archive: " + filePath);
+		}
+	}
+
+private:
+	struct PendingMesh {
+		SceneMeshEntry Entry;
+		std::vector<unsigned char> Vertices;
+		std::vector<unsigned char> Indices;
+	};
+
+	std::vector<PendingMesh> m_Meshes;
+	std::vector<SceneObjectEntry> m_Objects;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "./Hash.hpp"
+#include "./MappedFile.hpp"
+
+// std lib headers
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// On-disk layout of the packed shader archive written by Tools/ShaderPacker, all little endian:
+//   ShaderArchiveHeader
+//   ShaderArchiveEntry[EntryCount]
+//   uint32_t buckets[BucketCount]   open addressed by name hash, entry index or SHADER_ARCHIVE_EMPTY_BUCKET
+//   names                            not null terminated, referenced by offset / length
+//   blobs                            SPIR-V, each aligned to SHADER_ARCHIVE_BLOB_ALIGNMENT
+constexpr uint32_t SHADER_ARCHIVE_MAGIC = 0x52414853; // "SHAR"
+constexpr uint32_t SHADER_ARCHIVE_VERSION = 1;
+constexpr uint32_t SHADER_ARCHIVE_EMPTY_BUCKET = UINT32_MAX;
+constexpr uint32_t SHADER_ARCHIVE_BLOB_ALIGNMENT = 16;
+
+struct ShaderArchiveHeader {
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t EntryCount;
+	// power of two, at least twice the entry count so probes stay short
+	uint32_t BucketCount;
+	uint32_t EntriesOffset;
+	uint32_t BucketsOffset;
+	uint32_t NamesOffset;
+	uint32_t FileSize;
+};
+static_assert(sizeof(ShaderArchiveHeader) == 32, "ShaderArchiveHeader layout is part of the file format");
+
+struct ShaderArchiveEntry {
+	uint64_t NameHash;
+	// HashBytes of the blob, the same key ShaderRegistry uses for loose files
+	uint64_t ContentHash;
+	uint32_t NameOffset;
+	uint32_t NameLength;
+	uint32_t DataOffset;
+	uint32_t DataSize;
+};
+static_assert(sizeof(ShaderArchiveEntry) == 32, "ShaderArchiveEntry layout is part of the file format");
+
+inline uint64_t HashShaderArchiveName(std::string_view name) {
+	return HashBytes(name.data(), name.size());
+}
+
+// Read-only view of an archive, the whole file is a single mapping and lookups never copy.
+class ShaderArchive {
+public:
+	ShaderArchive() = default;
+
+	explicit ShaderArchive(const std::string& filePath) : m_File{ filePath } {
+		const auto* bytes = static_cast<const unsigned char*>(this->m_File.GetData());
+		const size_t size = this->m_File.GetSize();
+
+		if (size < sizeof(ShaderArchiveHeader)) {
+			throw std::runtime_error("Shader archive is truncated: " + filePath);
+		}
+		this->m_Header = reinterpret_cast<const ShaderArchiveHeader*>(bytes);
+
+		const auto& header = *this->m_Header;
+		const bool valid =
+			header.Magic == SHADER_ARCHIVE_MAGIC &&
+			header.Version == SHADER_ARCHIVE_VERSION &&
+			header.FileSize == size &&
+			header.BucketCount != 0 && (header.BucketCount & (header.BucketCount - 1)) == 0 &&
+			header.EntryCount < header.BucketCount &&
+			header.EntriesOffset + static_cast<uint64_t>(header.EntryCount) * sizeof(ShaderArchiveEntry) <= size &&
+			header.BucketsOffset + static_cast<uint64_t>(header.BucketCount) * sizeof(uint32_t) <= size &&
+			header.NamesOffset <= size;
+		if (!valid) {
+			throw std::runtime_error("Invalid shader archive: " + filePath);
+		}
+
+		this->m_Entries = reinterpret_cast<const ShaderArchiveEntry*>(bytes + header.EntriesOffset);
+		this->m_Buckets = reinterpret_cast<const uint32_t*>(bytes + header.BucketsOffset);
+
+		for (uint32_t i = 0; i < header.EntryCount; i++) {
+			const auto& entry = this->m_Entries[i];
+			if (header.NamesOffset + static_cast<uint64_t>(entry.NameOffset) + entry.NameLength > size ||
+				static_cast<uint64_t>(entry.DataOffset) + entry.DataSize > size ||
+				entry.DataOffset % SHADER_ARCHIVE_BLOB_ALIGNMENT != 0) {
+				throw std::runtime_error("Corrupt shader archive entry in: " + filePath);
+			}
+		}
+	}
+
+	inline bool IsOpen() const { return this->m_Header != nullptr; }
+	inline uint32_t GetEntryCount() const { return this->IsOpen() ? this->m_Header->EntryCount : 0; }
+	inline const ShaderArchiveEntry& GetEntry(uint32_t index) const { return this->m_Entries[index]; }
+
+	// nullptr if the archive has no shader of that name
+	const ShaderArchiveEntry* Find(std::string_view name) const {
+		if (!this->IsOpen()) return nullptr;
+
+		const uint64_t nameHash = HashShaderArchiveName(name);
+		const uint32_t mask = this->m_Header->BucketCount - 1;
+
+		for (uint32_t bucket = static_cast<uint32_t>(nameHash) & mask;; bucket = (bucket + 1) & mask) {
+			const uint32_t index = this->m_Buckets[bucket];
+			if (index == SHADER_ARCHIVE_EMPTY_BUCKET || index >= this->m_Header->EntryCount) return nullptr;
+
+			const auto& entry = this->m_Entries[index];
+			if (entry.NameHash == nameHash && this->GetName(entry) == name) return &entry;
+		}
+	}
+
+	inline std::string_view GetName(const ShaderArchiveEntry& entry) const {
+		const auto* names = static_cast<const char*>(this->m_File.GetData()) + this->m_Header->NamesOffset;
+		return std::string_view(names + entry.NameOffset, entry.NameLength);
+	}
+
+	inline const void* GetData(const ShaderArchiveEntry& entry) const {
+		return static_cast<const unsigned char*>(this->m_File.GetData()) + entry.DataOffset;
+	}
+
+private:
+	MappedFile m_File;
+	const ShaderArchiveHeader* m_Header = nullptr;
+	const ShaderArchiveEntry* m_Entries = nullptr;
+	const uint32_t* m_Buckets = nullptr;
+};
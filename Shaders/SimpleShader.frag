@@ -1,15 +1,10 @@
 #version 450
 
-layout (location = 0) out vec4 Color;
-
+layout (location = 0) in vec3 FragColor;
 
-layout (push_constant) uniform PushConstants {
-	mat2 Transform;
-	vec2 Offset;
-	vec3 Color;
-} pushConstants;
+layout (location = 0) out vec4 Color;
 
 
 void main() {
-	Color = vec4(pushConstants.Color, 1.0);
+	Color = vec4(FragColor, 1.0);
 }
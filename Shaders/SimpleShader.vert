@@ -3,12 +3,30 @@
 layout (location = 0) in vec2 Position;
 layout (location = 1) in vec3 Color;
 
-layout (push_constant) uniform PushConstants {
+layout (location = 0) out vec3 FragColor;
+
+// specialized per pipeline, the untaken branch is compiled out
+layout (constant_id = 0) const bool USE_VERTEX_COLOR = false;
+
+struct ObjectData {
 	mat2 Transform;
 	vec2 Offset;
 	vec3 Color;
-} pushConstants;
+};
+
+layout (set = 0, binding = 0) uniform GlobalData {
+	vec4 Transform; // mat2 packed by columns
+	vec2 Offset;
+} globalData;
+
+layout (std430, set = 0, binding = 1) readonly buffer ObjectBuffer {
+	ObjectData objects[];
+} objectBuffer;
 
 void main() {
-	gl_Position = vec4(pushConstants.Transform * Position + pushConstants.Offset, 0.0, 1.0);
+	ObjectData object = objectBuffer.objects[gl_InstanceIndex];
+	mat2 view = mat2(globalData.Transform.xy, globalData.Transform.zw);
+
+	gl_Position = vec4(view * (object.Transform * Position + object.Offset) + globalData.Offset, 0.0, 1.0);
+	FragColor = USE_VERTEX_COLOR ? Color : object.Color;
 }
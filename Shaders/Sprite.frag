@@ -0,0 +1,16 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (location = 0) in vec2 FragTexCoord;
+layout (location = 1) in vec4 FragColor;
+layout (location = 2) flat in uint FragTexture;
+
+layout (location = 0) out vec4 Color;
+
+// the renderer's bindless table, sprites of one draw can each use a different texture
+layout (set = 1, binding = 0) uniform sampler2D textures[];
+
+
+void main() {
+	Color = texture(textures[nonuniformEXT(FragTexture)], FragTexCoord) * FragColor;
+}
@@ -0,0 +1,24 @@
+#version 450
+
+layout (location = 0) in vec2 Position;
+layout (location = 1) in vec2 TexCoord;
+layout (location = 2) in vec4 Color;
+layout (location = 3) in uint Texture;
+
+layout (location = 0) out vec2 FragTexCoord;
+layout (location = 1) out vec4 FragColor;
+layout (location = 2) flat out uint FragTexture;
+
+layout (set = 0, binding = 0) uniform GlobalData {
+	vec4 Transform; // mat2 packed by columns
+	vec2 Offset;
+} globalData;
+
+void main() {
+	mat2 view = mat2(globalData.Transform.xy, globalData.Transform.zw);
+
+	gl_Position = vec4(view * Position + globalData.Offset, 0.0, 1.0);
+	FragTexCoord = TexCoord;
+	FragColor = Color;
+	FragTexture = Texture;
+}
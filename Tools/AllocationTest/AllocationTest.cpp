@@ -0,0 +1,129 @@
+// Counts heap allocations made by the per frame building blocks once they are warmed up, which should be none.
+// usage: AllocationTest
+// Replays a frame loop the way the renderer drives it: the frame arena is reset, draw lists and sort keys are built
+// in it, and deferred callbacks go through the CallbackQueue FrameTimeline collects from. Exits non zero on any allocation.
+
+#include "../../Engine/Utils/CallbackQueue.hpp"
+#include "../../Engine/Utils/LinearArena.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+namespace {
+	std::atomic<size_t> g_Allocations{ 0 };
+
+	void* CountedAllocate(size_t size, size_t alignment) {
+		g_Allocations++;
+		void* pointer = nullptr;
+		if (posix_memalign(&pointer, std::max(alignment, sizeof(void*)), size == 0 ? 1 : size) != 0) throw std::bad_alloc();
+		return pointer;
+	}
+}
+
+void* operator new(size_t size) { return CountedAllocate(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return CountedAllocate(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return CountedAllocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return CountedAllocate(size, static_cast<size_t>(alignment)); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+namespace {
+	constexpr uint32_t WARMUP_FRAMES = 8;
+	constexpr uint32_t MEASURED_FRAMES = 1000;
+	constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+	// more than the arena's default capacity holds, so the first frame spills and the arena has to grow
+	constexpr uint32_t OBJECT_COUNT = 4096;
+
+	struct DrawItem {
+		uint64_t SortKey;
+		const void* Model;
+		uint32_t Lod;
+		uint32_t Instance;
+	};
+
+	struct FrameLoop {
+		LinearArena Arenas[FRAMES_IN_FLIGHT];
+		// the queue FrameTimeline runs its callbacks from, the semaphore value stands in for the frame number
+		CallbackQueue Callbacks;
+		uint64_t Destroyed = 0;
+		uint64_t Checksum = 0;
+		uint64_t Drawn = 0;
+
+		void Run(uint64_t frame) {
+			LinearArena& arena = this->Arenas[frame % FRAMES_IN_FLIGHT];
+			arena.Reset();
+
+			// the draw list and its sort, like SimpleRenderSystem builds them
+			ArenaVector<DrawItem> draws{ ArenaAllocator<DrawItem>{ arena } };
+			for (uint32_t i = 0; i < OBJECT_COUNT; i++) {
+				const uint32_t lod = static_cast<uint32_t>((i + frame) % 3);
+				draws.push_back({ (static_cast<uint64_t>(i % 7) << 32) | lod, this, lod, i });
+			}
+			std::sort(draws.begin(), draws.end(), [](const DrawItem& a, const DrawItem& b) { return a.SortKey < b.SortKey; });
+
+			ArenaVector<uint32_t> runStarts{ ArenaAllocator<uint32_t>{ arena } };
+			for (uint32_t i = 0; i < draws.size(); i++) {
+				if (i == 0 || draws[i].SortKey != draws[i - 1].SortKey) runStarts.push_back(i);
+			}
+			this->Drawn += runStarts.size();
+
+			// deferred destructions with the biggest capture the engine queues, an owner and six handles
+			for (uint64_t i = 0; i < 16; i++) {
+				const uint64_t a = frame, b = i, c = frame ^ i, d = frame + i, e = frame * i, f = ~i;
+				this->Callbacks.Queue(frame + FRAMES_IN_FLIGHT, [this, a, b, c, d, e, f]() {
+					this->Destroyed++;
+					this->Checksum ^= a ^ b ^ c ^ d ^ e ^ f;
+				});
+			}
+			this->Callbacks.Collect(frame);
+		}
+	};
+}
+
+int main() {
+	FrameLoop loop;
+
+	const size_t before = g_Allocations;
+	uint64_t frame = 0;
+	for (; frame < WARMUP_FRAMES; frame++) loop.Run(frame);
+	const size_t warmup = g_Allocations - before;
+
+	size_t overflows = 0;
+	for (auto& arena : loop.Arenas) overflows += arena.GetOverflowCount();
+
+	const size_t measuredStart = g_Allocations;
+	for (; frame < WARMUP_FRAMES + MEASURED_FRAMES; frame++) loop.Run(frame);
+	const size_t measured = g_Allocations - measuredStart;
+
+	// the arena grows with malloc, which isn't counted above, but it only ever does so after a spill
+	size_t measuredOverflows = 0;
+	for (auto& arena : loop.Arenas) measuredOverflows += arena.GetOverflowCount();
+	measuredOverflows -= overflows;
+
+	std::cout << "warm-up: " << warmup << " allocations over " << WARMUP_FRAMES << " frames" << std::endl;
+	std::cout << "steady state: " << measured << " allocations and " << measuredOverflows << " arena spills over "
+		<< MEASURED_FRAMES << " frames (" << loop.Drawn << " draws, " << loop.Destroyed << " callbacks)" << std::endl;
+
+	// nothing at all counted would mean the counting itself is broken
+	if (warmup == 0) {
+		std::cerr << "no allocation counted during warm-up, operator new isn't replaced" << std::endl;
+		return 1;
+	}
+	if (measured != 0 || measuredOverflows != 0) {
+		std::cerr << "steady state frames allocated" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,97 @@
+// Times ProceduralGeometry::WriteSierpinski against the recursive generator FirstApp used to build its gasket with.
+// usage: GeometryBenchmark [depth] [runs]
+// The baseline pushes 3 unshared vertices per triangle into a growing vector, the generator writes shared vertices
+// and indices into storage sized up front. Both produce the same triangles, which is checked before timing.
+
+#include "../../Engine/ProceduralGeometry.hpp"
+#include "../../Engine/Utils/ParallelFor.hpp"
+
+// std lib headers
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace {
+	constexpr uint32_t DEFAULT_DEPTH = 12;
+	constexpr uint32_t DEFAULT_RUNS = 10;
+
+	using Vertex = Engine::Model::Vertex;
+
+	// FirstApp::Sierpinski as it was before the procedural generators
+	void Sierpinski(std::vector<Vertex>& vertices, int depth, glm::vec2 left, glm::vec2 right, glm::vec2 top) {
+		if (depth <= 0) {
+			vertices.push_back({ top });
+			vertices.push_back({ right });
+			vertices.push_back({ left });
+		}
+		else {
+			auto leftTop = 0.5f * (left + top);
+			auto rightTop = 0.5f * (right + top);
+			auto leftRight = 0.5f * (left + right);
+			Sierpinski(vertices, depth - 1, left, leftRight, leftTop);
+			Sierpinski(vertices, depth - 1, leftRight, right, rightTop);
+			Sierpinski(vertices, depth - 1, leftTop, rightTop, top);
+		}
+	}
+
+	// best of the runs, in milliseconds
+	template<typename Function>
+	double Time(uint32_t runs, Function function) {
+		double best = 0.0;
+		for (uint32_t run = 0; run < runs; run++) {
+			const auto start = std::chrono::steady_clock::now();
+			function();
+			const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			best = run == 0 ? milliseconds : std::min(best, milliseconds);
+		}
+		return best;
+	}
+}
+
+int main(int argc, char** argv) {
+	const uint32_t depth = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : DEFAULT_DEPTH;
+	const uint32_t runs = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : DEFAULT_RUNS;
+	if (runs == 0) {
+		std::cerr << "usage: GeometryBenchmark [depth] [runs]" << std::endl;
+		return 1;
+	}
+
+	const glm::vec2 left{ -0.5f, 0.5f };
+	const glm::vec2 right{ 0.5f, 0.5f };
+	const glm::vec2 top{ 0.0f, -0.5f };
+
+	const auto size = Engine::ProceduralGeometry::GetSierpinskiSize(depth);
+	std::vector<Vertex> baseline;
+	std::vector<Vertex> vertices(size.VertexCount);
+	std::vector<uint32_t> indices(size.IndexCount);
+
+	const double baselineTime = Time(runs, [&]() {
+		// a fresh vector every run like a model rebuild, growth included
+		baseline = {};
+		Sierpinski(baseline, static_cast<int>(depth), left, right, top);
+	});
+	const double generatorTime = Time(runs, [&]() {
+		Engine::ProceduralGeometry::WriteSierpinski(vertices.data(), indices.data(), depth, left, right, top);
+	});
+
+	if (baseline.size() != indices.size()) {
+		std::cerr << "triangle counts differ: " << baseline.size() / 3 << " vs " << indices.size() / 3 << std::endl;
+		return 1;
+	}
+	for (size_t i = 0; i < indices.size(); i++) {
+		if (!(vertices[indices[i]].position == baseline[i].position)) {
+			std::cerr << "triangle " << i / 3 << " differs from the baseline" << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << "depth " << depth << ": " << size.IndexCount / 3 << " triangles, best of " << runs << " runs" << std::endl;
+	std::cout << "recursive push_back: " << baselineTime << " ms, " << baseline.size() << " vertices" << std::endl;
+	std::cout << "WriteSierpinski:     " << generatorTime << " ms, " << size.VertexCount << " vertices + "
+		<< size.IndexCount << " indices on " << WorkerPool::Get().GetThreadCount() << " threads" << std::endl;
+	std::cout << "speedup: " << baselineTime / generatorTime << "x" << std::endl;
+	return 0;
+}
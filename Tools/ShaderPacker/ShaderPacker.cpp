@@ -0,0 +1,126 @@
+// Packs compiled SPIR-V files into a single archive the engine maps at startup.
+// usage: ShaderPacker <output.pak> <input.spv>...
+// Shaders are named after their file name without the .spv extension, e.g. "SimpleShader.vert".
+
+#include "../../Engine/Utils/ShaderArchive.hpp"
+
+// std lib headers
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+	struct InputShader {
+		std::string Name;
+		std::vector<char> Code;
+	};
+
+	std::string ShaderName(const std::string& filePath) {
+		std::string name = filePath.substr(filePath.find_last_of("/\\") + 1);
+		const std::string extension = ".spv";
+		if (name.size() > extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0) {
+			name.resize(name.size() - extension.size());
+		}
+		return name;
+	}
+
+	std::vector<char> ReadFile(const std::string& filePath) {
+		std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+		if (!file.is_open()) {
+			throw std::runtime_error("Failed to open file: " + filePath);
+		}
+
+		std::vector<char> buffer(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(buffer.data(), buffer.size());
+		return buffer;
+	}
+
+	uint32_t AlignUp(size_t value, size_t alignment) {
+		return static_cast<uint32_t>((value + alignment - 1) / alignment * alignment);
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::cerr << "usage: " << argv[0] << " <output.pak> <input.spv>..." << std::endl;
+		return 1;
+	}
+
+	try {
+		std::vector<InputShader> shaders;
+		for (int i = 2; i < argc; i++) {
+			InputShader shader{ ShaderName(argv[i]), ReadFile(argv[i]) };
+			if (shader.Code.empty() || shader.Code.size() % sizeof(uint32_t) != 0) {
+				throw std::runtime_error(std::string("Not a SPIR-V file: ") + argv[i]);
+			}
+			for (const auto& other : shaders) {
+				if (other.Name == shader.Name) {
+					throw std::runtime_error("Duplicate shader name: " + shader.Name);
+				}
+			}
+			shaders.push_back(std::move(shader));
+		}
+
+		const uint32_t entryCount = static_cast<uint32_t>(shaders.size());
+		uint32_t bucketCount = 1;
+		while (bucketCount < entryCount * 2 + 1) bucketCount *= 2;
+
+		ShaderArchiveHeader header{};
+		header.Magic = SHADER_ARCHIVE_MAGIC;
+		header.Version = SHADER_ARCHIVE_VERSION;
+		header.EntryCount = entryCount;
+		header.BucketCount = bucketCount;
+		header.EntriesOffset = sizeof(ShaderArchiveHeader);
+		header.BucketsOffset = header.EntriesOffset + entryCount * sizeof(ShaderArchiveEntry);
+		header.NamesOffset = header.BucketsOffset + bucketCount * sizeof(uint32_t);
+
+		std::vector<ShaderArchiveEntry> entries(entryCount);
+		std::vector<uint32_t> buckets(bucketCount, SHADER_ARCHIVE_EMPTY_BUCKET);
+		std::string names;
+
+		for (uint32_t i = 0; i < entryCount; i++) {
+			auto& entry = entries[i];
+			entry.NameHash = HashShaderArchiveName(shaders[i].Name);
+			entry.ContentHash = HashBytes(shaders[i].Code.data(), shaders[i].Code.size());
+			entry.NameOffset = static_cast<uint32_t>(names.size());
+			entry.NameLength = static_cast<uint32_t>(shaders[i].Name.size());
+			entry.DataSize = static_cast<uint32_t>(shaders[i].Code.size());
+			names += shaders[i].Name;
+
+			uint32_t bucket = static_cast<uint32_t>(entry.NameHash) & (bucketCount - 1);
+			while (buckets[bucket] != SHADER_ARCHIVE_EMPTY_BUCKET) bucket = (bucket + 1) & (bucketCount - 1);
+			buckets[bucket] = i;
+		}
+
+		uint32_t offset = AlignUp(header.NamesOffset + names.size(), SHADER_ARCHIVE_BLOB_ALIGNMENT);
+		for (uint32_t i = 0; i < entryCount; i++) {
+			entries[i].DataOffset = offset;
+			offset = AlignUp(offset + entries[i].DataSize, SHADER_ARCHIVE_BLOB_ALIGNMENT);
+		}
+		header.FileSize = offset;
+
+		std::vector<char> archive(header.FileSize, 0);
+		std::memcpy(archive.data(), &header, sizeof(header));
+		std::memcpy(archive.data() + header.EntriesOffset, entries.data(), entries.size() * sizeof(ShaderArchiveEntry));
+		std::memcpy(archive.data() + header.BucketsOffset, buckets.data(), buckets.size() * sizeof(uint32_t));
+		std::memcpy(archive.data() + header.NamesOffset, names.data(), names.size());
+		for (uint32_t i = 0; i < entryCount; i++) {
+			std::memcpy(archive.data() + entries[i].DataOffset, shaders[i].Code.data(), shaders[i].Code.size());
+		}
+
+		std::ofstream output(argv[1], std::ios::binary | std::ios::trunc);
+		if (!output.write(archive.data(), archive.size())) {
+			throw std::runtime_error(std::string("Failed to write archive: ") + argv[1]);
+		}
+
+		std::cout << "packed " << entryCount << " shaders into " << argv[1] << " (" << header.FileSize << " bytes)" << std::endl;
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,60 @@
+// Measures how many sprites per millisecond the sprite batch expands on the CPU, runs headless without a GPU.
+// usage: SpriteBenchmark [sprites per frame] [frames]
+// Every frame writes a full batch of quads through WriteSpriteQuad into one region of a buffer laid out like the
+// batch's vertex buffer, moving a little each frame so nothing can be hoisted out of the loop.
+
+#include "../../Engine/Sprite.hpp"
+
+// std lib headers
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace {
+	constexpr uint32_t DEFAULT_SPRITES = 16384;
+	constexpr uint32_t DEFAULT_FRAMES = 1000;
+	constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+	constexpr uint32_t TEXTURE_COUNT = 64;
+}
+
+int main(int argc, char** argv) {
+	const uint32_t spriteCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : DEFAULT_SPRITES;
+	const uint32_t frameCount = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : DEFAULT_FRAMES;
+	if (spriteCount == 0 || frameCount == 0) {
+		std::cerr << "usage: SpriteBenchmark [sprites per frame] [frames]" << std::endl;
+		return 1;
+	}
+
+	std::vector<Engine::Sprite> sprites(spriteCount);
+	for (uint32_t i = 0; i < spriteCount; i++) {
+		Engine::Sprite& sprite = sprites[i];
+		sprite.Transform.Translation = { (i % 128) / 64.0f - 1.0f, (i / 128 % 128) / 64.0f - 1.0f };
+		sprite.Transform.Scale = { 0.01f, 0.01f };
+		sprite.Transform.Rotation = 0.001f * i;
+		sprite.Color = { (i % 7) / 7.0f, (i % 11) / 11.0f, (i % 13) / 13.0f, 1.0f };
+		sprite.Texture = i % TEXTURE_COUNT;
+	}
+
+	std::vector<Engine::SpriteVertex> vertices(static_cast<size_t>(spriteCount) * 4 * FRAMES_IN_FLIGHT);
+
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t frame = 0; frame < frameCount; frame++) {
+		Engine::SpriteVertex* region = vertices.data() + static_cast<size_t>(frame % FRAMES_IN_FLIGHT) * spriteCount * 4;
+		for (uint32_t i = 0; i < spriteCount; i++) {
+			sprites[i].Transform.Rotation += 0.001f;
+			Engine::WriteSpriteQuad(region + static_cast<size_t>(i) * 4, sprites[i]);
+		}
+	}
+	const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// read back once so the writes aren't optimized away
+	float checksum = 0.0f;
+	for (const auto& vertex : vertices) checksum += vertex.Position.x;
+
+	const double total = static_cast<double>(spriteCount) * frameCount;
+	std::cout << spriteCount << " sprites x " << frameCount << " frames in " << milliseconds << " ms" << std::endl;
+	std::cout << total / milliseconds << " sprites/ms (checksum " << checksum << ")" << std::endl;
+	return 0;
+}
@@ -0,0 +1,127 @@
+// Times TransformHierarchy::Update on 1M node hierarchies and checks every world transform against a serial walk.
+// usage: TransformBenchmark [nodes]
+// Shapes: a single deep chain, one root with every other node as its child, and a 4-ary tree in between. Each is
+// timed for the first update (sort included), a dirty root, a dirty node halfway down and a clean update. Set
+// WORKER_THREADS to run the parallel levels on more threads than there are cores. Exits non zero on a mismatch.
+
+#include "../../Engine/TransformHierarchy.hpp"
+#include "../../Engine/Utils/ParallelFor.hpp"
+
+// std lib headers
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+	using Engine::TransformHierarchy;
+	using Engine::Transform2DComponent;
+
+	constexpr uint32_t DEFAULT_NODES = 1u << 20;
+	constexpr float TOLERANCE = 1e-4f;
+
+	enum class Shape { Deep, Wide, Tree };
+
+	double Milliseconds(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	bool Near(glm::vec2 a, glm::vec2 b) {
+		return std::fabs(a.x - b.x) <= TOLERANCE && std::fabs(a.y - b.y) <= TOLERANCE;
+	}
+
+	// every node is created after its parent, so one pass in creation order has each parent's world ready
+	bool Verify(const TransformHierarchy& transforms, const std::vector<TransformHierarchy::NodeId>& nodes, const std::vector<uint32_t>& parents) {
+		std::vector<glm::mat2> matrices(nodes.size());
+		std::vector<glm::vec2> offsets(nodes.size());
+
+		for (size_t i = 0; i < nodes.size(); i++) {
+			const Transform2DComponent& local = transforms.GetLocal(nodes[i]);
+			const glm::mat2 matrix = local.GetTransformMatrix();
+			if (parents[i] == UINT32_MAX) {
+				matrices[i] = matrix;
+				offsets[i] = local.Translation;
+			} else {
+				matrices[i] = matrices[parents[i]] * matrix;
+				offsets[i] = matrices[parents[i]] * local.Translation + offsets[parents[i]];
+			}
+
+			const glm::mat2& world = transforms.GetWorldMatrix(nodes[i]);
+			if (!Near(offsets[i], transforms.GetWorldOffset(nodes[i])) || !Near(matrices[i][0], world[0]) || !Near(matrices[i][1], world[1])) {
+				std::cerr << "node " << i << " differs from the serial walk" << std::endl;
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool Run(Shape shape, const char* name, uint32_t nodeCount) {
+		TransformHierarchy transforms;
+		std::vector<TransformHierarchy::NodeId> nodes;
+		std::vector<uint32_t> parents;
+		nodes.reserve(nodeCount);
+		parents.reserve(nodeCount);
+
+		// small steps so a million nested transforms stay in float range
+		Transform2DComponent local{};
+		local.Translation = { 0.001f, 0.0f };
+		local.Scale = glm::vec2{ 1.0f };
+		local.Rotation = 0.0001f;
+
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			uint32_t parent = UINT32_MAX;
+			if (i > 0) parent = shape == Shape::Deep ? i - 1 : shape == Shape::Wide ? 0 : (i - 1) / 4;
+
+			nodes.push_back(transforms.Create(parent == UINT32_MAX ? TransformHierarchy::INVALID_NODE : nodes[parent], local));
+			parents.push_back(parent);
+		}
+		const double create = Milliseconds(start);
+
+		start = std::chrono::steady_clock::now();
+		transforms.Update();
+		const double first = Milliseconds(start);
+
+		local.Rotation = 0.0002f;
+		start = std::chrono::steady_clock::now();
+		transforms.SetLocal(nodes[0], local);
+		transforms.Update();
+		const double root = Milliseconds(start);
+		const uint32_t rootUpdated = transforms.GetStats().UpdatedNodes;
+
+		start = std::chrono::steady_clock::now();
+		transforms.SetLocal(nodes[nodeCount / 2], local);
+		transforms.Update();
+		const double middle = Milliseconds(start);
+		const uint32_t middleUpdated = transforms.GetStats().UpdatedNodes;
+
+		start = std::chrono::steady_clock::now();
+		transforms.Update();
+		const double clean = Milliseconds(start);
+
+		std::cout << std::fixed << std::setprecision(2) << name << ": " << transforms.GetStats().Levels << " levels, create "
+			<< create << " ms, first update " << first << " ms, root dirty " << root << " ms (" << rootUpdated << " nodes), middle dirty "
+			<< middle << " ms (" << middleUpdated << " nodes), clean " << std::setprecision(4) << clean << " ms" << std::endl;
+
+		return Verify(transforms, nodes, parents);
+	}
+}
+
+int main(int argc, char** argv) {
+	const uint32_t nodeCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : DEFAULT_NODES;
+	if (nodeCount < 2) {
+		std::cerr << "usage: TransformBenchmark [nodes]" << std::endl;
+		return 1;
+	}
+
+	std::cout << nodeCount << " nodes on " << WorkerPool::Get().GetThreadCount() << " threads" << std::endl;
+	bool verified = Run(Shape::Deep, "deep chain", nodeCount);
+	verified = Run(Shape::Wide, "wide", nodeCount) && verified;
+	verified = Run(Shape::Tree, "4-ary tree", nodeCount) && verified;
+
+	std::cout << (verified ? "world transforms match the serial walk" : "world transforms DIFFER from the serial walk") << std::endl;
+	return verified ? 0 : 1;
+}